@@ -110,13 +110,15 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
 }
 
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // Latches are always taken in the order pg_latch_ -> pt_latch_, as in FetchPageImpl, to avoid deadlocks.
+  pg_latch_.lock();
   pt_latch_.lock();
 
   if(page_table_.find(page_id) == page_table_.end()){
     pt_latch_.unlock();
+    pg_latch_.unlock();
     return true;
   }
-  pg_latch_.lock();
   frame_id_t target = page_table_[page_id];
   pt_latch_.unlock();
 
@@ -238,6 +240,7 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  pg_latch_.lock();
   pt_latch_.lock();
 
   if(page_table_.find(page_id) == page_table_.end()){
@@ -249,7 +252,6 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   }
   else{
     frame_id_t target = page_table_[page_id];
-    pg_latch_.lock();
 
     // Page is in use
     if(pages_[target].GetPinCount() != 0) {
@@ -4,6 +4,8 @@
 #include <random>
 #include <vector>
 
+#include "catalog/table_loader.h"
+
 namespace bustub {
 
 template <typename CppType>
@@ -48,6 +50,8 @@ std::vector<Value> TableGenerator::MakeValues(ColumnInsertMeta *col_meta, uint32
 void TableGenerator::FillTable(TableMetadata *info, TableInsertMeta *table_meta) {
   uint32_t num_inserted = 0;
   uint32_t batch_size = 128;
+  std::vector<Tuple> tuples;
+  tuples.reserve(table_meta->num_rows_);
   while (num_inserted < table_meta->num_rows_) {
     std::vector<std::vector<Value>> values;
     uint32_t num_values = std::min(batch_size, table_meta->num_rows_ - num_inserted);
@@ -60,12 +64,19 @@ void TableGenerator::FillTable(TableMetadata *info, TableInsertMeta *table_meta)
       for (const auto &col : values) {
         entry.emplace_back(col[i]);
       }
-      RID rid;
-      bool inserted = info->table_->InsertTuple(Tuple(entry, &info->schema_), &rid, exec_ctx_->GetTransaction());
-      BUSTUB_ASSERT(inserted, "Sequential insertion cannot fail");
+      tuples.emplace_back(entry, &info->schema_);
       num_inserted++;
     }
-    // exec_ctx_->GetBufferPoolManager()->FlushAllPages();
+  }
+  if (enable_logging) {
+    // Bulk loads are not logged, so the rows go through the table heap instead.
+    std::vector<RID> rids;
+    bool inserted = info->table_->InsertTuples(tuples, &rids, exec_ctx_->GetTransaction());
+    BUSTUB_ASSERT(inserted, "Sequential insertion cannot fail");
+  } else {
+    // The rows are packed into new pages, without going through TableHeap::InsertTuple.
+    TableLoader loader{exec_ctx_};
+    loader.LoadTuples(info, tuples);
   }
   LOG_INFO("Wrote %d tuples to table %s.", num_inserted, table_meta->name_);
 }
@@ -0,0 +1,338 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_loader.cpp
+//
+// Identification: src/catalog/table_loader.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_loader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/worker_pool.h"
+#include "storage/page/table_page.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Tuples that take more than a page are rejected, as in TableHeap::InsertTuple. */
+bool FitsInPage(uint32_t tuple_size) { return tuple_size + 32 <= PAGE_SIZE; }
+
+}  // namespace
+
+size_t TableLoader::LoadFile(TableMetadata *table, const std::string &path, Format format) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw Exception(ExceptionType::INVALID, "Cannot open " + path);
+  }
+  std::vector<char> data(static_cast<size_t>(file.tellg()));
+  file.seekg(0);
+  if (!file.read(data.data(), static_cast<std::streamsize>(data.size()))) {
+    throw Exception(ExceptionType::INVALID, "Cannot read " + path);
+  }
+
+  // Cut the file into chunks at row boundaries: chunk i is [bounds[i], bounds[i + 1]).
+  std::vector<size_t> bounds{0};
+  if (format == Format::CSV) {
+    while (bounds.back() < data.size()) {
+      auto end = data.begin() + std::min(bounds.back() + chunk_size_, data.size());
+      auto newline = std::find(end - 1, data.end(), '\n');
+      bounds.push_back(newline == data.end() ? data.size() : newline - data.begin() + 1);
+    }
+  } else {
+    size_t pos = 0;
+    while (pos < data.size()) {
+      uint32_t size;
+      if (data.size() - pos < sizeof(size)) {
+        throw Exception(ExceptionType::CONVERSION, "Truncated row in " + path);
+      }
+      memcpy(&size, data.data() + pos, sizeof(size));
+      if (data.size() - pos - sizeof(size) < size) {
+        throw Exception(ExceptionType::CONVERSION, "Truncated row in " + path);
+      }
+      pos += sizeof(size) + size;
+      if (pos - bounds.back() >= chunk_size_ || pos == data.size()) {
+        bounds.push_back(pos);
+      }
+    }
+  }
+
+  return Load(table, bounds.size() - 1, [&](size_t chunk_idx, Chunk *chunk) {
+    std::vector<Tuple> tuples;
+    if (format == Format::CSV) {
+      ParseCsv(data.data() + bounds[chunk_idx], data.data() + bounds[chunk_idx + 1], &tuples);
+    } else {
+      ParseBinary(data.data() + bounds[chunk_idx], data.data() + bounds[chunk_idx + 1], &tuples);
+    }
+    PackTuples(tuples.data(), tuples.data() + tuples.size(), chunk);
+  });
+}
+
+size_t TableLoader::LoadTuples(TableMetadata *table, const std::vector<Tuple> &tuples) {
+  std::vector<size_t> bounds{0};
+  size_t chunk_bytes = 0;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    if (!FitsInPage(tuples[i].GetLength())) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "Tuple larger than a page.");
+    }
+    chunk_bytes += tuples[i].GetLength();
+    if (chunk_bytes >= chunk_size_ || i + 1 == tuples.size()) {
+      bounds.push_back(i + 1);
+      chunk_bytes = 0;
+    }
+  }
+  return Load(table, bounds.size() - 1, [&](size_t chunk_idx, Chunk *chunk) {
+    PackTuples(tuples.data() + bounds[chunk_idx], tuples.data() + bounds[chunk_idx + 1], chunk);
+  });
+}
+
+size_t TableLoader::Load(TableMetadata *table, size_t num_chunks,
+                         const std::function<void(size_t, Chunk *)> &load_chunk) {
+  if (enable_logging) {
+    throw NotImplementedException("Bulk loads are not logged.");
+  }
+  table_ = table;
+  indexes_ = exec_ctx_->GetCatalog()->GetTableIndexes(table->name_);
+
+  std::vector<Chunk> chunks(num_chunks);
+  std::vector<std::exception_ptr> errors(num_chunks);
+  std::atomic<size_t> next_chunk{0};
+  auto task = [&](size_t worker_id) {
+    for (size_t chunk_idx = next_chunk++; chunk_idx < num_chunks; chunk_idx = next_chunk++) {
+      try {
+        load_chunk(chunk_idx, &chunks[chunk_idx]);
+      } catch (...) {
+        errors[chunk_idx] = std::current_exception();
+      }
+    }
+  };
+  WorkerPool *pool = exec_ctx_->GetWorkerPool();
+  if (pool != nullptr) {
+    pool->RunOnAll(task);
+  } else {
+    task(0);
+  }
+
+  auto bpm = exec_ctx_->GetBufferPoolManager();
+  auto error = std::find_if(errors.begin(), errors.end(), [](const auto &e) { return e != nullptr; });
+  if (error != errors.end()) {
+    for (const auto &chunk : chunks) {
+      for (auto page_id : chunk.page_ids_) {
+        bpm->DeletePage(page_id);
+      }
+    }
+    std::rethrow_exception(*error);
+  }
+
+  std::vector<page_id_t> page_ids;
+  std::vector<RID> rids;
+  for (const auto &chunk : chunks) {
+    page_ids.insert(page_ids.end(), chunk.page_ids_.begin(), chunk.page_ids_.end());
+    rids.insert(rids.end(), chunk.rids_.begin(), chunk.rids_.end());
+  }
+  table->table_->AppendPages(page_ids);
+
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    std::vector<Tuple> keys;
+    keys.reserve(rids.size());
+    for (auto &chunk : chunks) {
+      std::move(chunk.keys_[i].begin(), chunk.keys_[i].end(), std::back_inserter(keys));
+    }
+    indexes_[i]->index_->InsertEntries(keys, rids, exec_ctx_->GetTransaction(),
+                                       pool == nullptr ? 1 : pool->NumWorkers());
+  }
+  return rids.size();
+}
+
+void TableLoader::PackTuples(const Tuple *begin, const Tuple *end, Chunk *chunk) {
+  auto bpm = exec_ctx_->GetBufferPoolManager();
+  chunk->rids_.reserve(end - begin);
+  chunk->keys_.resize(indexes_.size());
+  TablePage *page = nullptr;
+  RID rid;
+  for (const Tuple *tuple = begin; tuple != end; ++tuple) {
+    // Fill the page until the tuple does not fit, then move on to a new one.
+    if (page == nullptr || !page->AppendTuple(*tuple, &rid)) {
+      if (page != nullptr) {
+        bpm->UnpinPage(page->GetTablePageId(), true);
+      }
+      page_id_t page_id;
+      page = static_cast<TablePage *>(bpm->NewPage(&page_id));
+      if (page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "No free frame in the buffer pool.");
+      }
+      chunk->page_ids_.push_back(page_id);
+      // The page is linked into the table later, and is private to this chunk until then.
+      page->Init(page_id, PAGE_SIZE, INVALID_PAGE_ID, nullptr, nullptr);
+      page->AppendTuple(*tuple, &rid);
+    }
+    chunk->rids_.push_back(rid);
+    for (size_t i = 0; i < indexes_.size(); i++) {
+      Index *index = indexes_[i]->index_.get();
+      chunk->keys_[i].push_back(tuple->KeyFromTuple(&table_->schema_, index->GetKeySchema(), index->GetKeyAttrs()));
+    }
+  }
+  if (page != nullptr) {
+    bpm->UnpinPage(page->GetTablePageId(), true);
+  }
+}
+
+void TableLoader::ParseCsv(const char *begin, const char *end, std::vector<Tuple> *tuples) {
+  const Schema *schema = &table_->schema_;
+  std::vector<Value> values;
+  std::string field;
+  while (begin < end) {
+    const char *line_end = std::find(begin, end, '\n');
+    const char *next_line = line_end == end ? end : line_end + 1;
+    if (line_end > begin && line_end[-1] == '\r') {
+      --line_end;
+    }
+    if (line_end == begin) {
+      begin = next_line;
+      continue;
+    }
+    values.clear();
+    for (const char *field_begin = begin;; ++field_begin) {
+      const char *field_end = std::find(field_begin, line_end, ',');
+      if (values.size() == schema->GetColumnCount()) {
+        throw Exception(ExceptionType::CONVERSION, "Too many fields in row: " + std::string(begin, line_end));
+      }
+      field.assign(field_begin, field_end);
+      values.push_back(ParseValue(field, schema->GetColumn(values.size())));
+      if (field_end == line_end) {
+        break;
+      }
+      field_begin = field_end;
+    }
+    if (values.size() != schema->GetColumnCount()) {
+      throw Exception(ExceptionType::CONVERSION, "Too few fields in row: " + std::string(begin, line_end));
+    }
+    tuples->emplace_back(values, schema);
+    if (!FitsInPage(tuples->back().GetLength())) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "Row larger than a page: " + std::string(begin, line_end));
+    }
+    begin = next_line;
+  }
+}
+
+void TableLoader::ParseBinary(char *begin, char *end, std::vector<Tuple> *tuples) {
+  const Schema *schema = &table_->schema_;
+  while (begin < end) {
+    uint32_t size;
+    memcpy(&size, begin, sizeof(size));
+    if (size < schema->GetLength() || !FitsInPage(size)) {
+      throw Exception(ExceptionType::CONVERSION,
+                      "Row of " + std::to_string(size) + " bytes does not match the schema.");
+    }
+    // The data of an uninlined column, its length then its bytes, is at an offset that must lie within the row.
+    auto fail = [&]() {
+      return Exception(ExceptionType::CONVERSION,
+                       "Row of " + std::to_string(size) + " bytes with a column outside of it.");
+    };
+    const char *data = begin + sizeof(size);
+    for (uint32_t col_idx : schema->GetUnlinedColumns()) {
+      uint32_t offset;
+      uint32_t length;
+      memcpy(&offset, data + schema->GetColumn(col_idx).GetOffset(), sizeof(offset));
+      if (uint64_t{offset} + sizeof(length) > size) {
+        throw fail();
+      }
+      memcpy(&length, data + offset, sizeof(length));
+      if (length != BUSTUB_VALUE_NULL && uint64_t{offset} + sizeof(length) + length > size) {
+        throw fail();
+      }
+    }
+    // The tuple is a view of the file data, which outlives it.
+    tuples->emplace_back(begin + sizeof(size), size);
+    begin += sizeof(size) + size;
+  }
+}
+
+Value TableLoader::ParseValue(const std::string &field, const Column &column) {
+  TypeId type = column.GetType();
+  if (field.empty()) {
+    return ValueFactory::GetNullValueByType(type);
+  }
+  auto fail = [&]() {
+    return Exception(ExceptionType::CONVERSION, "Invalid value for column " + column.GetName() + ": " + field);
+  };
+  switch (type) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::TIMESTAMP: {
+      char *parsed_end;
+      errno = 0;
+      int64_t value = std::strtoll(field.c_str(), &parsed_end, 10);
+      if (errno != 0 || parsed_end != field.c_str() + field.size()) {
+        throw fail();
+      }
+      switch (type) {
+        case TypeId::TINYINT:
+          if (value < BUSTUB_INT8_MIN || value > BUSTUB_INT8_MAX) {
+            throw fail();
+          }
+          return ValueFactory::GetTinyIntValue(static_cast<int8_t>(value));
+        case TypeId::SMALLINT:
+          if (value < BUSTUB_INT16_MIN || value > BUSTUB_INT16_MAX) {
+            throw fail();
+          }
+          return ValueFactory::GetSmallIntValue(static_cast<int16_t>(value));
+        case TypeId::INTEGER:
+          if (value < BUSTUB_INT32_MIN || value > BUSTUB_INT32_MAX) {
+            throw fail();
+          }
+          return ValueFactory::GetIntegerValue(static_cast<int32_t>(value));
+        case TypeId::BIGINT:
+          if (value < BUSTUB_INT64_MIN) {
+            throw fail();
+          }
+          return ValueFactory::GetBigIntValue(value);
+        default:
+          return ValueFactory::GetTimestampValue(value);
+      }
+    }
+    case TypeId::DECIMAL: {
+      char *parsed_end;
+      errno = 0;
+      double value = std::strtod(field.c_str(), &parsed_end);
+      if (errno != 0 || parsed_end != field.c_str() + field.size()) {
+        throw fail();
+      }
+      return ValueFactory::GetDecimalValue(value);
+    }
+    case TypeId::BOOLEAN:
+      if (field == "true" || field == "1") {
+        return ValueFactory::GetBooleanValue(true);
+      }
+      if (field == "false" || field == "0") {
+        return ValueFactory::GetBooleanValue(false);
+      }
+      throw fail();
+    case TypeId::VARCHAR:
+      return ValueFactory::GetVarcharValue(field);
+    default:
+      UNREACHABLE("Not yet implemented");
+  }
+}
+
+}  // namespace bustub
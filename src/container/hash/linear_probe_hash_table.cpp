@@ -10,11 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
-#include <strhash.h>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -30,26 +32,12 @@ namespace bustub {
                                           size_t num_buckets,     // Is num_buckets # of blocks or buckets?
                                           HashFunction<KeyType> hash_fn)
             : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-        auto header_page_p = buffer_pool_manager_->NewPage(&header_page_id_);
-        header_page_p->WLatch();
-        auto header_page_t = reinterpret_cast<HashTableHeaderPage *>(header_page_p->GetData());
-        header_page_t->SetPageId(header_page_id_);
-        header_page_t->SetSize(num_buckets * BLOCK_ARRAY_SIZE);
-
-        // Allocate Block pages
-        for (size_t i = 0; i < num_buckets; ++i) {
-            page_id_t block_page_id;
-            buffer_pool_manager_->NewPage((&block_page_id));
-            if (block_page_id == INVALID_PAGE_ID) {
-                --i;
-                continue;
-            }
-            header_page_t->AddBlockPageId(block_page_id);
-            buffer_pool_manager_->UnpinPage(block_page_id, false);
-        }
+        directory_.store(AllocateTable(num_buckets));
+    }
 
-        header_page_p->WUnlatch();
-        buffer_pool_manager_->UnpinPage(header_page_id_, true);
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    HASH_TABLE_TYPE::~LinearProbeHashTable() {
+        delete directory_.load();
     }
 
 /*****************************************************************************
@@ -57,75 +45,66 @@ namespace bustub {
  *****************************************************************************/
     template<typename KeyType, typename ValueType, typename KeyComparator>
     bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-        table_latch_.RLock();
-
-        /*
-        std::ostringstream buffer;
-        buffer << "Try to get value for key:  " << key;
-        LOG_INFO("%s", buffer.str().c_str());
-        */
+        // Lookups take no latches. The epoch keeps the directory and its block pages alive if a Resize publishes a
+        // new table concurrently, and every block page is read optimistically against its version counter.
+        EpochGuard epoch_guard(&epoch_manager_);
 
-        // Fetch the header page.
-        auto header_page_p = buffer_pool_manager_->FetchPage(header_page_id_);
-        header_page_p->RLatch();
-        auto header_page_t = reinterpret_cast<HashTableHeaderPage * >(header_page_p->GetData());
+        // Block page ids come from the cached directory, so no header page is fetched on this path.
+        const HashTableDirectory *directory = directory_.load();
+        size_t num_blocks = directory->block_page_ids_.size();
+        size_t num_slots = num_blocks * BLOCK_ARRAY_SIZE;
 
         // Get the index, bucket index and block index for this key.
+        uint64_t hash = hash_fn_.GetHash(key);
         size_t index, bucket_ind, block_ind;
-        GetIndex(key, header_page_t->NumBlocks(), index, block_ind, bucket_ind);
+        GetIndex(hash, num_blocks, index, block_ind, bucket_ind);
 
-        /*
-        std::ostringstream buffer_index;
-        buffer_index << "The index for key: " << key << ", "  << " is found " << "at block: " << block_ind
-               << "bucket : " << bucket_ind;
-        LOG_INFO("%s", buffer_index.str().c_str());
-        */
+        // Most lookups for absent keys end here, without walking the probe sequence.
+        if (!directory->probe_filter_->MayContain(block_ind, hash)) {
+            return false;
+        }
 
-        page_id_t block_page_id = header_page_t->GetBlockPageId(block_ind);
-        auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
-        block_page_p->RLatch();
-        auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+        // Readable entries of the probe run inside the current block, copied out under a consistent version.
+        std::vector<MappingType> run;
+        size_t probed = 0;
+        bool run_ended = false;
+        while (!run_ended && probed < num_slots) {
+            page_id_t block_page_id = directory->block_page_ids_[block_ind];
+            auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+            auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
 
-        while (block_page_t->IsOccupied(bucket_ind)) {
-            if (block_page_t->IsReadable(bucket_ind)  && comparator_(key, block_page_t->KeyAt(bucket_ind))== 0) {
-                // For debug purpose.
-                ValueType value = block_page_t->ValueAt(bucket_ind);
-                /*
-                std::ostringstream buffer_found;
-                buffer_found << "The <key,value>: " << key << ", " << value << " is found " << "at block: " << block_ind
-                             << "bucket : " << bucket_ind;
-                LOG_INFO("%s", buffer_found.str().c_str());
-                */
-                result->push_back(value);
+            size_t scanned;
+            while (true) {
+                run.clear();
+                run_ended = false;
+                uint32_t version = block_page_t->GetVersion();
+                size_t ind = bucket_ind;
+                for (; ind < BLOCK_ARRAY_SIZE && probed + (ind - bucket_ind) < num_slots; ++ind) {
+                    if (!block_page_t->IsOccupied(ind)) {
+                        run_ended = true;
+                        break;
+                    }
+                    if (block_page_t->IsReadable(ind)) {
+                        run.emplace_back(block_page_t->KeyAt(ind), block_page_t->ValueAt(ind));
+                    }
+                }
+                scanned = ind - bucket_ind;
+                if (block_page_t->ValidateVersion(version)) break;
             }
-            bucket_ind++;
-
-            // If go back to the original bucket, break.
-            if (block_ind * BLOCK_ARRAY_SIZE + bucket_ind == index) break;
-            if (bucket_ind == BLOCK_ARRAY_SIZE) {
-                // Searching in this block page is finished.
-                block_page_p->RUnlatch();
-                buffer_pool_manager_->UnpinPage(block_page_id, false);
+            buffer_pool_manager_->UnpinPage(block_page_id, false);
 
-                block_ind++;
-                bucket_ind = 0;
-                if (block_ind == header_page_t->NumBlocks()) {
-                    block_ind = 0;
+            // Keys are only compared once the copy is known to be consistent.
+            for (const auto &entry : run) {
+                if (comparator_(key, entry.first) == 0) {
+                    result->push_back(entry.second);
                 }
-
-                // Fetch the next block page.
-                block_page_id = header_page_t->GetBlockPageId(block_ind);
-                block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
-                block_page_p->RLatch();
-                block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
             }
+
+            probed += scanned;
+            bucket_ind = 0;
+            block_ind = (block_ind + 1) % num_blocks;
         }
 
-        block_page_p->RUnlatch();
-        header_page_p->RUnlatch();
-        buffer_pool_manager_->UnpinPage(block_page_id, false);
-        buffer_pool_manager_->UnpinPage(header_page_id_, false);
-        table_latch_.RUnlock();
         return !result->empty();
     }
 
@@ -134,108 +113,69 @@ namespace bustub {
  *****************************************************************************/
     template<typename KeyType, typename ValueType, typename KeyComparator>
     bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-        table_latch_.RLock();
-        /*
-        std::ostringstream buffer;
-        buffer << "Try to insert" << key << ", " << value;
-        LOG_INFO("%s", buffer.str().c_str());
-
-        std::ostringstream buffer_r;
-        buffer_r << "Try to get header_r_latch: " << key << ", " << value;
-        LOG_INFO("%s", buffer_r.str().c_str());
-        */
+        while (true) {
+            table_latch_.RLock();
+            const HashTableDirectory *directory = directory_.load();
+            size_t num_blocks = directory->block_page_ids_.size();
 
-        auto header_page_p = buffer_pool_manager_->FetchPage(header_page_id_);
-        header_page_p->RLatch();
-        LOG_INFO("Got header_Rlatch!");
+            uint64_t hash = hash_fn_.GetHash(key);
+            size_t index, bucket_ind, block_ind;
+            GetIndex(hash, num_blocks, index, block_ind, bucket_ind);
 
+            // The key goes into the filter before it can become visible to lookups.
+            directory->probe_filter_->Add(block_ind, hash);
 
-        auto header_page_t = reinterpret_cast<HashTableHeaderPage * >(header_page_p->GetData());
-
-        size_t index, bucket_ind, block_ind;
-        GetIndex(key, header_page_t->NumBlocks(), index, block_ind, bucket_ind);
-        /*
-        std::ostringstream buffer_index;
-        buffer_index << "The index for key: " << key << ", "  << " is found " << "at block: " << block_ind
-                     << "bucket : " << bucket_ind;
-        LOG_INFO("%s", buffer_index.str().c_str());
-        */
-        page_id_t block_page_id = header_page_t->GetBlockPageId(block_ind);
-        auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
-        LOG_INFO("TRY to get block_Wlatch");
-        block_page_p->WLatch();
-        LOG_INFO("Got block_WLatch!");
-        auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
-
-        while (!block_page_t->Insert(bucket_ind, key, value)) {
-            /*
-            std::ostringstream buffer_false;
-            buffer_false << "The <key,value>: " << key << ", " << value << " can't be inserted(congestion) " << "at block: " << block_page_id
-                   << "bucket : " << bucket_ind;
-            LOG_INFO("%s", buffer_false.str().c_str());
-            */
-            // If there is already an identical <k,v> pair, insertion is to be terminated.
-            if (comparator_(key, block_page_t->KeyAt(bucket_ind))==0 && value == block_page_t->ValueAt(bucket_ind)) {
-                block_page_p->WUnlatch();
-                header_page_p->RUnlatch();
-                buffer_pool_manager_->UnpinPage(header_page_id_, false);
-                buffer_pool_manager_->UnpinPage(block_page_id, false);
-                table_latch_.RUnlock();
-                return false;
-            }
-
-            bucket_ind++;
+            page_id_t block_page_id = directory->block_page_ids_[block_ind];
+            auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+            block_page_p->WLatch();
+            auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
 
-            // Got back to the original bucket, the hash table is full and need to be RESIZED.
-            if (block_ind * BLOCK_ARRAY_SIZE + bucket_ind == index) {
-                block_page_p->WUnlatch();
-                header_page_p->RUnlatch();
-                buffer_pool_manager_->UnpinPage(header_page_id_, false);
-                buffer_pool_manager_->UnpinPage(block_page_id, false);
-                Resize(header_page_t->NumBlocks() * BLOCK_ARRAY_SIZE);
+            size_t probed = 0;
+            bool inserted = false;
+            bool duplicate = false;
+            while (probed < num_blocks * BLOCK_ARRAY_SIZE) {
+                // A slot that is occupied but not readable holds a tombstone, which the insert reuses.
+                bool is_tombstone = block_page_t->IsOccupied(bucket_ind);
+                if (block_page_t->Insert(bucket_ind, key, value)) {
+                    if (is_tombstone) {
+                        num_tombstones_--;
+                    }
+                    inserted = true;
+                    break;
+                }
+                // If there is already an identical <k,v> pair, insertion is to be terminated.
+                if (comparator_(key, block_page_t->KeyAt(bucket_ind)) == 0 && value == block_page_t->ValueAt(bucket_ind)) {
+                    duplicate = true;
+                    break;
+                }
 
-                header_page_p = buffer_pool_manager_->FetchPage(header_page_id_);
-                header_page_p->RLatch();
-                header_page_t = reinterpret_cast<HashTableHeaderPage *>(header_page_p->GetData());
+                bucket_ind++;
+                probed++;
+                if (bucket_ind == BLOCK_ARRAY_SIZE) {
+                    block_page_p->WUnlatch();
+                    buffer_pool_manager_->UnpinPage(block_page_id, false);
 
-                GetIndex(key, header_page_t->NumBlocks(), index, block_ind, bucket_ind);
+                    block_ind = (block_ind + 1) % num_blocks;
+                    bucket_ind = 0;
 
-                block_page_id = header_page_t->GetBlockPageId(block_ind);
-                block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
-                block_page_p->WLatch();
-                block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+                    // Fetch the next block page.
+                    block_page_id = directory->block_page_ids_[block_ind];
+                    block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+                    block_page_p->WLatch();
+                    block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+                }
             }
 
-            if (bucket_ind == BLOCK_ARRAY_SIZE) {
-                block_page_p->WUnlatch();
-                buffer_pool_manager_->UnpinPage(block_page_id, false);
-
-                block_ind++;
-                bucket_ind = 0;
-                if (block_ind == header_page_t->NumBlocks()) {
-                    block_ind = 0;
-                }
+            block_page_p->WUnlatch();
+            buffer_pool_manager_->UnpinPage(block_page_id, inserted);
+            table_latch_.RUnlock();
 
-                // Fetch the next block page.
-                block_page_id = header_page_t->GetBlockPageId(block_ind);
-                block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
-                block_page_p->WLatch();
-                block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+            if (inserted || duplicate) {
+                return inserted;
             }
+            // Every slot is taken: the hash table is full and needs to be RESIZED before retrying.
+            Resize(num_blocks * BLOCK_ARRAY_SIZE);
         }
-        /*
-        std::ostringstream buffer_suc;
-        buffer_suc << "The <key,value>: " << key << ", " << value << " is inserted" << "at block: " << block_ind
-               << "bucket : " << bucket_ind;
-        LOG_INFO("%s", buffer_suc.str().c_str());
-        */
-
-        block_page_p->WUnlatch();
-        header_page_p->RUnlatch();
-        buffer_pool_manager_->UnpinPage(block_page_id, true);
-        buffer_pool_manager_->UnpinPage(header_page_id_, false);
-        table_latch_.RUnlock();
-        return true;
     }
 
 /*****************************************************************************
@@ -243,47 +183,43 @@ namespace bustub {
  *****************************************************************************/
     template<typename KeyType, typename ValueType, typename KeyComparator>
     bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-
         table_latch_.RLock();
-        auto header_page_p = buffer_pool_manager_->FetchPage(header_page_id_);
-        header_page_p->RLatch();
-        auto header_page_t = reinterpret_cast<HashTableHeaderPage * >(header_page_p->GetData());
+        const HashTableDirectory *directory = directory_.load();
+        size_t num_blocks = directory->block_page_ids_.size();
 
         size_t index, bucket_ind, block_ind;
-        GetIndex(key, header_page_t->NumBlocks(), index, block_ind, bucket_ind);
+        GetIndex(key, num_blocks, index, block_ind, bucket_ind);
 
-        page_id_t block_page_id = header_page_t->GetBlockPageId(block_ind);
+        page_id_t block_page_id = directory->block_page_ids_[block_ind];
         auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
         block_page_p->WLatch();
         auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
 
-        while (block_page_t->IsOccupied(bucket_ind)) {
+        bool removed = false;
+        size_t num_tombstones = 0;
+        size_t probed = 0;
+        while (probed < num_blocks * BLOCK_ARRAY_SIZE && block_page_t->IsOccupied(bucket_ind)) {
             if (block_page_t->IsReadable(bucket_ind) && comparator_(key, block_page_t->KeyAt(bucket_ind)) ==0
                 && value == block_page_t->ValueAt(bucket_ind)) {
-
                 block_page_t->Remove(bucket_ind);
-                block_page_p->WUnlatch();
-                header_page_p->RUnlatch();
-                buffer_pool_manager_->UnpinPage(block_page_id, true);
-                buffer_pool_manager_->UnpinPage(header_page_id_, false);
-                return true;
+                // Counted while the block is latched, so that an insert reusing the slot cannot uncount it first.
+                num_tombstones = ++num_tombstones_;
+                removed = true;
+                break;
             }
             bucket_ind++;
+            probed++;
 
-            if (block_ind * BLOCK_ARRAY_SIZE + bucket_ind == index) break;
             if (bucket_ind == BLOCK_ARRAY_SIZE) {
                 // Searching in this block page is finished.
                 block_page_p->WUnlatch();
                 buffer_pool_manager_->UnpinPage(block_page_id, false);
 
-                block_ind++;
+                block_ind = (block_ind + 1) % num_blocks;
                 bucket_ind = 0;
-                if (block_ind == header_page_t->NumBlocks()) {
-                    block_ind = 0;
-                }
 
                 // Fetch the next block page.
-                block_page_id = header_page_t->GetBlockPageId(block_ind);
+                block_page_id = directory->block_page_ids_[block_ind];
                 block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
                 block_page_p->WLatch();
                 block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
@@ -291,11 +227,21 @@ namespace bustub {
         }
 
         block_page_p->WUnlatch();
-        header_page_p->RUnlatch();
-        buffer_pool_manager_->UnpinPage(block_page_id, false);
-        buffer_pool_manager_->UnpinPage(header_page_id_, false);
+        buffer_pool_manager_->UnpinPage(block_page_id, removed);
         table_latch_.RUnlock();
-        return false;
+
+        // Inserts reuse tombstones, but those left in the middle of long probe sequences may never be reused, so the
+        // table is rebuilt once too many of them pile up.
+        if (removed && num_tombstones > COMPACTION_TOMBSTONE_RATIO * num_blocks * BLOCK_ARRAY_SIZE) {
+            table_latch_.WLock();
+            // Another remover may have compacted the table while we were waiting for the latch.
+            size_t num_slots = directory_.load()->block_page_ids_.size() * BLOCK_ARRAY_SIZE;
+            if (num_tombstones_ > COMPACTION_TOMBSTONE_RATIO * num_slots) {
+                GrowTo(num_slots / BLOCK_ARRAY_SIZE);
+            }
+            table_latch_.WUnlock();
+        }
+        return removed;
     }
 
 /*****************************************************************************
@@ -303,55 +249,299 @@ namespace bustub {
  *****************************************************************************/
     template<typename KeyType, typename ValueType, typename KeyComparator>
     void HASH_TABLE_TYPE::Resize(size_t initial_size) {
-        table_latch_.RLock();
+        table_latch_.WLock();
 
-        page_id_t old_header_page_id = header_page_id_;
-        auto new_header_page_p = buffer_pool_manager_->NewPage(&header_page_id_);
-        new_header_page_p->WLatch();
-        auto new_header_page_t = reinterpret_cast<HashTableHeaderPage *>(new_header_page_p->GetData());
-        new_header_page_t->SetPageId(header_page_id_);
-        size_t num_buckets = 2 * initial_size / BLOCK_ARRAY_SIZE;
-        new_header_page_t->SetSize(num_buckets * BLOCK_ARRAY_SIZE);
+        // Another inserter may have resized the table while we were waiting for the latch.
+        if (directory_.load()->block_page_ids_.size() * BLOCK_ARRAY_SIZE <= initial_size) {
+            GrowTo(2 * initial_size / BLOCK_ARRAY_SIZE);
+        }
+        table_latch_.WUnlock();
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    void HASH_TABLE_TYPE::GrowTo(size_t num_buckets) {
+        const HashTableDirectory *old_directory = directory_.load();
+
+        // Build the new table off to the side. Nobody else can see it until directory_ is published.
+        HashTableDirectory *new_directory = AllocateTable(num_buckets);
+        for (page_id_t block_page_id : old_directory->block_page_ids_) {
+            auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+            auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
 
+            for (size_t bucket_ind = 0; bucket_ind < BLOCK_ARRAY_SIZE; ++bucket_ind) {
+                if (block_page_t->IsReadable(bucket_ind)) {
+                    ReinsertForResize(new_directory, block_page_t->KeyAt(bucket_ind), block_page_t->ValueAt(bucket_ind));
+                }
+            }
+            buffer_pool_manager_->UnpinPage(block_page_id, false);
+        }
+
+        // Publish the new table, then wait until no lock-free reader can still be looking at the old one.
+        directory_.store(new_directory);
+        num_tombstones_ = 0;
+        epoch_manager_.Synchronize();
+
+        for (page_id_t block_page_id : old_directory->block_page_ids_) {
+            buffer_pool_manager_->DeletePage(block_page_id);
+        }
+        for (page_id_t header_page_id : old_directory->header_page_ids_) {
+            buffer_pool_manager_->DeletePage(header_page_id);
+        }
+        delete old_directory;
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    void HASH_TABLE_TYPE::ReinsertForResize(HashTableDirectory *directory, const KeyType &key, const ValueType &value) {
+        const std::vector<page_id_t> &block_page_ids = directory->block_page_ids_;
+        uint64_t hash = hash_fn_.GetHash(key);
+        size_t index, bucket_ind, block_ind;
+        GetIndex(hash, block_page_ids.size(), index, block_ind, bucket_ind);
+        directory->probe_filter_->Add(block_ind, hash);
+
+        // The new table is private to the resizing thread and is at least twice as large as the old one, so there is
+        // always a free slot and no latching is needed.
+        while (true) {
+            page_id_t block_page_id = block_page_ids[block_ind];
+            auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+            auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+            for (; bucket_ind < BLOCK_ARRAY_SIZE; ++bucket_ind) {
+                if (block_page_t->Insert(bucket_ind, key, value)) {
+                    buffer_pool_manager_->UnpinPage(block_page_id, true);
+                    return;
+                }
+            }
+            buffer_pool_manager_->UnpinPage(block_page_id, false);
+            block_ind = (block_ind + 1) % block_page_ids.size();
+            bucket_ind = 0;
+        }
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    HashTableDirectory *HASH_TABLE_TYPE::AllocateTable(size_t num_buckets) {
+        auto directory = new HashTableDirectory();
+
+        // Allocate Block pages
         for (size_t i = 0; i < num_buckets; ++i) {
-            page_id_t block_page_id;
+            page_id_t block_page_id = INVALID_PAGE_ID;
             buffer_pool_manager_->NewPage((&block_page_id));
             if (block_page_id == INVALID_PAGE_ID) {
                 --i;
                 continue;
             }
-            new_header_page_t->AddBlockPageId(block_page_id);
+            directory->block_page_ids_.push_back(block_page_id);
             buffer_pool_manager_->UnpinPage(block_page_id, false);
         }
+        directory->probe_filter_ = std::make_unique<HashTableProbeFilter>(num_buckets, BLOCK_ARRAY_SIZE);
+
+        // Build the header page tree bottom up, until a single root header page remains.
+        std::vector<page_id_t> child_page_ids = directory->block_page_ids_;
+        for (uint32_t level = 0;; ++level) {
+            std::vector<page_id_t> level_page_ids;
+            for (size_t begin = 0; begin < child_page_ids.size(); begin += HashTableHeaderPage::MAX_NUM_BLOCKS) {
+                page_id_t header_page_id;
+                auto header_page_p = buffer_pool_manager_->NewPage(&header_page_id);
+                auto header_page_t = reinterpret_cast<HashTableHeaderPage *>(header_page_p->GetData());
+                header_page_t->SetPageId(header_page_id);
+                header_page_t->SetSize(num_buckets * BLOCK_ARRAY_SIZE);
+                header_page_t->SetLevel(level);
+                size_t end = std::min(begin + HashTableHeaderPage::MAX_NUM_BLOCKS, child_page_ids.size());
+                for (size_t i = begin; i < end; ++i) {
+                    header_page_t->AddBlockPageId(child_page_ids[i]);
+                }
+                buffer_pool_manager_->UnpinPage(header_page_id, true);
+                level_page_ids.push_back(header_page_id);
+                directory->header_page_ids_.push_back(header_page_id);
+            }
+            if (level_page_ids.size() == 1) {
+                directory->header_page_id_ = level_page_ids[0];
+                return directory;
+            }
+            child_page_ids = std::move(level_page_ids);
+        }
+    }
 
-        auto old_header_page_p = buffer_pool_manager_->NewPage((&old_header_page_id));
-        old_header_page_p->RLatch();
-        auto old_header_page_t = reinterpret_cast<HashTableHeaderPage *>(old_header_page_p->GetData());
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    void HASH_TABLE_TYPE::Compact() {
+        table_latch_.WLock();
+        // Rebuilding into a fresh table of the same size, rather than shifting runs in place, keeps lock-free
+        // lookups safe: they either see the old table or the new one, never an entry halfway through a move.
+        if (num_tombstones_ > 0) {
+            GrowTo(directory_.load()->block_page_ids_.size());
+        }
+        table_latch_.WUnlock();
+    }
 
-        for (size_t block_ind = 0; block_ind < initial_size / BLOCK_ARRAY_SIZE; ++block_ind) {
-            page_id_t block_page_id = old_header_page_t->GetBlockPageId(block_ind);
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    HashTableStats HASH_TABLE_TYPE::GetStats() {
+        table_latch_.RLock();
+        const HashTableDirectory *directory = directory_.load();
+        size_t num_blocks = directory->block_page_ids_.size();
+
+        HashTableStats stats;
+        stats.num_slots_ = num_blocks * BLOCK_ARRAY_SIZE;
+        size_t total_probe_length = 0;
+        for (size_t block_ind = 0; block_ind < num_blocks; ++block_ind) {
+            page_id_t block_page_id = directory->block_page_ids_[block_ind];
             auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
             block_page_p->RLatch();
             auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
-
             for (size_t bucket_ind = 0; bucket_ind < BLOCK_ARRAY_SIZE; ++bucket_ind) {
-                if (block_page_t->IsReadable(bucket_ind)) {
-                    KeyType key = block_page_t->KeyAt(bucket_ind);
-                    ValueType value = block_page_t->ValueAt(bucket_ind);
-                    Insert(nullptr, key, value);
+                if (!block_page_t->IsOccupied(bucket_ind)) {
+                    continue;
+                }
+                if (!block_page_t->IsReadable(bucket_ind)) {
+                    stats.num_tombstones_++;
+                    continue;
                 }
+                // The probe length is the distance from the home slot of the key, wrapping around the table.
+                size_t home_index, home_block_ind, home_bucket_ind;
+                GetIndex(block_page_t->KeyAt(bucket_ind), num_blocks, home_index, home_block_ind, home_bucket_ind);
+                size_t index = block_ind * BLOCK_ARRAY_SIZE + bucket_ind;
+                size_t probe_length = (index + stats.num_slots_ - home_index) % stats.num_slots_ + 1;
+                total_probe_length += probe_length;
+                stats.max_probe_length_ = std::max(stats.max_probe_length_, probe_length);
+                stats.num_entries_++;
             }
             block_page_p->RUnlatch();
             buffer_pool_manager_->UnpinPage(block_page_id, false);
-            buffer_pool_manager_->DeletePage(block_page_id);
+        }
+        table_latch_.RUnlock();
+
+        if (stats.num_entries_ > 0) {
+            stats.avg_probe_length_ = static_cast<double>(total_probe_length) / static_cast<double>(stats.num_entries_);
+        }
+        return stats;
+    }
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    size_t HASH_TABLE_TYPE::BulkLoad(Transaction *transaction, const std::vector<MappingType> &entries,
+                                     size_t num_threads) {
+        table_latch_.WLock();
+
+        // Size the table for the final number of entries up front, so that the load never resizes midway.
+        size_t num_entries = CountEntries(*directory_.load()) + entries.size();
+        size_t required_blocks = (num_entries * BULK_LOAD_SLOTS_PER_ENTRY + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE;
+        if (required_blocks > directory_.load()->block_page_ids_.size()) {
+            GrowTo(required_blocks);
+        }
+        const HashTableDirectory *directory = directory_.load();
+        const std::vector<page_id_t> &block_page_ids = directory->block_page_ids_;
+        size_t num_blocks = block_page_ids.size();
+
+        // Partition the entries by the block in which their probe sequence starts.
+        std::vector<std::vector<BulkLoadSlot>> partitions(num_blocks);
+        for (const auto &entry : entries) {
+            uint64_t hash = hash_fn_.GetHash(entry.first);
+            size_t index, bucket_ind, block_ind;
+            GetIndex(hash, num_blocks, index, block_ind, bucket_ind);
+            directory->probe_filter_->Add(block_ind, hash);
+            partitions[block_ind].emplace_back(bucket_ind, &entry);
+        }
+
+        // Every worker fills a contiguous range of blocks, visiting each block page exactly once. Entries whose probe
+        // sequence runs past the end of a block are carried over to the start of the next one.
+        num_threads = std::max<size_t>(1, std::min(num_threads, num_blocks));
+        std::vector<std::vector<BulkLoadSlot>> range_carries(num_threads);
+        std::atomic<size_t> num_inserted{0};
+        auto fill_range = [&](size_t thread_ind) {
+            size_t begin = num_blocks * thread_ind / num_threads;
+            size_t end = num_blocks * (thread_ind + 1) / num_threads;
+            std::vector<BulkLoadSlot> carry;
+            for (size_t block_ind = begin; block_ind < end; ++block_ind) {
+                carry.insert(carry.end(), partitions[block_ind].begin(), partitions[block_ind].end());
+                std::vector<BulkLoadSlot> next_carry;
+                num_inserted += FillBlock(block_page_ids[block_ind], carry, &next_carry);
+                carry = std::move(next_carry);
+            }
+            range_carries[thread_ind] = std::move(carry);
+        };
+
+        if (num_threads == 1) {
+            fill_range(0);
+        } else {
+            std::vector<std::thread> threads;
+            for (size_t thread_ind = 0; thread_ind < num_threads; ++thread_ind) {
+                threads.emplace_back(fill_range, thread_ind);
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+
+        // Whatever ran off the end of a range continues into the (already filled) blocks that follow it.
+        for (size_t thread_ind = 0; thread_ind < num_threads; ++thread_ind) {
+            std::vector<BulkLoadSlot> carry = std::move(range_carries[thread_ind]);
+            size_t block_ind = num_blocks * (thread_ind + 1) / num_threads;
+            for (size_t visited = 0; !carry.empty(); ++visited) {
+                BUSTUB_ASSERT(visited <= num_blocks, "Bulk load ran out of slots.");
+                std::vector<BulkLoadSlot> next_carry;
+                num_inserted += FillBlock(block_page_ids[block_ind % num_blocks], carry, &next_carry);
+                carry = std::move(next_carry);
+                block_ind++;
+            }
         }
 
-        old_header_page_p->RUnlatch();
-        buffer_pool_manager_->UnpinPage(old_header_page_id, false);
-        buffer_pool_manager_->DeletePage(old_header_page_id);
-        new_header_page_p->WUnlatch();
-        buffer_pool_manager_->UnpinPage(header_page_id_, false);
         table_latch_.WUnlock();
+        return num_inserted;
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    size_t HASH_TABLE_TYPE::FillBlock(page_id_t block_page_id, const std::vector<BulkLoadSlot> &slots,
+                                      std::vector<BulkLoadSlot> *carry) {
+        auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+        block_page_p->WLatch();
+        auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+
+        size_t num_inserted = 0;
+        for (const auto &slot : slots) {
+            const auto &key = slot.second->first;
+            const auto &value = slot.second->second;
+            size_t bucket_ind = slot.first;
+            for (; bucket_ind < BLOCK_ARRAY_SIZE; ++bucket_ind) {
+                // Tombstones are reused, as in Insert.
+                bool is_tombstone = block_page_t->IsOccupied(bucket_ind);
+                if (block_page_t->Insert(bucket_ind, key, value)) {
+                    if (is_tombstone) {
+                        num_tombstones_--;
+                    }
+                    num_inserted++;
+                    break;
+                }
+                // Identical <k,v> pairs are skipped, as in Insert.
+                if (comparator_(key, block_page_t->KeyAt(bucket_ind)) == 0 && value == block_page_t->ValueAt(bucket_ind)) {
+                    break;
+                }
+            }
+            if (bucket_ind == BLOCK_ARRAY_SIZE) {
+                carry->emplace_back(0, slot.second);
+            }
+        }
+
+        block_page_p->WUnlatch();
+        buffer_pool_manager_->UnpinPage(block_page_id, num_inserted > 0);
+        return num_inserted;
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    size_t HASH_TABLE_TYPE::CountEntries(const HashTableDirectory &directory) {
+        size_t num_entries = 0;
+        for (page_id_t block_page_id : directory.block_page_ids_) {
+            auto block_page_p = buffer_pool_manager_->FetchPage(block_page_id);
+            auto block_page_t = reinterpret_cast<HashTableBlockPage<KeyType, ValueType, KeyComparator> *>(block_page_p->GetData());
+            for (size_t bucket_ind = 0; bucket_ind < BLOCK_ARRAY_SIZE; ++bucket_ind) {
+                if (block_page_t->IsReadable(bucket_ind)) {
+                    num_entries++;
+                }
+            }
+            buffer_pool_manager_->UnpinPage(block_page_id, false);
+        }
+        return num_entries;
     }
 
 /*****************************************************************************
@@ -359,22 +549,26 @@ namespace bustub {
  *****************************************************************************/
     template<typename KeyType, typename ValueType, typename KeyComparator>
     size_t HASH_TABLE_TYPE::GetSize() {
-        table_latch_.RLock();
-        auto header_page_p = buffer_pool_manager_->FetchPage(header_page_id_);
-        header_page_p->RLatch();
-        auto header_page_t = reinterpret_cast<HashTableHeaderPage *>(header_page_p->GetData());
+        EpochGuard epoch_guard(&epoch_manager_);
+        return directory_.load()->block_page_ids_.size() * BLOCK_ARRAY_SIZE;
+    }
 
-        size_t size = header_page_t->GetSize();
-        header_page_p->RUnlatch();
-        buffer_pool_manager_->UnpinPage(header_page_id_, false);
-        table_latch_.RUnlock();
-        return size;
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    page_id_t HASH_TABLE_TYPE::GetHeaderPageId() {
+        EpochGuard epoch_guard(&epoch_manager_);
+        return directory_.load()->header_page_id_;
     }
 
     template<typename KeyType, typename ValueType, typename KeyComparator>
     void HASH_TABLE_TYPE::GetIndex(const KeyType &key, const size_t &numBlocks, size_t &index, size_t &block_ind,
                                   size_t &bucket_ind) {
-        index = hash_fn_.GetHash(key) % (numBlocks * BLOCK_ARRAY_SIZE);
+        GetIndex(hash_fn_.GetHash(key), numBlocks, index, block_ind, bucket_ind);
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    void HASH_TABLE_TYPE::GetIndex(uint64_t hash, const size_t &numBlocks, size_t &index, size_t &block_ind,
+                                  size_t &bucket_ind) {
+        index = hash % (numBlocks * BLOCK_ARRAY_SIZE);
         block_ind = index / BLOCK_ARRAY_SIZE;
         bucket_ind = index % BLOCK_ARRAY_SIZE;
     }
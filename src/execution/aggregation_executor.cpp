@@ -9,9 +9,14 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "execution/executor_factory.h"
 #include "execution/executors/aggregation_executor.h"
 
 namespace bustub {
@@ -19,46 +24,374 @@ namespace bustub {
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
     : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)), aht_(plan->GetAggregates(), plan->GetAggregateTypes()),
-    aht_iterator_(aht_.Begin()) {}
+    aht_iterator_(aht_.Begin()), spill_schema_(MakeSpillSchema(plan)) {}
 
 const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
 
 const Schema *AggregationExecutor::GetOutputSchema() { return plan_->OutputSchema(); }
 
 void AggregationExecutor::Init() {
-    child_->Init();
-
-    // Build Aggregation Hash Table.
-    aht_.GenerateInitialAggregateValue();
-    Tuple tuple;
-    while(child_->Next(&tuple)){
-        auto key = MakeKey(&tuple);
-        auto value = MakeVal(&tuple);
-        aht_.InsertCombine(key, value);
+    auto worker_pool = exec_ctx_->GetWorkerPool();
+    aht_.Clear();
+    spill_heaps_.clear();
+    spill_partitions_.clear();
+    merged_partitions_.clear();
+    if(worker_pool != nullptr && ExecutorFactory::IsParallelPipeline(plan_->GetChildPlan())){
+        ParallelBuild(worker_pool);
+    } else {
+        child_->Init();
+        BuildFrom(child_.get(), &aht_, exec_ctx_->GetMemoryBudget(), &spill_heaps_);
+        FinishSpilling();
     }
     aht_iterator_ = aht_.Begin();
 }
 
-bool AggregationExecutor::Next(Tuple *tuple) {
-    while(aht_iterator_ != aht_.End()){
-        auto group_bys = aht_iterator_.Key().group_bys_;
-        auto aggregates = aht_iterator_.Val().aggregates_;
+void AggregationExecutor::InitPush() {
+    aht_.Clear();
+    spill_heaps_.clear();
+    spill_partitions_.clear();
+    merged_partitions_.clear();
+    push_state_ = std::make_unique<BuildState>(plan_);
+}
+
+void AggregationExecutor::Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {
+    AggregateBatch(*batch, &aht_, exec_ctx_->GetMemoryBudget(), &spill_heaps_, push_state_.get());
+}
+
+void AggregationExecutor::FinishPush(uint32_t input_idx, BatchConsumer *consumer) {
+    FlushTyped(&aht_, push_state_.get());
+    push_state_.reset();
+    FinishSpilling();
+    aht_iterator_ = aht_.Begin();
+}
+
+void AggregationExecutor::FinishSpilling() {
+    if(spill_heaps_.empty()){
+        return;
+    }
+    // Spill what is left too, and re-aggregate partition by partition.
+    SpillGroups(&aht_, 0, &spill_heaps_);
+    for(auto &heap : spill_heaps_){
+        spill_partitions_.emplace_back();
+        spill_partitions_.back().groups_.push_back(std::move(heap));
+    }
+    spill_heaps_.clear();
+    LoadNextPartition();
+}
+
+void AggregationExecutor::ParallelBuild(WorkerPool *worker_pool) {
+    auto new_table = [this](){
+        return std::make_unique<SimpleAggregationHashTable>(plan_->GetAggregates(), plan_->GetAggregateTypes());
+    };
+    size_t num_workers = worker_pool->NumWorkers();
+    size_t num_partitions = num_workers * PARTITIONS_PER_WORKER;
+
+    // Phase 1: Every worker pre-aggregates the morsels it claims within its share of the budget, and partitions its
+    // groups.
+    auto morsels = ExecutorFactory::CreateMorselQueue(exec_ctx_, plan_->GetChildPlan());
+    size_t worker_budget = exec_ctx_->GetMemoryBudget() / num_workers;
+    std::vector<std::vector<std::unique_ptr<SimpleAggregationHashTable>>> local_parts(num_workers);
+    std::vector<std::vector<std::unique_ptr<TmpTupleHeap>>> local_spills(num_workers);
+    worker_pool->RunOnAll([&](size_t worker_id){
+        auto pipeline = ExecutorFactory::CreatePipelineExecutor(exec_ctx_, plan_->GetChildPlan(), morsels.get());
+        pipeline->Init();
+        auto local_aht = new_table();
+        BuildFrom(pipeline.get(), local_aht.get(), worker_budget, &local_spills[worker_id]);
+        for(size_t i = 0; i < num_partitions; ++i){
+            local_parts[worker_id].push_back(new_table());
+        }
+        local_aht->SplitInto(local_parts[worker_id]);
+    });
+
+    bool spilled = std::any_of(local_spills.begin(), local_spills.end(),
+                               [](const auto &heaps){ return !heaps.empty(); });
+    if(spilled){
+        // As after a serial build that spilled, the groups left in memory are spilled too, and the spilled partitions
+        // are re-aggregated one at a time, each from the heaps of all workers.
+        worker_pool->RunOnAll([&](size_t worker_id){
+            auto &heaps = local_spills[worker_id];
+            if(heaps.empty()){
+                heaps = CreateSpillHeaps();
+            }
+            for(auto &part : local_parts[worker_id]){
+                SpillGroups(part.get(), 0, &heaps);
+            }
+        });
+        for(size_t i = 0; i < SPILL_FANOUT; ++i){
+            spill_partitions_.emplace_back();
+            for(auto &heaps : local_spills){
+                spill_partitions_.back().groups_.push_back(std::move(heaps[i]));
+            }
+        }
+        LoadNextPartition();
+        return;
+    }
+
+    // Phase 2: Every worker merges whole partitions.
+    merged_partitions_.resize(num_partitions);
+    std::atomic<size_t> next_partition{0};
+    worker_pool->RunOnAll([&](size_t worker_id){
+        for(size_t part = next_partition++; part < num_partitions; part = next_partition++){
+            merged_partitions_[part] = new_table();
+            for(const auto &worker_parts : local_parts){
+                merged_partitions_[part]->Merge(*worker_parts[part]);
+            }
+        }
+    });
+    LoadNextPartition();
+}
+
+std::vector<std::unique_ptr<TmpTupleHeap>> AggregationExecutor::CreateSpillHeaps() {
+    std::vector<std::unique_ptr<TmpTupleHeap>> heaps;
+    for(size_t i = 0; i < SPILL_FANOUT; ++i){
+        heaps.push_back(std::make_unique<TmpTupleHeap>(exec_ctx_->GetBufferPoolManager()));
+    }
+    return heaps;
+}
+
+std::unique_ptr<Schema> AggregationExecutor::MakeSpillSchema(const AggregationPlanNode *plan) {
+    std::vector<TypeId> types;
+    for(const auto &group_by : plan->GetGroupBys()){
+        types.push_back(group_by->GetReturnType());
+    }
+    for(size_t i = 0; i < plan->GetAggregates().size(); ++i){
+        TypeId input_type = plan->GetAggregateAt(i)->GetReturnType();
+        switch(plan->GetAggregateTypes()[i]){
+            case AggregationType::CountAggregate:
+                types.push_back(TypeId::INTEGER);
+                break;
+            case AggregationType::SumAggregate:
+                // Sums start from an INTEGER zero, which only a wider input type widens.
+                types.push_back(input_type == TypeId::BIGINT || input_type == TypeId::DECIMAL ? input_type
+                                                                                              : TypeId::INTEGER);
+                break;
+            case AggregationType::MinAggregate:
+            case AggregationType::MaxAggregate:
+                types.push_back(input_type);
+                break;
+        }
+    }
+    std::vector<Column> columns;
+    for(size_t i = 0; i < types.size(); ++i){
+        std::string name = "spill_" + std::to_string(i);
+        if(types[i] == TypeId::VARCHAR){
+            columns.emplace_back(name, TypeId::VARCHAR, BUSTUB_VARCHAR_MAX_LEN);
+        } else {
+            columns.emplace_back(name, types[i]);
+        }
+    }
+    return std::make_unique<Schema>(columns);
+}
+
+void AggregationExecutor::SpillGroups(SimpleAggregationHashTable *aht, size_t level,
+                                      std::vector<std::unique_ptr<TmpTupleHeap>> *heaps) {
+    size_t num_group_bys = plan_->GetGroupBys().size();
+    std::vector<Value> values(spill_schema_->GetColumnCount());
+    for(auto iter = aht->Begin(); iter != aht->End(); ++iter){
+        // Values are stored with the types of the columns, which e.g. an INTEGER min over BIGINT inputs is not.
+        for(uint32_t i = 0; i < values.size(); ++i){
+            const Value &value =
+                i < num_group_bys ? iter.Key().group_bys_[i] : iter.Val().aggregates_[i - num_group_bys];
+            TypeId type = spill_schema_->GetColumn(i).GetType();
+            values[i] = value.GetTypeId() == type ? value : value.CastAs(type);
+        }
+        size_t hash = std::hash<AggregateKey>{}(iter.Key());
+        (*heaps)[SpillPartitionOf(hash, level)]->Append(Tuple(values, spill_schema_.get()));
+    }
+    aht->Clear();
+}
+
+void AggregationExecutor::ReadGroup(const Tuple &tuple, AggregateKey *key, AggregateValue *value) {
+    size_t num_group_bys = plan_->GetGroupBys().size();
+    key->group_bys_.clear();
+    value->aggregates_.clear();
+    for(uint32_t i = 0; i < spill_schema_->GetColumnCount(); ++i){
+        if(i < num_group_bys){
+            key->group_bys_.push_back(tuple.GetValue(spill_schema_.get(), i));
+        } else {
+            value->aggregates_.push_back(tuple.GetValue(spill_schema_.get(), i));
+        }
+    }
+}
+
+bool AggregationExecutor::LoadNextPartition() {
+    if(!merged_partitions_.empty()){
+        aht_.MoveFrom(merged_partitions_.back().get());
+        merged_partitions_.pop_back();
+        return true;
+    }
+    if(spill_partitions_.empty()){
+        return false;
+    }
+    aht_.Clear();
+    std::vector<Tuple> tuples;
+    AggregateKey key;
+    AggregateValue value;
+    while(!spill_partitions_.empty()){
+        SpillPartition partition = std::move(spill_partitions_.back());
+        spill_partitions_.pop_back();
+        size_t num_groups = 0;
+        for(const auto &heap : partition.groups_){
+            num_groups += heap->NumTuples();
+        }
+        if(num_groups == 0){
+            continue;
+        }
+        // Reads back every group of the partition, from all of its heaps, and calls func(tuple) with key and value.
+        auto for_each_group = [&](auto &&func){
+            for(const auto &heap : partition.groups_){
+                for(size_t page_idx = 0; page_idx < heap->NumPages(); ++page_idx){
+                    tuples.clear();
+                    heap->GetPageTuples(page_idx, &tuples);
+                    for(const auto &tuple : tuples){
+                        ReadGroup(tuple, &key, &value);
+                        func(tuple);
+                    }
+                }
+            }
+        };
+
+        // A partition may hold several partial aggregates of the same group, so this overestimates its size.
+        bool fits = num_groups * GroupFootprint() <= exec_ctx_->GetMemoryBudget();
+        if(!fits && partition.level_ + 1 < MAX_SPILL_LEVEL){
+            // Still too large: split it on the next bits of the hashes.
+            size_t level = partition.level_ + 1;
+            auto heaps = CreateSpillHeaps();
+            for_each_group([&](const Tuple &tuple){
+                heaps[SpillPartitionOf(std::hash<AggregateKey>{}(key), level)]->Append(tuple);
+            });
+            for(auto &heap : heaps){
+                spill_partitions_.emplace_back();
+                spill_partitions_.back().groups_.push_back(std::move(heap));
+                spill_partitions_.back().level_ = level;
+            }
+            continue;
+        }
+
+        for_each_group([&](const Tuple &tuple){ aht_.MergeGroup(key, value); });
+        return true;
+    }
+    return false;
+}
+
+AggregationExecutor::BuildState::BuildState(const AggregationPlanNode *plan)
+    : group_bys_(plan->GetGroupBys().size()),
+      aggregates_(plan->GetAggregates().size()),
+      group_by_scratch_(group_bys_.size()),
+      aggregate_scratch_(aggregates_.size()) {
+    key_.group_bys_.resize(group_bys_.size());
+    value_.aggregates_.resize(aggregates_.size());
+    if(FixedWidthAggregationHashTable::Supports(plan)){
+        typed_aht_ = std::make_unique<FixedWidthAggregationHashTable>(plan);
+    }
+}
+
+void AggregationExecutor::BuildFrom(AbstractExecutor *child, SimpleAggregationHashTable *aht,
+                                    size_t memory_budget, std::vector<std::unique_ptr<TmpTupleHeap>> *spill_heaps) {
+    BuildState state(plan_);
+    TupleBatch batch;
+    while(child->NextBatch(&batch)){
+        AggregateBatch(batch, aht, memory_budget, spill_heaps, &state);
+    }
+    FlushTyped(aht, &state);
+}
+
+void AggregationExecutor::AggregateBatch(const TupleBatch &batch, SimpleAggregationHashTable *aht,
+                                         size_t memory_budget,
+                                         std::vector<std::unique_ptr<TmpTupleHeap>> *spill_heaps,
+                                         BuildState *state) {
+    // Build Aggregation Hash Table, evaluating the group bys and aggregates a batch at a time.
+    const auto &group_by_exprs = plan_->GetGroupBys();
+    const auto &aggregate_exprs = plan_->GetAggregates();
+    auto &group_bys = state->group_bys_;
+    auto &aggregates = state->aggregates_;
+    for(size_t i = 0; i < group_by_exprs.size(); ++i){
+        group_bys[i] = &group_by_exprs[i]->EvaluateBatchView(batch, &state->group_by_scratch_[i]);
+    }
+    for(size_t i = 0; i < aggregate_exprs.size(); ++i){
+        aggregates[i] = &aggregate_exprs[i]->EvaluateBatchView(batch, &state->aggregate_scratch_[i]);
+    }
+
+    // Only rows with a null key reach aht if there is a typed table.
+    const std::vector<uint32_t> *rows = &batch.GetSelection();
+    if(state->typed_aht_ != nullptr){
+        state->typed_aht_->Aggregate(group_bys, aggregates, batch.GetSelection(), &state->null_key_rows_);
+        rows = &state->null_key_rows_;
+    }
+    for(uint32_t row_idx : *rows){
+        for(size_t i = 0; i < group_bys.size(); ++i){
+            state->key_.group_bys_[i] = (*group_bys[i])[row_idx];
+        }
+        for(size_t i = 0; i < aggregates.size(); ++i){
+            state->value_.aggregates_[i] = (*aggregates[i])[row_idx];
+        }
+        aht->InsertCombine(state->key_, state->value_);
+    }
+    size_t footprint = aht->Size() * GroupFootprint();
+    if(state->typed_aht_ != nullptr){
+        footprint += state->typed_aht_->Size() * state->typed_aht_->GroupFootprint();
+    }
+    if(footprint > memory_budget){
+        if(spill_heaps->empty()){
+            *spill_heaps = CreateSpillHeaps();
+        }
+        FlushTyped(aht, state);
+        SpillGroups(aht, 0, spill_heaps);
+    }
+}
+
+void AggregationExecutor::FlushTyped(SimpleAggregationHashTable *aht, BuildState *state) {
+    if(state->typed_aht_ == nullptr){
+        return;
+    }
+    state->typed_aht_->ForEachGroup([aht](const AggregateKey &typed_key, const AggregateValue &typed_value){
+        aht->MergeGroup(typed_key, typed_value);
+    });
+    state->typed_aht_->Clear();
+}
+
+bool AggregationExecutor::NextGroup(std::vector<Value> *out_values) {
+    while(true){
+        if(aht_iterator_ == aht_.End()){
+            // Move on to the next spilled partition, if any.
+            if(!LoadNextPartition()){
+                return false;
+            }
+            aht_iterator_ = aht_.Begin();
+            continue;
+        }
+        const auto &group_bys = aht_iterator_.Key().group_bys_;
+        const auto &aggregates = aht_iterator_.Val().aggregates_;
         if(!plan_->GetHaving()
         || plan_->GetHaving()->EvaluateAggregate(group_bys, aggregates).GetAs<bool>()){
-            std::vector<Value> out_values;
+            out_values->clear();
             size_t num_cols = plan_->OutputSchema()->GetColumnCount();
             for(size_t i = 0; i < num_cols; ++i){
-                out_values.push_back(plan_->OutputSchema()->GetColumn(i).GetExpr()->EvaluateAggregate(group_bys, aggregates));
+                out_values->push_back(plan_->OutputSchema()->GetColumn(i).GetExpr()->EvaluateAggregate(group_bys, aggregates));
             }
-
-            *tuple = Tuple(out_values, plan_->OutputSchema());
             ++aht_iterator_;
             return true;
-        }else{
-            ++aht_iterator_;
         }
+        ++aht_iterator_;
     }
-    return false;
+}
+
+bool AggregationExecutor::Next(Tuple *tuple) {
+    std::vector<Value> out_values;
+    if(!NextGroup(&out_values)){
+        return false;
+    }
+    *tuple = Tuple(out_values, plan_->OutputSchema());
+    return true;
+}
+
+bool AggregationExecutor::NextBatch(TupleBatch *batch) {
+    batch->Reset(plan_->OutputSchema()->GetColumnCount());
+    std::vector<Value> out_values;
+    while(!batch->IsFull() && NextGroup(&out_values)){
+        batch->AppendRow(out_values);
+    }
+    return !batch->IsEmpty();
 }
 
 }  // namespace bustub
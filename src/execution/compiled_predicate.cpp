@@ -0,0 +1,358 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.cpp
+//
+// Identification: src/execution/compiled_predicate.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/compiled_predicate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/simd_filter.h"
+
+namespace bustub {
+
+namespace {
+
+using Kernel = CompiledPredicate::Kernel;
+using Operand = CompiledPredicate::Operand;
+
+template <typename T>
+T Load(const char *data, const Operand &operand) {
+  T value;
+  std::memcpy(&value, data + operand.offset_, sizeof(T));
+  return value;
+}
+
+/** @return the column of a join pair batch that an operand reads */
+const std::vector<Value> &ColumnOf(const TupleBatch &left, const TupleBatch &right, const Operand &operand) {
+  return (operand.tuple_idx_ == 0 ? left : right).GetColumn(operand.col_idx_);
+}
+
+/** @return the constant of a kernel, as the type C the comparison is made in */
+template <typename C>
+C ConstantOf(const Kernel &kernel) {
+  if constexpr (std::is_same_v<C, int64_t>) {
+    return kernel.int_constant_;
+  } else {
+    return kernel.decimal_constant_;
+  }
+}
+
+/** Column of type T, compared as C with a constant. */
+template <typename T, typename C, typename Op>
+bool ColumnConstantRow(const Kernel &kernel, const char *data) {
+  T value = Load<T>(data, kernel.lhs_);
+  return value != SimdFilter::NullOf<T>() && Op()(static_cast<C>(value), ConstantOf<C>(kernel));
+}
+
+/**
+ * Column of type T compared with a constant, on a batch. The selected values are gathered into a contiguous array of
+ * S, with the null of S for nulls, and compared by SimdFilter.
+ */
+template <typename T, typename S>
+void ColumnConstantBatch(const Kernel &kernel, TupleBatch *left, const TupleBatch &right) {
+  using C = std::conditional_t<std::is_integral_v<S>, int64_t, double>;
+  thread_local std::vector<S> values;
+  thread_local std::vector<uint64_t> bitmap;
+  const auto &column = ColumnOf(*left, right, kernel.lhs_);
+  const auto &selection = left->GetSelection();
+  size_t num_values = selection.size();
+  values.resize(num_values);
+  for (size_t i = 0; i < num_values; i++) {
+    const Value &value = column[selection[i]];
+    values[i] = value.IsNull() ? SimdFilter::NullOf<S>() : static_cast<S>(value.GetAs<T>());
+  }
+  bitmap.resize((num_values + 63) / 64);
+  SimdFilter::Compare(values.data(), num_values, kernel.comp_type_, static_cast<S>(ConstantOf<C>(kernel)),
+                      bitmap.data());
+  // FilterRows visits the selection in order, so the i-th call is about values[i].
+  size_t i = 0;
+  left->FilterRows([&](uint32_t row_idx) {
+    bool keep = (bitmap[i / 64] >> (i % 64)) & 1;
+    i++;
+    return keep;
+  });
+}
+
+/**
+ * Column of type T compared with a constant, on tuples. The column is gathered from the selected tuples into a
+ * contiguous array of S, with the null of S for the null of T, and compared by SimdFilter.
+ */
+template <typename T, typename S>
+void ColumnConstantTuples(const Kernel &kernel, const char *const *tuples, std::vector<uint32_t> *selection) {
+  using C = std::conditional_t<std::is_integral_v<S>, int64_t, double>;
+  thread_local std::vector<S> values;
+  thread_local std::vector<uint64_t> bitmap;
+  size_t num_values = selection->size();
+  values.resize(num_values);
+  for (size_t i = 0; i < num_values; i++) {
+    T value = Load<T>(tuples[(*selection)[i]], kernel.lhs_);
+    values[i] = value == SimdFilter::NullOf<T>() ? SimdFilter::NullOf<S>() : static_cast<S>(value);
+  }
+  bitmap.resize((num_values + 63) / 64);
+  SimdFilter::Compare(values.data(), num_values, kernel.comp_type_, static_cast<S>(ConstantOf<C>(kernel)),
+                      bitmap.data());
+  size_t num_kept = 0;
+  for (size_t i = 0; i < num_values; i++) {
+    (*selection)[num_kept] = (*selection)[i];
+    num_kept += (bitmap[i / 64] >> (i % 64)) & 1;
+  }
+  selection->resize(num_kept);
+}
+
+/** Any kernel on tuples, one row at a time. */
+void RowTuples(const Kernel &kernel, const char *const *tuples, std::vector<uint32_t> *selection) {
+  auto kept = std::remove_if(selection->begin(), selection->end(),
+                             [&](uint32_t row_idx) { return !kernel.row_fn_(kernel, tuples[row_idx]); });
+  selection->erase(kept, selection->end());
+}
+
+/** Two columns of types L and R, compared as C. */
+template <typename L, typename R, typename C, typename Op>
+bool ColumnColumnRow(const Kernel &kernel, const char *data) {
+  L lhs = Load<L>(data, kernel.lhs_);
+  R rhs = Load<R>(data, kernel.rhs_);
+  return lhs != SimdFilter::NullOf<L>() && rhs != SimdFilter::NullOf<R>() &&
+         Op()(static_cast<C>(lhs), static_cast<C>(rhs));
+}
+
+template <typename L, typename R, typename C, typename Op>
+void ColumnColumnBatch(const Kernel &kernel, TupleBatch *left, const TupleBatch &right) {
+  const auto &lhs = ColumnOf(*left, right, kernel.lhs_);
+  const auto &rhs = ColumnOf(*left, right, kernel.rhs_);
+  left->FilterRows([&](uint32_t row_idx) {
+    return !lhs[row_idx].IsNull() && !rhs[row_idx].IsNull() &&
+           Op()(static_cast<C>(lhs[row_idx].GetAs<L>()), static_cast<C>(rhs[row_idx].GetAs<R>()));
+  });
+}
+
+/** A comparison that is never true, e.g. with a null constant. */
+bool NeverRow(const Kernel &kernel, const char *data) { return false; }
+
+void NeverBatch(const Kernel &kernel, TupleBatch *left, const TupleBatch &right) {
+  left->FilterRows([](uint32_t row_idx) { return false; });
+}
+
+/** Calls func(T{}) with the C++ type T of a fixed-width column type. @return false if there is none */
+template <typename Func>
+bool DispatchType(TypeId type, Func &&func) {
+  switch (type) {
+    case TypeId::TINYINT:
+      func(int8_t{});
+      return true;
+    case TypeId::SMALLINT:
+      func(int16_t{});
+      return true;
+    case TypeId::INTEGER:
+      func(int32_t{});
+      return true;
+    case TypeId::BIGINT:
+      func(int64_t{});
+      return true;
+    case TypeId::DECIMAL:
+      func(double{});
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** Calls func(Op{}) with the functor of a comparison. */
+template <typename Func>
+void DispatchComparison(ComparisonType comp_type, Func &&func) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      func(std::equal_to<>());
+      break;
+    case ComparisonType::NotEqual:
+      func(std::not_equal_to<>());
+      break;
+    case ComparisonType::LessThan:
+      func(std::less<>());
+      break;
+    case ComparisonType::LessThanOrEqual:
+      func(std::less_equal<>());
+      break;
+    case ComparisonType::GreaterThan:
+      func(std::greater<>());
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      func(std::greater_equal<>());
+      break;
+  }
+}
+
+/** @return the comparison with its operands swapped, e.g. GreaterThan for LessThan */
+ComparisonType Flip(ComparisonType comp_type) {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+/** Resolves a column against the schema of its side. */
+Operand OperandOf(const ColumnValueExpression *column, const Schema *schema, const Schema *right_schema,
+                  TypeId *type) {
+  const Schema *side = column->GetTupleIdx() == 1 && right_schema != nullptr ? right_schema : schema;
+  const Column &col = side->GetColumn(column->GetColIdx());
+  *type = col.GetType();
+  return Operand{column->GetTupleIdx(), column->GetColIdx(), col.GetOffset()};
+}
+
+Kernel NeverKernel() {
+  Kernel kernel{};
+  kernel.row_fn_ = NeverRow;
+  kernel.batch_fn_ = NeverBatch;
+  kernel.tuples_fn_ = RowTuples;
+  return kernel;
+}
+
+bool LowerColumnConstant(const Operand &column, TypeId column_type, const Value &constant, ComparisonType comp_type,
+                         std::vector<Kernel> *program) {
+  TypeId constant_type = constant.GetTypeId();
+  bool numeric_constant = DispatchType(constant_type, [](auto tag) {});
+  if (!numeric_constant) {
+    return false;
+  }
+  if (constant.IsNull()) {
+    program->push_back(NeverKernel());
+    return true;
+  }
+  Kernel kernel{};
+  kernel.lhs_ = column;
+  kernel.comp_type_ = comp_type;
+  // Integers are compared as BIGINT, and as DECIMAL as soon as either side is one.
+  bool as_decimal = column_type == TypeId::DECIMAL || constant_type == TypeId::DECIMAL;
+  if (as_decimal) {
+    kernel.decimal_constant_ = constant.CastAs(TypeId::DECIMAL).GetAs<double>();
+  } else {
+    kernel.int_constant_ = constant.CastAs(TypeId::BIGINT).GetAs<int64_t>();
+  }
+  bool supported = DispatchType(column_type, [&](auto tag) {
+    using T = decltype(tag);
+    DispatchComparison(comp_type, [&](auto op) {
+      using Op = decltype(op);
+      if (as_decimal) {
+        kernel.row_fn_ = ColumnConstantRow<T, double, Op>;
+      } else if constexpr (std::is_integral_v<T>) {
+        kernel.row_fn_ = ColumnConstantRow<T, int64_t, Op>;
+      }
+    });
+    // Batches are compared in the narrowest lanes that hold both the column and the constant.
+    if (as_decimal) {
+      kernel.batch_fn_ = ColumnConstantBatch<T, double>;
+      kernel.tuples_fn_ = ColumnConstantTuples<T, double>;
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(int32_t)) {
+      bool fits = kernel.int_constant_ >= BUSTUB_INT32_MIN && kernel.int_constant_ <= BUSTUB_INT32_MAX;
+      kernel.batch_fn_ = fits ? ColumnConstantBatch<T, int32_t> : ColumnConstantBatch<T, int64_t>;
+      kernel.tuples_fn_ = fits ? ColumnConstantTuples<T, int32_t> : ColumnConstantTuples<T, int64_t>;
+    } else if constexpr (std::is_integral_v<T>) {
+      kernel.batch_fn_ = ColumnConstantBatch<T, int64_t>;
+      kernel.tuples_fn_ = ColumnConstantTuples<T, int64_t>;
+    }
+  });
+  if (!supported) {
+    return false;
+  }
+  program->push_back(kernel);
+  return true;
+}
+
+bool LowerColumnColumn(const Operand &lhs, TypeId lhs_type, const Operand &rhs, TypeId rhs_type,
+                       ComparisonType comp_type, std::vector<Kernel> *program) {
+  Kernel kernel{};
+  kernel.lhs_ = lhs;
+  kernel.rhs_ = rhs;
+  bool supported = false;
+  DispatchType(lhs_type, [&](auto lhs_tag) {
+    supported = DispatchType(rhs_type, [&](auto rhs_tag) {
+      using L = decltype(lhs_tag);
+      using R = decltype(rhs_tag);
+      // Integers are compared as BIGINT, and as DECIMAL as soon as either side is one.
+      using C = std::conditional_t<std::is_integral_v<L> && std::is_integral_v<R>, int64_t, double>;
+      DispatchComparison(comp_type, [&](auto op) {
+        using Op = decltype(op);
+        kernel.row_fn_ = ColumnColumnRow<L, R, C, Op>;
+        kernel.batch_fn_ = ColumnColumnBatch<L, R, C, Op>;
+        kernel.tuples_fn_ = RowTuples;
+      });
+    });
+  });
+  if (!supported) {
+    return false;
+  }
+  program->push_back(kernel);
+  return true;
+}
+
+bool Lower(const AbstractExpression *expr, const Schema *schema, const Schema *right_schema,
+           std::vector<Kernel> *program) {
+  auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return false;
+  }
+  ComparisonType comp_type = comparison->GetComparisonType();
+  auto lhs_column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  auto rhs_column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+  auto lhs_constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+  auto rhs_constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  TypeId lhs_type;
+  TypeId rhs_type;
+  if (lhs_column != nullptr && rhs_column != nullptr) {
+    Operand lhs = OperandOf(lhs_column, schema, right_schema, &lhs_type);
+    Operand rhs = OperandOf(rhs_column, schema, right_schema, &rhs_type);
+    return LowerColumnColumn(lhs, lhs_type, rhs, rhs_type, comp_type, program);
+  }
+  if (lhs_column != nullptr && rhs_constant != nullptr) {
+    Operand lhs = OperandOf(lhs_column, schema, right_schema, &lhs_type);
+    return LowerColumnConstant(lhs, lhs_type, rhs_constant->Evaluate(nullptr, nullptr), comp_type, program);
+  }
+  if (lhs_constant != nullptr && rhs_column != nullptr) {
+    Operand rhs = OperandOf(rhs_column, schema, right_schema, &rhs_type);
+    return LowerColumnConstant(rhs, rhs_type, lhs_constant->Evaluate(nullptr, nullptr), Flip(comp_type), program);
+  }
+  if (lhs_constant != nullptr && rhs_constant != nullptr) {
+    // Folded now: a true comparison needs no kernel.
+    if (comparison->Evaluate(nullptr, nullptr).CompareEquals(ValueFactory::GetBooleanValue(true)) != CmpBool::CmpTrue) {
+      program->push_back(NeverKernel());
+    }
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+std::unique_ptr<CompiledPredicate> CompiledPredicate::Compile(const AbstractExpression *predicate,
+                                                              const Schema *schema, const Schema *right_schema) {
+  std::unique_ptr<CompiledPredicate> compiled(new CompiledPredicate());
+  if (predicate == nullptr || !Lower(predicate, schema, right_schema, &compiled->program_)) {
+    return nullptr;
+  }
+  return compiled;
+}
+
+}  // namespace bustub
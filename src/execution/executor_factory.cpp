@@ -18,8 +18,14 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/hash_join_executor.h"
+#include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/merge_join_executor.h"
+#include "execution/executors/nested_index_join_executor.h"
+#include "execution/executors/pipeline_executor.h"
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/topn_executor.h"
 
 namespace bustub {
 std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx,
@@ -30,6 +36,11 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
       return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan));
     }
 
+    // Create a new index scan executor.
+    case PlanType::IndexScan: {
+      return std::make_unique<IndexScanExecutor>(exec_ctx, dynamic_cast<const IndexScanPlanNode *>(plan));
+    }
+
     // Create a new insert executor.
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan);
@@ -47,6 +58,22 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
                                                 std::move(right_executor));
     }
 
+    // Create a new merge join executor.
+    case PlanType::MergeJoin: {
+      auto join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan);
+      auto left_executor = ExecutorFactory::CreateExecutor(exec_ctx, join_plan->GetLeftPlan());
+      auto right_executor = ExecutorFactory::CreateExecutor(exec_ctx, join_plan->GetRightPlan());
+      return std::make_unique<MergeJoinExecutor>(exec_ctx, join_plan, std::move(left_executor),
+                                                 std::move(right_executor));
+    }
+
+    // Create a new nested index join executor.
+    case PlanType::NestedIndexJoin: {
+      auto join_plan = dynamic_cast<const NestedIndexJoinPlanNode *>(plan);
+      auto outer_executor = ExecutorFactory::CreateExecutor(exec_ctx, join_plan->GetOuterPlan());
+      return std::make_unique<NestedIndexJoinExecutor>(exec_ctx, join_plan, std::move(outer_executor));
+    }
+
     // Create a new aggregation executor.
     case PlanType::Aggregation: {
       auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
@@ -54,9 +81,44 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
       return std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
     }
 
+    // Create a new sort executor.
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+
+    // Create a new top-n executor.
+    case PlanType::TopN: {
+      auto topn_plan = dynamic_cast<const TopNPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, topn_plan->GetChildPlan());
+      return std::make_unique<TopNExecutor>(exec_ctx, topn_plan, std::move(child_executor));
+    }
+
     default: {
       BUSTUB_ASSERT(false, "Unsupported plan type.");
     }
   }
 }
+
+std::unique_ptr<AbstractExecutor> ExecutorFactory::CreatePushExecutor(ExecutorContext *exec_ctx,
+                                                                      const AbstractPlanNode *plan) {
+  return std::make_unique<PipelineExecutor>(exec_ctx, CreateExecutor(exec_ctx, plan));
+}
+
+bool ExecutorFactory::IsParallelPipeline(const AbstractPlanNode *plan) { return plan->GetType() == PlanType::SeqScan; }
+
+std::unique_ptr<AbstractExecutor> ExecutorFactory::CreatePipelineExecutor(ExecutorContext *exec_ctx,
+                                                                          const AbstractPlanNode *plan,
+                                                                          MorselQueue *morsels) {
+  BUSTUB_ASSERT(IsParallelPipeline(plan), "Plan cannot run as a parallel pipeline.");
+  return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan), morsels);
+}
+
+std::unique_ptr<MorselQueue> ExecutorFactory::CreateMorselQueue(ExecutorContext *exec_ctx,
+                                                                const AbstractPlanNode *plan) {
+  BUSTUB_ASSERT(IsParallelPipeline(plan), "Plan cannot run as a parallel pipeline.");
+  auto scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan);
+  return std::make_unique<MorselQueue>(exec_ctx->GetCatalog()->GetTable(scan_plan->GetTableOid())->table_.get());
+}
 }  // namespace bustub
@@ -0,0 +1,327 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// fixed_width_aggregation_hash_table.cpp
+//
+// Identification: src/execution/fixed_width_aggregation_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/fixed_width_aggregation_hash_table.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/expressions/abstract_expression.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+bool IsInteger(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+}
+
+/** Combines a 64-bit word into a hash. */
+uint64_t HashWord(uint64_t hash, int64_t word) {
+  hash ^= static_cast<uint64_t>(word) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash * 0xff51afd7ed558ccdULL;
+}
+
+/** The per-row update of one accumulator, specialized for every AggregationType. */
+template <AggregationType agg_type>
+struct AggregateKernel;
+
+template <>
+struct AggregateKernel<AggregationType::CountAggregate> {
+  /** Counts rows, whatever their input. */
+  static constexpr bool NULL_IS_STICKY = false;
+  static void Update(int64_t *acc, int64_t input, int64_t min_result, int64_t max_result) { ++*acc; }
+};
+
+template <>
+struct AggregateKernel<AggregationType::SumAggregate> {
+  static constexpr bool NULL_IS_STICKY = true;
+  static void Update(int64_t *acc, int64_t input, int64_t min_result, int64_t max_result) {
+    int64_t sum;
+    if (__builtin_add_overflow(*acc, input, &sum) || sum < min_result || sum > max_result) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+    }
+    *acc = sum;
+  }
+};
+
+template <>
+struct AggregateKernel<AggregationType::MinAggregate> {
+  static constexpr bool NULL_IS_STICKY = true;
+  static void Update(int64_t *acc, int64_t input, int64_t min_result, int64_t max_result) {
+    *acc = std::min(*acc, input);
+  }
+};
+
+template <>
+struct AggregateKernel<AggregationType::MaxAggregate> {
+  static constexpr bool NULL_IS_STICKY = true;
+  static void Update(int64_t *acc, int64_t input, int64_t min_result, int64_t max_result) {
+    *acc = std::max(*acc, input);
+  }
+};
+
+}  // namespace
+
+bool FixedWidthAggregationHashTable::Supports(const AggregationPlanNode *plan) {
+  for (const auto &expr : plan->GetGroupBys()) {
+    if (!IsInteger(expr->GetReturnType())) {
+      return false;
+    }
+  }
+  for (const auto &expr : plan->GetAggregates()) {
+    if (!IsInteger(expr->GetReturnType())) {
+      return false;
+    }
+  }
+  return plan->GetAggregates().size() <= 64;
+}
+
+FixedWidthAggregationHashTable::FixedWidthAggregationHashTable(const AggregationPlanNode *plan)
+    : agg_types_(plan->GetAggregateTypes()) {
+  BUSTUB_ASSERT(Supports(plan), "Aggregation is not fixed-width.");
+  for (const auto &expr : plan->GetGroupBys()) {
+    key_types_.push_back(expr->GetReturnType());
+  }
+  for (size_t i = 0; i < agg_types_.size(); ++i) {
+    TypeId input_type = plan->GetAggregateAt(i)->GetReturnType();
+    input_types_.push_back(input_type);
+    switch (agg_types_[i]) {
+      case AggregationType::CountAggregate:
+        result_types_.push_back(TypeId::INTEGER);
+        break;
+      case AggregationType::SumAggregate:
+        // Sums start from an INTEGER zero, so they widen to BIGINT only for BIGINT inputs.
+        result_types_.push_back(input_type == TypeId::BIGINT ? TypeId::BIGINT : TypeId::INTEGER);
+        break;
+      case AggregationType::MinAggregate:
+      case AggregationType::MaxAggregate:
+        result_types_.push_back(input_type);
+        break;
+    }
+  }
+  stride_ = key_types_.size() + agg_types_.size() + 1;
+  key_words_.resize(key_types_.size());
+  Clear();
+}
+
+void FixedWidthAggregationHashTable::Clear() {
+  groups_.clear();
+  group_hashes_.clear();
+  num_groups_ = 0;
+  directory_.assign(INITIAL_DIRECTORY_SIZE, EMPTY_SLOT);
+}
+
+template <typename CppType>
+void FixedWidthAggregationHashTable::UnboxColumn(const std::vector<Value> &values,
+                                                 const std::vector<uint32_t> &selection, std::vector<int64_t> *words,
+                                                 std::vector<uint8_t> *nulls) {
+  for (uint32_t row_idx : selection) {
+    const Value &value = values[row_idx];
+    (*words)[row_idx] = static_cast<int64_t>(value.GetAs<CppType>());
+    (*nulls)[row_idx] |= value.IsNull() ? 1 : 0;
+  }
+}
+
+void FixedWidthAggregationHashTable::Unbox(TypeId type, const std::vector<Value> &values,
+                                           const std::vector<uint32_t> &selection, std::vector<int64_t> *words,
+                                           std::vector<uint8_t> *nulls) {
+  switch (type) {
+    case TypeId::TINYINT:
+      UnboxColumn<int8_t>(values, selection, words, nulls);
+      break;
+    case TypeId::SMALLINT:
+      UnboxColumn<int16_t>(values, selection, words, nulls);
+      break;
+    case TypeId::INTEGER:
+      UnboxColumn<int32_t>(values, selection, words, nulls);
+      break;
+    case TypeId::BIGINT:
+      UnboxColumn<int64_t>(values, selection, words, nulls);
+      break;
+    default:
+      UNREACHABLE("Not a fixed-width integer.");
+  }
+}
+
+Value FixedWidthAggregationHashTable::Box(TypeId type, int64_t word) {
+  switch (type) {
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(word));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(word));
+    case TypeId::INTEGER:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(word));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(word);
+    default:
+      UNREACHABLE("Not a fixed-width integer.");
+  }
+}
+
+void FixedWidthAggregationHashTable::Aggregate(const std::vector<const std::vector<Value> *> &group_bys,
+                                               const std::vector<const std::vector<Value> *> &aggregates,
+                                               const std::vector<uint32_t> &selection,
+                                               std::vector<uint32_t> *null_key_rows) {
+  null_key_rows->clear();
+  if (selection.empty()) {
+    return;
+  }
+  size_t num_rows = *std::max_element(selection.begin(), selection.end()) + 1;
+
+  // Unbox the keys, and find the group of every row with a non-null key.
+  key_nulls_.assign(num_rows, 0);
+  for (size_t i = 0; i < key_types_.size(); ++i) {
+    key_words_[i].resize(num_rows);
+    Unbox(key_types_[i], *group_bys[i], selection, &key_words_[i], &key_nulls_);
+  }
+  row_groups_.resize(num_rows);
+  keyed_rows_.clear();
+  std::vector<int64_t> key(key_types_.size());
+  for (uint32_t row_idx : selection) {
+    if (key_nulls_[row_idx] != 0) {
+      null_key_rows->push_back(row_idx);
+      continue;
+    }
+    uint64_t hash = 0;
+    for (size_t i = 0; i < key.size(); ++i) {
+      key[i] = key_words_[i][row_idx];
+      hash = HashWord(hash, key[i]);
+    }
+    row_groups_[row_idx] = FindOrInsertGroup(key.data(), hash);
+    keyed_rows_.push_back(row_idx);
+  }
+
+  // Update one aggregate at a time, with the kernel of its type.
+  input_words_.resize(num_rows);
+  for (size_t i = 0; i < agg_types_.size(); ++i) {
+    input_nulls_.assign(num_rows, 0);
+    Unbox(input_types_[i], *aggregates[i], keyed_rows_, &input_words_, &input_nulls_);
+    switch (agg_types_[i]) {
+      case AggregationType::CountAggregate:
+        UpdateAccumulators<AggregationType::CountAggregate>(i, keyed_rows_, input_words_, input_nulls_);
+        break;
+      case AggregationType::SumAggregate:
+        UpdateAccumulators<AggregationType::SumAggregate>(i, keyed_rows_, input_words_, input_nulls_);
+        break;
+      case AggregationType::MinAggregate:
+        UpdateAccumulators<AggregationType::MinAggregate>(i, keyed_rows_, input_words_, input_nulls_);
+        break;
+      case AggregationType::MaxAggregate:
+        UpdateAccumulators<AggregationType::MaxAggregate>(i, keyed_rows_, input_words_, input_nulls_);
+        break;
+    }
+  }
+}
+
+template <AggregationType agg_type>
+void FixedWidthAggregationHashTable::UpdateAccumulators(size_t agg_idx, const std::vector<uint32_t> &rows,
+                                                        const std::vector<int64_t> &inputs,
+                                                        const std::vector<uint8_t> &nulls) {
+  using Kernel = AggregateKernel<agg_type>;
+  int64_t min_result = result_types_[agg_idx] == TypeId::BIGINT ? INT64_MIN : INT32_MIN;
+  int64_t max_result = result_types_[agg_idx] == TypeId::BIGINT ? INT64_MAX : INT32_MAX;
+  size_t acc_offset = key_types_.size() + agg_idx;
+  size_t null_offset = stride_ - 1;
+  uint64_t null_bit = uint64_t{1} << agg_idx;
+  for (uint32_t row_idx : rows) {
+    int64_t *group = GroupAt(row_groups_[row_idx]);
+    if (Kernel::NULL_IS_STICKY) {
+      if ((static_cast<uint64_t>(group[null_offset]) & null_bit) != 0) {
+        continue;
+      }
+      if (nulls[row_idx] != 0) {
+        group[null_offset] = static_cast<int64_t>(static_cast<uint64_t>(group[null_offset]) | null_bit);
+        continue;
+      }
+    }
+    Kernel::Update(&group[acc_offset], inputs[row_idx], min_result, max_result);
+  }
+}
+
+uint32_t FixedWidthAggregationHashTable::FindOrInsertGroup(const int64_t *key, uint64_t hash) {
+  size_t num_keys = key_types_.size();
+  for (size_t slot = SlotOf(hash);; slot = (slot + 1) & (directory_.size() - 1)) {
+    uint32_t group_idx = directory_[slot];
+    if (group_idx == EMPTY_SLOT) {
+      break;
+    }
+    if (group_hashes_[group_idx] == hash && std::equal(key, key + num_keys, GroupAt(group_idx))) {
+      return group_idx;
+    }
+  }
+
+  // A new group, with the initial values of SimpleAggregationHashTable::GenerateInitialAggregateValue().
+  auto group_idx = static_cast<uint32_t>(num_groups_++);
+  groups_.resize(num_groups_ * stride_);
+  group_hashes_.push_back(hash);
+  int64_t *group = GroupAt(group_idx);
+  std::copy(key, key + num_keys, group);
+  for (size_t i = 0; i < agg_types_.size(); ++i) {
+    switch (agg_types_[i]) {
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+        group[num_keys + i] = 0;
+        break;
+      case AggregationType::MinAggregate:
+        group[num_keys + i] = BUSTUB_INT32_MAX;
+        break;
+      case AggregationType::MaxAggregate:
+        group[num_keys + i] = BUSTUB_INT32_MIN;
+        break;
+    }
+  }
+  group[stride_ - 1] = 0;
+
+  if (num_groups_ * MAX_LOAD_FACTOR_INVERSE > directory_.size()) {
+    Grow();
+  } else {
+    size_t slot = SlotOf(hash);
+    while (directory_[slot] != EMPTY_SLOT) {
+      slot = (slot + 1) & (directory_.size() - 1);
+    }
+    directory_[slot] = group_idx;
+  }
+  return group_idx;
+}
+
+void FixedWidthAggregationHashTable::Grow() {
+  directory_.assign(directory_.size() * 2, EMPTY_SLOT);
+  for (size_t group_idx = 0; group_idx < num_groups_; ++group_idx) {
+    size_t slot = SlotOf(group_hashes_[group_idx]);
+    while (directory_[slot] != EMPTY_SLOT) {
+      slot = (slot + 1) & (directory_.size() - 1);
+    }
+    directory_[slot] = static_cast<uint32_t>(group_idx);
+  }
+}
+
+void FixedWidthAggregationHashTable::BoxGroup(size_t group_idx, AggregateKey *key, AggregateValue *value) const {
+  const int64_t *group = GroupAt(group_idx);
+  auto null_flags = static_cast<uint64_t>(group[stride_ - 1]);
+  key->group_bys_.clear();
+  for (size_t i = 0; i < key_types_.size(); ++i) {
+    key->group_bys_.push_back(Box(key_types_[i], group[i]));
+  }
+  value->aggregates_.clear();
+  for (size_t i = 0; i < agg_types_.size(); ++i) {
+    if ((null_flags & (uint64_t{1} << i)) != 0) {
+      value->aggregates_.push_back(ValueFactory::GetNullValueByType(result_types_[i]));
+    } else {
+      value->aggregates_.push_back(Box(result_types_[i], group[key_types_.size() + i]));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -9,9 +9,14 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "execution/executor_factory.h"
 #include "execution/executors/hash_join_executor.h"
 
 namespace bustub {
@@ -29,40 +34,526 @@ HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlan
 //    const HT *GetJHT() const { return &jht_; }
 
 void HashJoinExecutor::Init() {
-    Tuple tuple;
-    left_->Init();
-    // Phase 1: Build.
-    while(left_->Next(&tuple)){
-        hash_t hash_key = HashValues(&tuple, left_->GetOutputSchema(), plan_->GetLeftKeys());
-        jht_.Insert(exec_ctx_->GetTransaction(), hash_key, tuple);
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->Predicate(), left_->GetOutputSchema(),
+                                                     right_->GetOutputSchema());
+    auto worker_pool = exec_ctx_->GetWorkerPool();
+    left_parts_.clear();
+    right_parts_.clear();
+    next_partition_ = 0;
+    partition_probes_.clear();
+    results_.clear();
+    result_idx_ = 0;
+    out_batch_.Reset(plan_->OutputSchema()->GetColumnCount());
+    result_pos_ = 0;
+    jht_.Clear();
+    spilled_ = false;
+    spill_partitions_.clear();
+    probe_heap_.reset();
+    probe_page_idx_ = 0;
+    right_->PushRuntimeFilter(nullptr);
+    runtime_filter_.reset();
+    push_mode_ = false;
+    partitioned_ = worker_pool != nullptr && PartitionedJoin(worker_pool);
+    if(partitioned_){
+        return;
     }
 
+    // Phase 1: Build, spilling both sides if the build side does not fit in memory.
+    left_->Init();
     right_->Init();
+    spilled_ = !BuildFrom(left_.get(), &jht_, exec_ctx_->GetMemoryBudget());
+    if(spilled_){
+        SpillInputs();
+    }
+    StartProbing();
 }
 
-bool HashJoinExecutor::Next(Tuple *tuple) {
-    Tuple tuple_;
+void HashJoinExecutor::InitPush() {
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->Predicate(), left_->GetOutputSchema(),
+                                                     right_->GetOutputSchema());
+    out_batch_.Reset(plan_->OutputSchema()->GetColumnCount());
+    jht_.Clear();
+    build_bytes_ = 0;
+    spilled_ = false;
+    spill_partitions_.clear();
+    probe_heap_.reset();
+    probe_page_idx_ = 0;
+    right_->PushRuntimeFilter(nullptr);
+    runtime_filter_.reset();
+    push_mode_ = true;
+    partitioned_ = false;
+}
+
+void HashJoinExecutor::Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {
+    if(input_idx == 0){
+        if(spilled_){
+            SpillBatch(*batch, plan_->GetLeftKeys(), left_->GetOutputSchema(), 0, &spill_left_);
+            return;
+        }
+        build_bytes_ += InsertBatch(*batch, left_->GetOutputSchema(), &jht_);
+        if(build_bytes_ > exec_ctx_->GetMemoryBudget()){
+            StartSpilling();
+        }
+        return;
+    }
+
+    if(spilled_){
+        SpillBatch(*batch, plan_->GetRightKeys(), right_->GetOutputSchema(), 0, &spill_right_);
+        return;
+    }
+    // NextBatch() probes this batch only, since NextProbeBatch() pulls nothing in push mode.
+    right_batch_ = std::move(*batch);
+    HashBatch(right_batch_, plan_->GetRightKeys(), &right_hashes_);
+    right_pos_ = 0;
+    while(NextBatch(&out_batch_)){
+        consumer->Consume(&out_batch_);
+    }
+}
+
+void HashJoinExecutor::FinishPush(uint32_t input_idx, BatchConsumer *consumer) {
+    if(input_idx == 0){
+        StartProbing();
+        return;
+    }
+    if(spilled_){
+        // Join the spilled partitions one at a time.
+        FinishSpilling();
+        while(NextBatch(&out_batch_)){
+            consumer->Consume(&out_batch_);
+        }
+    }
+}
+
+void HashJoinExecutor::StartProbing() {
+    if(!spilled_){
+        runtime_filter_ = std::make_unique<RuntimeFilter>(jht_.Size(), plan_->GetRightKeys());
+        jht_.ForEach([this](hash_t hash, const Tuple &tuple){ runtime_filter_->Insert(hash); });
+        right_->PushRuntimeFilter(runtime_filter_.get());
+    }
+    right_batch_.Reset(right_->GetOutputSchema()->GetColumnCount());
+    right_pos_ = 0;
+    match_it_ = jht_.EndMatches();
+    match_end_ = jht_.EndMatches();
+}
+
+bool HashJoinExecutor::BuildFrom(AbstractExecutor *child, HT *jht, size_t memory_budget) {
+    // Hash a batch of tuples at a time.
+    auto schema = child->GetOutputSchema();
+    TupleBatch batch;
+    size_t memory_used = 0;
+    while(child->NextBatch(&batch)){
+        memory_used += InsertBatch(batch, schema, jht);
+        if(memory_used > memory_budget){
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t HashJoinExecutor::InsertBatch(const TupleBatch &batch, const Schema *schema, HT *jht) {
+    std::vector<hash_t> hashes;
+    HashBatch(batch, plan_->GetLeftKeys(), &hashes);
+    size_t memory_used = 0;
+    for(uint32_t row_idx : batch.GetSelection()){
+        Tuple tuple = batch.GetTuple(row_idx, schema);
+        memory_used += HT::Footprint(tuple.GetLength());
+        jht->Insert(exec_ctx_->GetTransaction(), hashes[row_idx], tuple);
+    }
+    return memory_used;
+}
+
+std::vector<std::unique_ptr<TmpTupleHeap>> HashJoinExecutor::CreateSpillHeaps() {
+    std::vector<std::unique_ptr<TmpTupleHeap>> heaps;
+    for(size_t i = 0; i < SPILL_FANOUT; ++i){
+        heaps.push_back(std::make_unique<TmpTupleHeap>(exec_ctx_->GetBufferPoolManager()));
+    }
+    return heaps;
+}
+
+void HashJoinExecutor::SpillInputs() {
+    StartSpilling();
+    TupleBatch batch;
+    while(left_->NextBatch(&batch)){
+        SpillBatch(batch, plan_->GetLeftKeys(), left_->GetOutputSchema(), 0, &spill_left_);
+    }
+    while(right_->NextBatch(&batch)){
+        SpillBatch(batch, plan_->GetRightKeys(), right_->GetOutputSchema(), 0, &spill_right_);
+    }
+    FinishSpilling();
+}
+
+void HashJoinExecutor::StartSpilling() {
+    spilled_ = true;
+    spill_left_ = CreateSpillHeaps();
+    spill_right_ = CreateSpillHeaps();
+    jht_.ForEach([&](hash_t hash, const Tuple &tuple){
+        spill_left_[SpillPartitionOf(hash, 0)]->Append(tuple);
+    });
+    jht_.Clear();
+}
+
+void HashJoinExecutor::FinishSpilling() {
+    for(size_t i = 0; i < SPILL_FANOUT; ++i){
+        spill_partitions_.push_back(SpillPartition{std::move(spill_left_[i]), std::move(spill_right_[i]), 0});
+    }
+    spill_left_.clear();
+    spill_right_.clear();
+}
+
+void HashJoinExecutor::SpillBatch(const TupleBatch &batch, const std::vector<const AbstractExpression *> &keys,
+                                  const Schema *schema, size_t level,
+                                  std::vector<std::unique_ptr<TmpTupleHeap>> *heaps) {
+    std::vector<hash_t> hashes;
+    HashBatch(batch, keys, &hashes);
+    for(uint32_t row_idx : batch.GetSelection()){
+        (*heaps)[SpillPartitionOf(hashes[row_idx], level)]->Append(batch.GetTuple(row_idx, schema));
+    }
+}
+
+bool HashJoinExecutor::ReadSpilledPage(TmpTupleHeap *heap, size_t page_idx, const Schema *schema,
+                                       TupleBatch *batch) {
+    if(page_idx >= heap->NumPages()){
+        return false;
+    }
+    std::vector<Tuple> tuples;
+    heap->GetPageTuples(page_idx, &tuples);
+    batch->Reset(schema->GetColumnCount());
+    for(const auto &tuple : tuples){
+        batch->AppendTuple(tuple, schema);
+    }
+    return true;
+}
+
+bool HashJoinExecutor::LoadNextPartition() {
     auto left_schema = left_->GetOutputSchema();
     auto right_schema = right_->GetOutputSchema();
-    while(right_->Next(&tuple_)){
-        std::vector<Tuple> tuples;
-        //Phase 2: Probe.
-        hash_t  hash_key = HashValues(&tuple_, right_schema, plan_->GetRightKeys());
-        jht_.GetValue(exec_ctx_->GetTransaction(), hash_key, &tuples);
-
-        for(auto tup : tuples){
-            if(plan_->Predicate()->EvaluateJoin(&tup, left_schema, &tuple_, right_schema).GetAs<bool>()){
-                std::vector<Value> output_values;
-                size_t num_cols = plan_->OutputSchema()->GetColumnCount();
-                for(size_t i = 0; i < num_cols; ++i){
-                    output_values.push_back(plan_->OutputSchema()->GetColumn(i)
-                    .GetExpr()->EvaluateJoin(&tup, left_schema, &tuple_, right_schema));
-                }
-                *tuple = Tuple(output_values, plan_->OutputSchema());
-                return true;
+    TupleBatch batch;
+    while(!spill_partitions_.empty()){
+        SpillPartition partition = std::move(spill_partitions_.back());
+        spill_partitions_.pop_back();
+        if(partition.left_->NumTuples() == 0 || partition.right_->NumTuples() == 0){
+            continue;
+        }
+
+        size_t build_size = partition.left_->NumBytes() + partition.left_->NumTuples() * HT::Footprint(0);
+        if(build_size > exec_ctx_->GetMemoryBudget() && partition.level_ + 1 < MAX_SPILL_LEVEL){
+            // Still too large: split it on the next bits of the hashes.
+            size_t level = partition.level_ + 1;
+            auto left_heaps = CreateSpillHeaps();
+            auto right_heaps = CreateSpillHeaps();
+            for(size_t page_idx = 0; ReadSpilledPage(partition.left_.get(), page_idx, left_schema, &batch); ++page_idx){
+                SpillBatch(batch, plan_->GetLeftKeys(), left_schema, level, &left_heaps);
+            }
+            for(size_t page_idx = 0; ReadSpilledPage(partition.right_.get(), page_idx, right_schema, &batch);
+                ++page_idx){
+                SpillBatch(batch, plan_->GetRightKeys(), right_schema, level, &right_heaps);
+            }
+            for(size_t i = 0; i < SPILL_FANOUT; ++i){
+                spill_partitions_.push_back(SpillPartition{std::move(left_heaps[i]), std::move(right_heaps[i]), level});
             }
+            continue;
         }
+
+        jht_.Clear();
+        for(size_t page_idx = 0; ReadSpilledPage(partition.left_.get(), page_idx, left_schema, &batch); ++page_idx){
+            InsertBatch(batch, left_schema, &jht_);
+        }
+        probe_heap_ = std::move(partition.right_);
+        probe_page_idx_ = 0;
+        return true;
     }
+    jht_.Clear();
+    probe_heap_.reset();
     return false;
 }
+
+bool HashJoinExecutor::NextProbeBatch() {
+    if(!spilled_){
+        return !push_mode_ && right_->NextBatch(&right_batch_);
+    }
+    while(probe_heap_ == nullptr ||
+          !ReadSpilledPage(probe_heap_.get(), probe_page_idx_, right_->GetOutputSchema(), &right_batch_)){
+        if(!LoadNextPartition()){
+            return false;
+        }
+    }
+    probe_page_idx_++;
+    return true;
+}
+
+bool HashJoinExecutor::PartitionedJoin(WorkerPool *worker_pool) {
+    // Size the partitions from the build side, with at least one partition per worker.
+    size_t build_size = 0;
+    if(ExecutorFactory::IsParallelPipeline(plan_->GetLeftPlan())){
+        build_size = ExecutorFactory::CreateMorselQueue(exec_ctx_, plan_->GetLeftPlan())->NumPages() * PAGE_SIZE;
+    }
+    if(build_size > exec_ctx_->GetMemoryBudget()){
+        // The table under the build side alone is larger than the budget, so the join is likely to spill.
+        return false;
+    }
+    size_t min_partitions = std::max(worker_pool->NumWorkers(), build_size / PARTITION_CACHE_SIZE);
+    num_partitions_ = 1;
+    while(num_partitions_ < min_partitions && num_partitions_ < MAX_PARTITIONS){
+        num_partitions_ <<= 1;
+    }
+
+    // Phase 1: Partition both sides.
+    std::atomic<size_t> memory_used{0};
+    if(!PartitionSide(worker_pool, plan_->GetLeftPlan(), left_.get(), plan_->GetLeftKeys(), nullptr, &memory_used,
+                      &left_parts_)){
+        left_parts_.clear();
+        return false;
+    }
+
+    // A single filter over the build keys is shared by the workers of the right side. It is filled here, since the
+    // filter is not thread-safe, and inserting a hash is much cheaper than computing it.
+    size_t num_build_tuples = 0;
+    for(const auto &worker_parts : left_parts_){
+        for(const auto &part : worker_parts){
+            num_build_tuples += part.size();
+        }
+    }
+    runtime_filter_ = std::make_unique<RuntimeFilter>(num_build_tuples, plan_->GetRightKeys());
+    for(const auto &worker_parts : left_parts_){
+        for(const auto &part : worker_parts){
+            for(const auto &entry : part){
+                runtime_filter_->Insert(entry.first);
+            }
+        }
+    }
+    if(!PartitionSide(worker_pool, plan_->GetRightPlan(), right_.get(), plan_->GetRightKeys(), runtime_filter_.get(),
+                      &memory_used, &right_parts_)){
+        left_parts_.clear();
+        right_parts_.clear();
+        right_->PushRuntimeFilter(nullptr);
+        runtime_filter_.reset();
+        return false;
+    }
+    next_partition_ = 0;
+    return true;
+}
+
+bool HashJoinExecutor::JoinNextPartitions(WorkerPool *worker_pool) {
+    if(partition_probes_.empty()){
+        for(size_t i = 0; i < worker_pool->NumWorkers(); ++i){
+            partition_probes_.push_back(std::make_unique<PartitionProbe>(this));
+        }
+    }
+    bool probing = std::any_of(partition_probes_.begin(), partition_probes_.end(),
+                               [this](const auto &probe){ return probe->part_ < num_partitions_; });
+    if(!probing && next_partition_ >= num_partitions_){
+        return false;
+    }
+
+    // Phase 2: Build and probe one partition at a time.
+    auto left_schema = left_->GetOutputSchema();
+    auto right_schema = right_->GetOutputSchema();
+    std::atomic<size_t> next_partition{next_partition_};
+    std::vector<std::vector<TupleBatch>> local_results(worker_pool->NumWorkers());
+    worker_pool->RunOnAll([&](size_t worker_id){
+        PartitionProbe *probe = partition_probes_[worker_id].get();
+        TupleBatch left_pairs;
+        TupleBatch right_pairs;
+        TupleBatch batch;
+
+        // Every worker returns at most one batch per call, so that the output buffered until the next call stays
+        // within a batch per worker, however many pairs a partition produces.
+        while(local_results[worker_id].empty()){
+            if(probe->part_ >= num_partitions_){
+                size_t part = next_partition++;
+                if(part >= num_partitions_){
+                    break;
+                }
+                probe->jht_.Clear();
+                for(auto &worker_parts : left_parts_){
+                    for(auto &entry : worker_parts[part]){
+                        probe->jht_.Insert(exec_ctx_->GetTransaction(), entry.first, entry.second);
+                    }
+                    std::vector<HashedTuple>().swap(worker_parts[part]);
+                }
+                probe->part_ = part;
+                probe->worker_idx_ = 0;
+                probe->entry_idx_ = 0;
+                probe->match_it_ = probe->jht_.EndMatches();
+                probe->match_end_ = probe->jht_.EndMatches();
+            }
+
+            left_pairs.Reset(left_schema->GetColumnCount());
+            right_pairs.Reset(right_schema->GetColumnCount());
+            bool done = ProbePartition(probe, &left_pairs, &right_pairs);
+            if(left_pairs.NumRows() > 0 && JoinPairs(&left_pairs, right_pairs, &batch)){
+                local_results[worker_id].push_back(std::move(batch));
+            }
+            if(done){
+                // The tuples of a partition are freed once it is joined.
+                for(auto &worker_parts : right_parts_){
+                    std::vector<HashedTuple>().swap(worker_parts[probe->part_]);
+                }
+                probe->jht_.Clear();
+                probe->part_ = num_partitions_;
+            }
+        }
+    });
+    next_partition_ = std::min(next_partition.load(), num_partitions_);
+
+    results_.clear();
+    result_idx_ = 0;
+    for(auto &worker_results : local_results){
+        std::move(worker_results.begin(), worker_results.end(), std::back_inserter(results_));
+    }
+    return true;
+}
+
+bool HashJoinExecutor::ProbePartition(PartitionProbe *probe, TupleBatch *left_pairs, TupleBatch *right_pairs) {
+    auto left_schema = left_->GetOutputSchema();
+    auto right_schema = right_->GetOutputSchema();
+    while(true){
+        for(; probe->match_it_ != probe->match_end_; ++probe->match_it_){
+            if(left_pairs->IsFull()){
+                return false;
+            }
+            left_pairs->AppendTuple(*probe->match_it_, left_schema);
+            right_pairs->AppendTuple(probe->entry_->second, right_schema);
+        }
+        // Move on to the next right tuple of the partition, across the partitions of the workers of the right side.
+        while(probe->worker_idx_ < right_parts_.size() &&
+              probe->entry_idx_ >= right_parts_[probe->worker_idx_][probe->part_].size()){
+            probe->worker_idx_++;
+            probe->entry_idx_ = 0;
+        }
+        if(probe->worker_idx_ == right_parts_.size()){
+            return true;
+        }
+        probe->entry_ = &right_parts_[probe->worker_idx_][probe->part_][probe->entry_idx_++];
+        probe->match_it_ = probe->jht_.BeginMatches(probe->entry_->first);
+        probe->match_end_ = probe->jht_.EndMatches();
+    }
+}
+
+bool HashJoinExecutor::PartitionSide(WorkerPool *worker_pool, const AbstractPlanNode *plan, AbstractExecutor *child,
+                                     const std::vector<const AbstractExpression *> &keys, const RuntimeFilter *filter,
+                                     std::atomic<size_t> *memory_used, PartitionedTuples *partitions) {
+    partitions->assign(worker_pool->NumWorkers(), std::vector<std::vector<HashedTuple>>(num_partitions_));
+    if(!ExecutorFactory::IsParallelPipeline(plan)){
+        child->Init();
+        child->PushRuntimeFilter(filter);
+        return PartitionFrom(child, keys, memory_used, &(*partitions)[0]);
+    }
+    auto morsels = ExecutorFactory::CreateMorselQueue(exec_ctx_, plan);
+    std::atomic<bool> fits{true};
+    worker_pool->RunOnAll([&](size_t worker_id){
+        auto pipeline = ExecutorFactory::CreatePipelineExecutor(exec_ctx_, plan, morsels.get());
+        pipeline->Init();
+        pipeline->PushRuntimeFilter(filter);
+        if(!PartitionFrom(pipeline.get(), keys, memory_used, &(*partitions)[worker_id])){
+            fits = false;
+        }
+    });
+    return fits;
+}
+
+bool HashJoinExecutor::PartitionFrom(AbstractExecutor *child, const std::vector<const AbstractExpression *> &keys,
+                                     std::atomic<size_t> *memory_used,
+                                     std::vector<std::vector<HashedTuple>> *partitions) {
+    auto schema = child->GetOutputSchema();
+    TupleBatch batch;
+    std::vector<hash_t> hashes;
+    while(child->NextBatch(&batch)){
+        HashBatch(batch, keys, &hashes);
+        size_t batch_bytes = 0;
+        for(uint32_t row_idx : batch.GetSelection()){
+            auto &part = (*partitions)[PartitionOf(hashes[row_idx])];
+            part.emplace_back(hashes[row_idx], batch.GetTuple(row_idx, schema));
+            batch_bytes += sizeof(HashedTuple) + part.back().second.GetLength();
+        }
+        // Every worker sees the bytes of the others, so all of them stop soon after the budget is exceeded.
+        if((*memory_used += batch_bytes) > exec_ctx_->GetMemoryBudget()){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HashJoinExecutor::JoinPairs(TupleBatch *left_pairs, const TupleBatch &right_pairs, TupleBatch *batch) {
+    auto output_schema = plan_->OutputSchema();
+    std::vector<Value> values;
+    if(compiled_predicate_ != nullptr){
+        compiled_predicate_->Filter(left_pairs, right_pairs);
+    } else {
+        left_pairs->Filter(plan_->Predicate()->EvaluateJoinBatchView(*left_pairs, right_pairs, &values));
+    }
+    if(left_pairs->IsEmpty()){
+        return false;
+    }
+
+    batch->Reset(output_schema->GetColumnCount());
+    for(uint32_t i = 0; i < output_schema->GetColumnCount(); ++i){
+        const auto &column_values =
+            output_schema->GetColumn(i).GetExpr()->EvaluateJoinBatchView(*left_pairs, right_pairs, &values);
+        auto column = batch->GetMutableColumn(i);
+        for(uint32_t row_idx : left_pairs->GetSelection()){
+            column->push_back(column_values[row_idx]);
+        }
+    }
+    batch->SetNumRows(left_pairs->NumSelected());
+    return true;
+}
+
+bool HashJoinExecutor::Next(Tuple *tuple) {
+    while(result_pos_ >= out_batch_.NumSelected()){
+        if(!NextBatch(&out_batch_)){
+            return false;
+        }
+        result_pos_ = 0;
+    }
+    *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[result_pos_++], plan_->OutputSchema());
+    return true;
+}
+
+bool HashJoinExecutor::NextBatch(TupleBatch *batch) {
+    if(partitioned_){
+        while(result_idx_ >= results_.size()){
+            if(!JoinNextPartitions(exec_ctx_->GetWorkerPool())){
+                return false;
+            }
+        }
+        *batch = std::move(results_[result_idx_++]);
+        return true;
+    }
+
+    auto left_schema = left_->GetOutputSchema();
+    auto right_schema = right_->GetOutputSchema();
+
+    while(true){
+        // Phase 2: Probe, gathering candidate pairs until the pair batches are full or the right side runs out.
+        left_pairs_.Reset(left_schema->GetColumnCount());
+        right_pairs_.Reset(right_schema->GetColumnCount());
+        while(!left_pairs_.IsFull()){
+            if(match_it_ != match_end_){
+                left_pairs_.AppendTuple(*match_it_, left_schema);
+                ++match_it_;
+                right_pairs_.AppendRowFrom(right_batch_, right_batch_.GetSelection()[right_pos_ - 1]);
+                continue;
+            }
+            if(right_pos_ < right_batch_.NumSelected()){
+                uint32_t row_idx = right_batch_.GetSelection()[right_pos_++];
+                match_it_ = jht_.BeginMatches(right_hashes_[row_idx]);
+                match_end_ = jht_.EndMatches();
+                continue;
+            }
+            if(!NextProbeBatch()){
+                break;
+            }
+            HashBatch(right_batch_, plan_->GetRightKeys(), &right_hashes_);
+            right_pos_ = 0;
+        }
+        if(left_pairs_.NumRows() == 0){
+            return false;
+        }
+
+        if(JoinPairs(&left_pairs_, right_pairs_, batch)){
+            return true;
+        }
+    }
+}
 }  // namespace bustub
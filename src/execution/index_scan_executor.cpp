@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_scan_executor.cpp
+//
+// Identification: src/execution/index_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <vector>
+
+#include "execution/executors/index_scan_executor.h"
+
+namespace bustub {
+
+IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+    auto catalog = exec_ctx_->GetCatalog();
+    auto table_info = catalog->GetTable(plan_->GetTableOid());
+    table_heap_ = table_info->table_.get();
+    table_schema_ = &table_info->schema_;
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->GetPredicate(), table_schema_);
+
+    Index *index = catalog->GetIndex(plan_->GetIndexOid())->index_.get();
+    const Schema *key_schema = index->GetKeySchema();
+    std::vector<Value> key_values;
+    for(uint32_t i = 0; i < plan_->GetKey().size(); ++i){
+        key_values.push_back(plan_->GetKey()[i]->Evaluate(nullptr, nullptr).CastAs(key_schema->GetColumn(i).GetType()));
+    }
+    rids_.clear();
+    next_rid_ = 0;
+    index->ScanKey(Tuple(key_values, key_schema), &rids_, exec_ctx_->GetTransaction());
+}
+
+bool IndexScanExecutor::Next(Tuple *tuple) {
+    const Schema *output_schema = plan_->OutputSchema();
+    Tuple table_tuple;
+    std::vector<Value> values;
+    while(next_rid_ < rids_.size()){
+        if(!table_heap_->GetTuple(rids_[next_rid_++], &table_tuple, exec_ctx_->GetTransaction())){
+            continue;
+        }
+        if(compiled_predicate_ != nullptr){
+            if(!compiled_predicate_->Evaluate(table_tuple)){
+                continue;
+            }
+        } else if(plan_->GetPredicate() != nullptr){
+            Value value = plan_->GetPredicate()->Evaluate(&table_tuple, table_schema_);
+            if(value.IsNull() || !value.GetAs<bool>()){
+                continue;
+            }
+        }
+        values.clear();
+        for(uint32_t i = 0; i < output_schema->GetColumnCount(); ++i){
+            values.push_back(output_schema->GetColumn(i).GetExpr()->Evaluate(&table_tuple, table_schema_));
+        }
+        *tuple = Tuple(values, output_schema);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace bustub
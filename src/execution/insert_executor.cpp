@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <memory>
+#include <vector>
 
 #include "execution/executors/insert_executor.h"
 
@@ -22,42 +23,80 @@ InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *
 const Schema *InsertExecutor::GetOutputSchema() { return plan_->OutputSchema(); }
 
 void InsertExecutor::Init() {
-    SimpleCatalog *Catalog = exec_ctx_->GetCatalog();
-    table_MetaData_= Catalog->GetTable(plan_->TableOid());
-
+    OpenTable();
+    pushed_ = false;
     if(!plan_->IsRawInsert()){
         child_executor_->Init();
     }
 }
 
-bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple) {
-    RID rid;
-    bool inserted;
-    Tuple tup_to_Insert;
+void InsertExecutor::InitPush() {
+    OpenTable();
+    pushed_ = true;
+    push_succeeded_ = true;
+}
 
+void InsertExecutor::OpenTable() {
+    SimpleCatalog *Catalog = exec_ctx_->GetCatalog();
+    table_MetaData_= Catalog->GetTable(plan_->TableOid());
+    indexes_ = Catalog->GetTableIndexes(table_MetaData_->name_);
+}
+
+bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple) {
     if(plan_->IsRawInsert()){
-        size_t size_cols = plan_->RawValues().size();
-        for(size_t i = 0; i < size_cols; ++i){
-            tup_to_Insert= Tuple(plan_->RawValuesAt(i), &table_MetaData_->schema_);
-
-            LOG_DEBUG("begin next.");
-            inserted = table_MetaData_->table_->InsertTuple(tup_to_Insert, &rid, exec_ctx_->GetTransaction());
-            if(!inserted) {
-                return false;
-            };
+        tuples_.clear();
+        for(const auto &values : plan_->RawValues()){
+            tuples_.emplace_back(values, &table_MetaData_->schema_);
         }
+        return InsertTuples();
     }
-    // Get tuple from child_executor and insert it into table.
-    else{
-        while(child_executor_->Next(&tup_to_Insert)){
-            inserted = table_MetaData_->table_->InsertTuple(tup_to_Insert, &rid, exec_ctx_->GetTransaction());
-            if(!inserted) {
-                return false;
-
-            }
+    // The pushed rows are already inserted.
+    if(pushed_){
+        return push_succeeded_;
+    }
+    // Get tuples from child_executor batch by batch and insert them into table.
+    while(child_executor_->NextBatch(&child_batch_)){
+        if(!InsertBatch(child_batch_)){
+            return false;
         }
     }
     return true;
 }
 
+void InsertExecutor::Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {
+    if(push_succeeded_){
+        push_succeeded_ = InsertBatch(*batch);
+    }
+}
+
+bool InsertExecutor::InsertBatch(const TupleBatch &batch) {
+    tuples_.clear();
+    for(uint32_t row_idx : batch.GetSelection()){
+        tuples_.push_back(batch.GetTuple(row_idx, &table_MetaData_->schema_));
+    }
+    return InsertTuples();
+}
+
+bool InsertExecutor::InsertTuples() {
+    // The rows go to the end of the table, a page at a time.
+    bool inserted = table_MetaData_->table_->InsertTuples(tuples_, &rids_, exec_ctx_->GetTransaction());
+    for(size_t i = 0; i < rids_.size(); ++i){
+        InsertIndexEntries(tuples_[i], rids_[i]);
+    }
+    return inserted;
+}
+
+void InsertExecutor::InsertIndexEntries(const Tuple &tuple, const RID &rid) {
+    for(auto index_info : indexes_){
+        Index *index = index_info->index_.get();
+        index->InsertEntry(tuple.KeyFromTuple(&table_MetaData_->schema_, index->GetKeySchema(), index->GetKeyAttrs()),
+                           rid, exec_ctx_->GetTransaction());
+    }
+}
+
+bool InsertExecutor::NextBatch(TupleBatch *batch) {
+    batch->Reset(0);
+    return Next(nullptr);
+}
+
 }  // namespace bustub
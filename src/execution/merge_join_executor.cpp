@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/merge_join_executor.h"
+
+namespace bustub {
+
+void MergeJoinExecutor::SortedInput::Init() {
+    child_->Init();
+    pos_ = 0;
+    NextBatch();
+}
+
+void MergeJoinExecutor::SortedInput::NextBatch() {
+    pos_ = 0;
+    while(child_->NextBatch(&batch_)){
+        for(size_t i = 0; i < keys_.size(); ++i){
+            key_columns_[i] = &keys_[i]->EvaluateBatchView(batch_, &key_scratch_[i]);
+        }
+        if(!batch_.IsEmpty()){
+            return;
+        }
+    }
+    batch_.Reset(batch_.NumColumns());
+}
+
+void MergeJoinExecutor::SortedInput::Advance() {
+    if(++pos_ == batch_.NumSelected()){
+        NextBatch();
+    }
+}
+
+bool MergeJoinExecutor::SortedInput::HasNullKey() const {
+    for(size_t i = 0; i < keys_.size(); ++i){
+        if(Key(i).IsNull()){
+            return true;
+        }
+    }
+    return false;
+}
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left,
+                                     std::unique_ptr<AbstractExecutor> &&right)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_(std::move(left)),
+      right_(std::move(right)),
+      left_input_(left_.get(), plan->GetLeftKeys()),
+      right_input_(right_.get(), plan->GetRightKeys()) {}
+
+void MergeJoinExecutor::Init() {
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->Predicate(), left_->GetOutputSchema(),
+                                                     right_->GetOutputSchema());
+    left_input_.Init();
+    right_input_.Init();
+    in_run_ = false;
+    run_pos_ = 0;
+    out_batch_.Reset(plan_->OutputSchema()->GetColumnCount());
+    out_pos_ = 0;
+}
+
+int MergeJoinExecutor::CompareKeys(const SortedInput &left, const SortedInput &right) const {
+    for(size_t i = 0; i < plan_->GetLeftKeys().size(); ++i){
+        if(left.Key(i).CompareLessThan(right.Key(i)) == CmpBool::CmpTrue){
+            return -1;
+        }
+        if(left.Key(i).CompareGreaterThan(right.Key(i)) == CmpBool::CmpTrue){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+bool MergeJoinExecutor::LeftMatchesRun() const {
+    if(!left_input_.Valid()){
+        return false;
+    }
+    for(size_t i = 0; i < run_key_.size(); ++i){
+        if(left_input_.Key(i).CompareEquals(run_key_[i]) != CmpBool::CmpTrue){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MergeJoinExecutor::NextBatch(TupleBatch *batch) {
+    auto output_schema = plan_->OutputSchema();
+    std::vector<Value> values;
+    while(true){
+        left_pairs_.Reset(left_->GetOutputSchema()->GetColumnCount());
+        right_pairs_.Reset(right_->GetOutputSchema()->GetColumnCount());
+        while(!left_pairs_.IsFull()){
+            if(in_run_){
+                // Pair the current left row with every row of the run, then move on to the next left row.
+                if(run_pos_ < run_.size()){
+                    left_pairs_.AppendRowFrom(left_input_.Batch(), left_input_.Row());
+                    right_pairs_.AppendTuple(run_[run_pos_++], right_->GetOutputSchema());
+                    continue;
+                }
+                left_input_.Advance();
+                run_pos_ = 0;
+                in_run_ = LeftMatchesRun();
+                continue;
+            }
+            if(!left_input_.Valid() || !right_input_.Valid()){
+                break;
+            }
+            // Null keys sort first and never join.
+            if(left_input_.HasNullKey()){
+                left_input_.Advance();
+                continue;
+            }
+            if(right_input_.HasNullKey()){
+                right_input_.Advance();
+                continue;
+            }
+            int cmp = CompareKeys(left_input_, right_input_);
+            if(cmp < 0){
+                left_input_.Advance();
+            } else if(cmp > 0){
+                right_input_.Advance();
+            } else {
+                // Buffer the run of right rows with this key, which may span any number of batches.
+                run_.clear();
+                run_key_.clear();
+                for(size_t i = 0; i < plan_->GetRightKeys().size(); ++i){
+                    run_key_.push_back(right_input_.Key(i));
+                }
+                while(right_input_.Valid() && CompareKeys(left_input_, right_input_) == 0){
+                    run_.push_back(right_input_.Batch().GetTuple(right_input_.Row(), right_->GetOutputSchema()));
+                    right_input_.Advance();
+                }
+                in_run_ = true;
+                run_pos_ = 0;
+            }
+        }
+        if(left_pairs_.NumRows() == 0){
+            return false;
+        }
+
+        if(plan_->Predicate() != nullptr){
+            if(compiled_predicate_ != nullptr){
+                compiled_predicate_->Filter(&left_pairs_, right_pairs_);
+            } else {
+                left_pairs_.Filter(plan_->Predicate()->EvaluateJoinBatchView(left_pairs_, right_pairs_, &values));
+            }
+            if(left_pairs_.IsEmpty()){
+                continue;
+            }
+        }
+        batch->Reset(output_schema->GetColumnCount());
+        for(uint32_t i = 0; i < output_schema->GetColumnCount(); ++i){
+            const auto &column_values =
+                output_schema->GetColumn(i).GetExpr()->EvaluateJoinBatchView(left_pairs_, right_pairs_, &values);
+            auto column = batch->GetMutableColumn(i);
+            for(uint32_t row_idx : left_pairs_.GetSelection()){
+                column->push_back(column_values[row_idx]);
+            }
+        }
+        batch->SetNumRows(left_pairs_.NumSelected());
+        return true;
+    }
+}
+
+bool MergeJoinExecutor::Next(Tuple *tuple) {
+    while(out_pos_ >= out_batch_.NumSelected()){
+        if(!NextBatch(&out_batch_)){
+            return false;
+        }
+        out_pos_ = 0;
+    }
+    *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_pos_++], plan_->OutputSchema());
+    return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nested_index_join_executor.cpp
+//
+// Identification: src/execution/nested_index_join_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/nested_index_join_executor.h"
+
+namespace bustub {
+
+NestedIndexJoinExecutor::NestedIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
+                                                 std::unique_ptr<AbstractExecutor> &&outer)
+    : AbstractExecutor(exec_ctx), plan_(plan), outer_(std::move(outer)) {}
+
+void NestedIndexJoinExecutor::Init() {
+    OpenInner();
+    push_mode_ = false;
+    outer_->Init();
+}
+
+void NestedIndexJoinExecutor::InitPush() {
+    OpenInner();
+    push_mode_ = true;
+}
+
+void NestedIndexJoinExecutor::OpenInner() {
+    auto catalog = exec_ctx_->GetCatalog();
+    auto inner_info = catalog->GetTable(plan_->GetInnerTableOid());
+    inner_table_ = inner_info->table_.get();
+    inner_schema_ = &inner_info->schema_;
+    index_ = catalog->GetIndex(plan_->GetIndexOid())->index_.get();
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->Predicate(), outer_->GetOutputSchema(), inner_schema_);
+
+    matches_.clear();
+    match_pos_ = 0;
+    out_batch_.Reset(plan_->OutputSchema()->GetColumnCount());
+    out_pos_ = 0;
+}
+
+void NestedIndexJoinExecutor::Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {
+    outer_batch_ = std::move(*batch);
+    ProbeOuterBatch();
+    // NextBatch() joins this batch only, since ProbeNextOuterBatch() pulls nothing in push mode.
+    while(NextBatch(&out_batch_)){
+        consumer->Consume(&out_batch_);
+    }
+}
+
+bool NestedIndexJoinExecutor::ProbeNextOuterBatch() {
+    if(push_mode_ || !outer_->NextBatch(&outer_batch_)){
+        return false;
+    }
+    ProbeOuterBatch();
+    return true;
+}
+
+void NestedIndexJoinExecutor::ProbeOuterBatch() {
+    const auto &key_exprs = plan_->GetOuterKeys();
+    std::vector<std::vector<Value>> key_scratch(key_exprs.size());
+    std::vector<const std::vector<Value> *> key_columns(key_exprs.size());
+    for(size_t i = 0; i < key_exprs.size(); ++i){
+        key_columns[i] = &key_exprs[i]->EvaluateBatchView(outer_batch_, &key_scratch[i]);
+    }
+
+    // Probe the index for every outer row, with the key cast to the types of the indexed columns.
+    matches_.clear();
+    match_pos_ = 0;
+    const Schema *key_schema = index_->GetKeySchema();
+    std::vector<Value> key_values(key_exprs.size());
+    std::vector<RID> rids;
+    for(uint32_t row_idx : outer_batch_.GetSelection()){
+        for(size_t i = 0; i < key_exprs.size(); ++i){
+            key_values[i] = (*key_columns[i])[row_idx].CastAs(key_schema->GetColumn(i).GetType());
+        }
+        rids.clear();
+        index_->ScanKey(Tuple(key_values, key_schema), &rids, exec_ctx_->GetTransaction());
+        for(const auto &rid : rids){
+            matches_.emplace_back(rid, row_idx);
+        }
+    }
+
+    // Fetch the inner tuples page by page.
+    std::sort(matches_.begin(), matches_.end(), [](const Match &a, const Match &b){
+        return a.first.Get() < b.first.Get();
+    });
+    rids.clear();
+    for(const auto &match : matches_){
+        rids.push_back(match.first);
+    }
+    inner_table_->GetTuples(rids, &inner_tuples_, &found_, exec_ctx_->GetTransaction());
+}
+
+bool NestedIndexJoinExecutor::NextBatch(TupleBatch *batch) {
+    auto output_schema = plan_->OutputSchema();
+    std::vector<Value> values;
+    while(true){
+        outer_pairs_.Reset(outer_->GetOutputSchema()->GetColumnCount());
+        inner_pairs_.Reset(inner_schema_->GetColumnCount());
+        while(!outer_pairs_.IsFull()){
+            if(match_pos_ == matches_.size()){
+                if(!ProbeNextOuterBatch()){
+                    break;
+                }
+                continue;
+            }
+            if(found_[match_pos_]){
+                outer_pairs_.AppendRowFrom(outer_batch_, matches_[match_pos_].second);
+                inner_pairs_.AppendTuple(inner_tuples_[match_pos_], inner_schema_);
+            }
+            match_pos_++;
+        }
+        if(outer_pairs_.NumRows() == 0){
+            return false;
+        }
+
+        if(plan_->Predicate() != nullptr){
+            if(compiled_predicate_ != nullptr){
+                compiled_predicate_->Filter(&outer_pairs_, inner_pairs_);
+            } else {
+                outer_pairs_.Filter(plan_->Predicate()->EvaluateJoinBatchView(outer_pairs_, inner_pairs_, &values));
+            }
+            if(outer_pairs_.IsEmpty()){
+                continue;
+            }
+        }
+        batch->Reset(output_schema->GetColumnCount());
+        for(uint32_t i = 0; i < output_schema->GetColumnCount(); ++i){
+            const auto &column_values =
+                output_schema->GetColumn(i).GetExpr()->EvaluateJoinBatchView(outer_pairs_, inner_pairs_, &values);
+            auto column = batch->GetMutableColumn(i);
+            for(uint32_t row_idx : outer_pairs_.GetSelection()){
+                column->push_back(column_values[row_idx]);
+            }
+        }
+        batch->SetNumRows(outer_pairs_.NumSelected());
+        return true;
+    }
+}
+
+bool NestedIndexJoinExecutor::Next(Tuple *tuple) {
+    while(out_pos_ >= out_batch_.NumSelected()){
+        if(!NextBatch(&out_batch_)){
+            return false;
+        }
+        out_pos_ = 0;
+    }
+    *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_pos_++], plan_->OutputSchema());
+    return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_executor.cpp
+//
+// Identification: src/execution/pipeline_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/pipeline_executor.h"
+
+namespace bustub {
+
+PipelineExecutor::PipelineExecutor(ExecutorContext *exec_ctx, std::unique_ptr<AbstractExecutor> &&root)
+    : AbstractExecutor(exec_ctx), root_(std::move(root)) {}
+
+void PipelineExecutor::Init() {
+    pipelines_.clear();
+    output_.batches_.clear();
+    done_ = false;
+    // An insert has no output schema.
+    out_batch_.Reset(GetOutputSchema() == nullptr ? 0 : GetOutputSchema()->GetColumnCount());
+    out_pos_ = 0;
+
+    auto last = std::make_unique<Pipeline>();
+    Decompose(root_.get(), last.get());
+    pipelines_.push_back(std::move(last));
+    for(auto &pipeline : pipelines_){
+        // The stages were added from the end of the pipeline.
+        auto &stages = pipeline->stages_;
+        std::reverse(stages.begin(), stages.end());
+        for(size_t i = 0; i + 1 < stages.size(); ++i){
+            stages[i]->next_ = stages[i + 1].get();
+        }
+    }
+    if(!pipelines_.back()->stages_.empty()){
+        pipelines_.back()->stages_.back()->next_ = &output_;
+    }
+
+    for(size_t i = 0; i + 1 < pipelines_.size(); ++i){
+        while(PushNextBatch(pipelines_[i].get())){
+        }
+    }
+}
+
+void PipelineExecutor::Decompose(AbstractExecutor *executor, Pipeline *pipeline) {
+    auto inputs = executor->GetPushInputs();
+    if(inputs.empty()){
+        executor->Init();
+        pipeline->source_ = executor;
+        return;
+    }
+
+    executor->InitPush();
+    bool streams = false;
+    for(uint32_t i = 0; i < inputs.size(); ++i){
+        if(executor->IsPipelineBreaker(i)){
+            // The input ends a pipeline of its own, which runs before this one.
+            auto input_pipeline = std::make_unique<Pipeline>();
+            input_pipeline->stages_.push_back(std::make_unique<Stage>(executor, i));
+            Decompose(inputs[i], input_pipeline.get());
+            pipelines_.push_back(std::move(input_pipeline));
+        } else {
+            BUSTUB_ASSERT(!streams, "An executor streams at most one input.");
+            streams = true;
+            pipeline->stages_.push_back(std::make_unique<Stage>(executor, i));
+            Decompose(inputs[i], pipeline);
+        }
+    }
+    if(!streams){
+        // Everything was consumed by the time this executor produces its output.
+        pipeline->source_ = executor;
+    }
+}
+
+bool PipelineExecutor::PushNextBatch(Pipeline *pipeline) {
+    // An insert produces a batch without rows, and nothing more.
+    if(!pipeline->source_->NextBatch(&source_batch_) || source_batch_.IsEmpty()){
+        for(auto &stage : pipeline->stages_){
+            stage->executor_->FinishPush(stage->input_idx_, stage->next_);
+        }
+        return false;
+    }
+    if(pipeline->stages_.empty()){
+        output_.Consume(&source_batch_);
+    } else {
+        pipeline->stages_.front()->Consume(&source_batch_);
+    }
+    return true;
+}
+
+bool PipelineExecutor::NextBatch(TupleBatch *batch) {
+    while(output_.batches_.empty()){
+        if(done_){
+            return false;
+        }
+        done_ = !PushNextBatch(pipelines_.back().get());
+    }
+    *batch = std::move(output_.batches_.front());
+    output_.batches_.pop_front();
+    return true;
+}
+
+bool PipelineExecutor::Next(Tuple *tuple) {
+    while(out_pos_ >= out_batch_.NumSelected()){
+        if(!NextBatch(&out_batch_)){
+            return false;
+        }
+        out_pos_ = 0;
+    }
+    *tuple = out_batch_.GetTuple(out_batch_.GetSelection()[out_pos_++], GetOutputSchema());
+    return true;
+}
+
+}  // namespace bustub
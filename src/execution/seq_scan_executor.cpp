@@ -9,35 +9,214 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <numeric>
+#include <utility>
+#include <vector>
+
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
 
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-: AbstractExecutor(exec_ctx), plan_(plan) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, MorselQueue *morsels)
+: AbstractExecutor(exec_ctx), plan_(plan), morsels_(morsels) {}
 
 void SeqScanExecutor::Init() {
     const auto Catalog = exec_ctx_->GetCatalog();
-    table_heap_ = Catalog->GetTable(plan_->GetTableOid())->table_.get();
-    iterator_ = std::make_unique<TableIterator>(table_heap_->Begin(exec_ctx_->GetTransaction()));
+    auto table_info = Catalog->GetTable(plan_->GetTableOid());
+    table_heap_ = table_info->table_.get();
+    table_schema_ = &table_info->schema_;
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->GetPredicate(), table_schema_);
+    page_id_ = morsels_ == nullptr ? table_heap_->GetFirstPageId() : INVALID_PAGE_ID;
+    slot_num_ = 0;
+    morsel_ = Morsel();
+    page_idx_ = 0;
+    num_batch_filtered_ = 0;
+    num_bytes_read_ = 0;
+
+    std::vector<bool> referenced(table_schema_->GetColumnCount(), false);
+    const auto &out_columns = plan_->OutputSchema()->GetColumns();
+    identity_projection_ = out_columns.size() == table_schema_->GetColumnCount();
+    for(uint32_t i = 0; i < out_columns.size(); ++i){
+        CollectColumns(out_columns[i].GetExpr(), &referenced);
+        auto column = dynamic_cast<const ColumnValueExpression *>(out_columns[i].GetExpr());
+        identity_projection_ = identity_projection_ && column != nullptr && column->GetColIdx() == i &&
+                               out_columns[i].GetType() == table_schema_->GetColumn(i).GetType() &&
+                               out_columns[i].GetLength() == table_schema_->GetColumn(i).GetLength();
+    }
+    scan_columns_.clear();
+    for(uint32_t col_idx = 0; col_idx < referenced.size(); ++col_idx){
+        if(referenced[col_idx]){
+            scan_columns_.push_back(col_idx);
+        }
+    }
 }
 
-bool SeqScanExecutor::Next(Tuple *tuple) {
-    // Get the iterator.
-    auto& iter = *(iterator_);
+void SeqScanExecutor::CollectColumns(const AbstractExpression *expr, std::vector<bool> *referenced) {
+    if(expr == nullptr){
+        return;
+    }
+    auto column = dynamic_cast<const ColumnValueExpression *>(expr);
+    if(column != nullptr && column->GetColIdx() < referenced->size()){
+        (*referenced)[column->GetColIdx()] = true;
+    }
+    for(const auto child : expr->GetChildren()){
+        CollectColumns(child, referenced);
+    }
+}
 
-    while(iter != table_heap_->End()){
-        auto tuple_ = *(iter++);
-        bool eval = true;
-        if(plan_->GetPredicate() != nullptr){
-            eval = plan_->GetPredicate()->Evaluate(&tuple_, plan_->OutputSchema()).GetAs<bool>();
+template<typename Func>
+bool SeqScanExecutor::ScanTuples(Func &&func) {
+    return ScanTuples(std::forward<Func>(func), [](){});
+}
+
+template<typename Func, typename EndFunc>
+bool SeqScanExecutor::ScanTuples(Func &&func, EndFunc &&end_func) {
+    bool stopped = false;
+    auto visit = [&](const Tuple &tuple){
+        stopped = !func(tuple);
+        return !stopped;
+    };
+    while(true){
+        if(page_id_ == INVALID_PAGE_ID){
+            // The table is over, or the current morsel is: claim a new one.
+            if(morsels_ == nullptr){
+                return false;
+            }
+            if(page_idx_ == morsel_.end_){
+                if(!morsels_->Next(&morsel_)){
+                    return false;
+                }
+                page_idx_ = morsel_.begin_;
+            }
+            page_id_ = morsels_->GetPageId(page_idx_++);
+            slot_num_ = 0;
+        }
+        page_id_t next_page_id;
+        if(table_heap_->ScanPage(page_id_, &slot_num_, &next_page_id, exec_ctx_->GetTransaction(), visit, end_func)){
+            page_id_ = morsels_ == nullptr ? next_page_id : INVALID_PAGE_ID;
+            slot_num_ = 0;
         }
-        if(eval){
-            *tuple = Tuple(tuple_);
+        if(stopped){
             return true;
         }
     }
-    return false;
+}
+
+bool SeqScanExecutor::Matches(const Tuple &tuple) const {
+    if(compiled_predicate_ != nullptr){
+        return compiled_predicate_->Evaluate(tuple);
+    }
+    if(plan_->GetPredicate() == nullptr){
+        return true;
+    }
+    Value value = plan_->GetPredicate()->Evaluate(&tuple, table_schema_);
+    return !value.IsNull() && value.GetAs<bool>();
+}
+
+bool SeqScanExecutor::Next(Tuple *tuple) {
+    // Only the tuples that pass the predicate are projected out of the page. The runtime filter refers to the output
+    // schema, so it is checked on the projected tuple.
+    return ScanTuples([&](const Tuple &view){
+        if(!Matches(view)){
+            return true;
+        }
+        Project(view, tuple);
+        return runtime_filter_ != nullptr && !runtime_filter_->MayMatch(tuple, plan_->OutputSchema());
+    });
+}
+
+void SeqScanExecutor::Project(const Tuple &view, Tuple *tuple) {
+    if(identity_projection_){
+        tuple->CopyFrom(view);
+        return;
+    }
+    const Schema *output_schema = plan_->OutputSchema();
+    out_values_.clear();
+    for(const auto &column : output_schema->GetColumns()){
+        out_values_.push_back(column.GetExpr()->Evaluate(&view, table_schema_));
+    }
+    *tuple = Tuple(out_values_, output_schema);
+}
+
+void SeqScanExecutor::ReadColumns(const Tuple &view) {
+    for(uint32_t col_idx : scan_columns_){
+        scan_batch_.GetMutableColumn(col_idx)->push_back(view.GetValue(table_schema_, col_idx));
+    }
+    num_bytes_read_ += view.GetLength();
+}
+
+bool SeqScanExecutor::NextBatch(TupleBatch *batch) {
+    const Schema *output_schema = plan_->OutputSchema();
+    std::vector<Value> values;
+
+    while(true){
+        scan_batch_.Reset(table_schema_->GetColumnCount());
+        uint32_t num_rows = 0;
+        if(compiled_predicate_ != nullptr){
+            // The views of the tuples of a page are collected, and filtered all at once before the page is
+            // unpinned. There are never more of them than there is room left in the batch.
+            row_data_.clear();
+            row_sizes_.clear();
+            bool stopped = ScanTuples(
+                [&](const Tuple &view){
+                    row_data_.push_back(view.GetData());
+                    row_sizes_.push_back(view.GetLength());
+                    return num_rows + row_data_.size() < TupleBatch::BATCH_SIZE;
+                },
+                [&](){
+                    if(row_data_.empty()){
+                        return;
+                    }
+                    selection_.resize(row_data_.size());
+                    std::iota(selection_.begin(), selection_.end(), 0);
+                    compiled_predicate_->Filter(row_data_.data(), &selection_);
+                    num_batch_filtered_ += row_data_.size();
+                    for(uint32_t i : selection_){
+                        ReadColumns(Tuple(row_data_[i], row_sizes_[i]));
+                    }
+                    num_rows += selection_.size();
+                    row_data_.clear();
+                    row_sizes_.clear();
+                });
+            if(num_rows == 0){
+                if(!stopped){
+                    return false;
+                }
+                continue;
+            }
+        } else {
+            ScanTuples([&](const Tuple &view){
+                if(!Matches(view)){
+                    return true;
+                }
+                ReadColumns(view);
+                return ++num_rows < TupleBatch::BATCH_SIZE;
+            });
+            if(num_rows == 0){
+                return false;
+            }
+        }
+        scan_batch_.SetNumRows(num_rows);
+
+        // Project the selected rows onto the output schema.
+        batch->Reset(output_schema->GetColumnCount());
+        for(uint32_t i = 0; i < output_schema->GetColumnCount(); ++i){
+            const auto &column_values = output_schema->GetColumn(i).GetExpr()->EvaluateBatchView(scan_batch_, &values);
+            auto column = batch->GetMutableColumn(i);
+            for(uint32_t row_idx : scan_batch_.GetSelection()){
+                column->push_back(column_values[row_idx]);
+            }
+        }
+        batch->SetNumRows(scan_batch_.NumSelected());
+        if(runtime_filter_ != nullptr){
+            runtime_filter_->Filter(batch);
+            if(batch->IsEmpty()){
+                continue;
+            }
+        }
+        return true;
+    }
 }
 
 }  // namespace bustub
@@ -0,0 +1,245 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simd_filter.cpp
+//
+// Identification: src/execution/simd_filter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/simd_filter.h"
+
+#include <cstring>
+#include <functional>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BUSTUB_SIMD_X86 1
+// The kernels below pass vectors between functions of this file only, so their calling convention does not matter.
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace bustub {
+
+namespace {
+
+template <typename T, typename Op>
+void ScalarCompare(const T *values, size_t begin, size_t num_values, T constant, uint64_t *bitmap) {
+  for (size_t i = begin; i < num_values; i++) {
+    if (values[i] != SimdFilter::NullOf<T>() && Op()(values[i], constant)) {
+      bitmap[i / 64] |= uint64_t{1} << (i % 64);
+    }
+  }
+}
+
+template <typename T>
+void ScalarCompare(const T *values, size_t begin, size_t num_values, ComparisonType comp_type, T constant,
+                   uint64_t *bitmap) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      ScalarCompare<T, std::equal_to<>>(values, begin, num_values, constant, bitmap);
+      break;
+    case ComparisonType::NotEqual:
+      ScalarCompare<T, std::not_equal_to<>>(values, begin, num_values, constant, bitmap);
+      break;
+    case ComparisonType::LessThan:
+      ScalarCompare<T, std::less<>>(values, begin, num_values, constant, bitmap);
+      break;
+    case ComparisonType::LessThanOrEqual:
+      ScalarCompare<T, std::less_equal<>>(values, begin, num_values, constant, bitmap);
+      break;
+    case ComparisonType::GreaterThan:
+      ScalarCompare<T, std::greater<>>(values, begin, num_values, constant, bitmap);
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      ScalarCompare<T, std::greater_equal<>>(values, begin, num_values, constant, bitmap);
+      break;
+  }
+}
+
+#ifdef BUSTUB_SIMD_X86
+
+/*
+ * Each Traits class wraps the intrinsics of one instruction set and value type. Eq(), Gt() and Lt() compare LANES
+ * values at once and return one bit per lane. Every comparison is one of them or its complement.
+ */
+
+#define BUSTUB_AVX2 __attribute__((target("avx2")))
+#define BUSTUB_SSE42 __attribute__((target("sse4.2")))
+
+struct Avx2Int32 {
+  using Vec = __m256i;
+  static constexpr size_t LANES = 8;
+  BUSTUB_AVX2 static Vec Load(const int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  BUSTUB_AVX2 static Vec Set1(int32_t v) { return _mm256_set1_epi32(v); }
+  BUSTUB_AVX2 static uint32_t Bits(Vec v) { return _mm256_movemask_ps(_mm256_castsi256_ps(v)); }
+  BUSTUB_AVX2 static uint32_t Eq(Vec a, Vec b) { return Bits(_mm256_cmpeq_epi32(a, b)); }
+  BUSTUB_AVX2 static uint32_t Gt(Vec a, Vec b) { return Bits(_mm256_cmpgt_epi32(a, b)); }
+  BUSTUB_AVX2 static uint32_t Lt(Vec a, Vec b) { return Bits(_mm256_cmpgt_epi32(b, a)); }
+};
+
+struct Avx2Int64 {
+  using Vec = __m256i;
+  static constexpr size_t LANES = 4;
+  BUSTUB_AVX2 static Vec Load(const int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+  BUSTUB_AVX2 static Vec Set1(int64_t v) { return _mm256_set1_epi64x(v); }
+  BUSTUB_AVX2 static uint32_t Bits(Vec v) { return _mm256_movemask_pd(_mm256_castsi256_pd(v)); }
+  BUSTUB_AVX2 static uint32_t Eq(Vec a, Vec b) { return Bits(_mm256_cmpeq_epi64(a, b)); }
+  BUSTUB_AVX2 static uint32_t Gt(Vec a, Vec b) { return Bits(_mm256_cmpgt_epi64(a, b)); }
+  BUSTUB_AVX2 static uint32_t Lt(Vec a, Vec b) { return Bits(_mm256_cmpgt_epi64(b, a)); }
+};
+
+struct Avx2Double {
+  using Vec = __m256d;
+  static constexpr size_t LANES = 4;
+  BUSTUB_AVX2 static Vec Load(const double *p) { return _mm256_loadu_pd(p); }
+  BUSTUB_AVX2 static Vec Set1(double v) { return _mm256_set1_pd(v); }
+  BUSTUB_AVX2 static uint32_t Eq(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+  BUSTUB_AVX2 static uint32_t Gt(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+  BUSTUB_AVX2 static uint32_t Lt(Vec a, Vec b) { return _mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+};
+
+struct Sse42Int32 {
+  using Vec = __m128i;
+  static constexpr size_t LANES = 4;
+  BUSTUB_SSE42 static Vec Load(const int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+  BUSTUB_SSE42 static Vec Set1(int32_t v) { return _mm_set1_epi32(v); }
+  BUSTUB_SSE42 static uint32_t Bits(Vec v) { return _mm_movemask_ps(_mm_castsi128_ps(v)); }
+  BUSTUB_SSE42 static uint32_t Eq(Vec a, Vec b) { return Bits(_mm_cmpeq_epi32(a, b)); }
+  BUSTUB_SSE42 static uint32_t Gt(Vec a, Vec b) { return Bits(_mm_cmpgt_epi32(a, b)); }
+  BUSTUB_SSE42 static uint32_t Lt(Vec a, Vec b) { return Bits(_mm_cmplt_epi32(a, b)); }
+};
+
+struct Sse42Int64 {
+  using Vec = __m128i;
+  static constexpr size_t LANES = 2;
+  BUSTUB_SSE42 static Vec Load(const int64_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+  BUSTUB_SSE42 static Vec Set1(int64_t v) { return _mm_set1_epi64x(v); }
+  BUSTUB_SSE42 static uint32_t Bits(Vec v) { return _mm_movemask_pd(_mm_castsi128_pd(v)); }
+  BUSTUB_SSE42 static uint32_t Eq(Vec a, Vec b) { return Bits(_mm_cmpeq_epi64(a, b)); }
+  BUSTUB_SSE42 static uint32_t Gt(Vec a, Vec b) { return Bits(_mm_cmpgt_epi64(a, b)); }
+  BUSTUB_SSE42 static uint32_t Lt(Vec a, Vec b) { return Bits(_mm_cmpgt_epi64(b, a)); }
+};
+
+struct Sse42Double {
+  using Vec = __m128d;
+  static constexpr size_t LANES = 2;
+  BUSTUB_SSE42 static Vec Load(const double *p) { return _mm_loadu_pd(p); }
+  BUSTUB_SSE42 static Vec Set1(double v) { return _mm_set1_pd(v); }
+  BUSTUB_SSE42 static uint32_t Eq(Vec a, Vec b) { return _mm_movemask_pd(_mm_cmpeq_pd(a, b)); }
+  BUSTUB_SSE42 static uint32_t Gt(Vec a, Vec b) { return _mm_movemask_pd(_mm_cmpgt_pd(a, b)); }
+  BUSTUB_SSE42 static uint32_t Lt(Vec a, Vec b) { return _mm_movemask_pd(_mm_cmplt_pd(a, b)); }
+};
+
+/**
+ * Compares LANES values at a time, and the remaining ones with the scalar loop. Only instantiated inside functions
+ * that are compiled for the instruction set of Traits.
+ */
+template <typename Traits, typename T>
+__attribute__((always_inline)) inline void VectorCompare(const T *values, size_t num_values, ComparisonType comp_type,
+                                                         T constant, uint64_t *bitmap) {
+  constexpr uint32_t all_lanes = (1U << Traits::LANES) - 1;
+  auto constants = Traits::Set1(constant);
+  auto nulls = Traits::Set1(SimdFilter::NullOf<T>());
+  size_t i = 0;
+  for (; i + Traits::LANES <= num_values; i += Traits::LANES) {
+    auto vec = Traits::Load(values + i);
+    uint32_t bits;
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        bits = Traits::Eq(vec, constants);
+        break;
+      case ComparisonType::NotEqual:
+        bits = ~Traits::Eq(vec, constants);
+        break;
+      case ComparisonType::LessThan:
+        bits = Traits::Lt(vec, constants);
+        break;
+      case ComparisonType::LessThanOrEqual:
+        bits = ~Traits::Gt(vec, constants);
+        break;
+      case ComparisonType::GreaterThan:
+        bits = Traits::Gt(vec, constants);
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+      default:
+        bits = ~Traits::Lt(vec, constants);
+        break;
+    }
+    bits &= ~Traits::Eq(vec, nulls) & all_lanes;
+    // LANES divides 64, so the lanes never straddle two words.
+    bitmap[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+  }
+  ScalarCompare(values, i, num_values, comp_type, constant, bitmap);
+}
+
+BUSTUB_AVX2 void Avx2Compare(const int32_t *values, size_t n, ComparisonType comp, int32_t c, uint64_t *bitmap) {
+  VectorCompare<Avx2Int32>(values, n, comp, c, bitmap);
+}
+BUSTUB_AVX2 void Avx2Compare(const int64_t *values, size_t n, ComparisonType comp, int64_t c, uint64_t *bitmap) {
+  VectorCompare<Avx2Int64>(values, n, comp, c, bitmap);
+}
+BUSTUB_AVX2 void Avx2Compare(const double *values, size_t n, ComparisonType comp, double c, uint64_t *bitmap) {
+  VectorCompare<Avx2Double>(values, n, comp, c, bitmap);
+}
+BUSTUB_SSE42 void Sse42Compare(const int32_t *values, size_t n, ComparisonType comp, int32_t c, uint64_t *bitmap) {
+  VectorCompare<Sse42Int32>(values, n, comp, c, bitmap);
+}
+BUSTUB_SSE42 void Sse42Compare(const int64_t *values, size_t n, ComparisonType comp, int64_t c, uint64_t *bitmap) {
+  VectorCompare<Sse42Int64>(values, n, comp, c, bitmap);
+}
+BUSTUB_SSE42 void Sse42Compare(const double *values, size_t n, ComparisonType comp, double c, uint64_t *bitmap) {
+  VectorCompare<Sse42Double>(values, n, comp, c, bitmap);
+}
+
+#endif
+
+}  // namespace
+
+SimdFilter::Isa SimdFilter::DetectIsa() {
+#ifdef BUSTUB_SIMD_X86
+  static const Isa isa = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return Isa::SSE42;
+    }
+    return Isa::Scalar;
+  }();
+  return isa;
+#else
+  return Isa::Scalar;
+#endif
+}
+
+template <typename T>
+void SimdFilter::Compare(Isa isa, const T *values, size_t num_values, ComparisonType comp_type, T constant,
+                         uint64_t *bitmap) {
+  std::memset(bitmap, 0, (num_values + 63) / 64 * sizeof(uint64_t));
+  switch (isa) {
+#ifdef BUSTUB_SIMD_X86
+    case Isa::AVX2:
+      Avx2Compare(values, num_values, comp_type, constant, bitmap);
+      return;
+    case Isa::SSE42:
+      Sse42Compare(values, num_values, comp_type, constant, bitmap);
+      return;
+#endif
+    default:
+      ScalarCompare(values, 0, num_values, comp_type, constant, bitmap);
+  }
+}
+
+template void SimdFilter::Compare<int32_t>(Isa isa, const int32_t *values, size_t num_values,
+                                           ComparisonType comp_type, int32_t constant, uint64_t *bitmap);
+template void SimdFilter::Compare<int64_t>(Isa isa, const int64_t *values, size_t num_values,
+                                           ComparisonType comp_type, int64_t constant, uint64_t *bitmap);
+template void SimdFilter::Compare<double>(Isa isa, const double *values, size_t num_values, ComparisonType comp_type,
+                                          double constant, uint64_t *bitmap);
+
+}  // namespace bustub
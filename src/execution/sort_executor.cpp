@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/sort_executor.h"
+
+namespace bustub {
+
+SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)), encoder_(plan->GetOrderBys()) {}
+
+void SortExecutor::Init() {
+    InitPush();
+    child_->Init();
+    TupleBatch batch;
+    while(child_->NextBatch(&batch)){
+        Push(0, &batch, nullptr);
+    }
+    FinishPush(0, nullptr);
+}
+
+void SortExecutor::InitPush() {
+    tuples_.clear();
+    keys_.clear();
+    order_.clear();
+    memory_bytes_ = 0;
+    next_ = 0;
+    cursors_.clear();
+    merge_heap_.clear();
+    runs_.clear();
+}
+
+void SortExecutor::Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {
+    const Schema *child_schema = child_->GetOutputSchema();
+    encoder_.EncodeBatch(*batch, &keys_);
+    for(uint32_t row_idx : batch->GetSelection()){
+        tuples_.push_back(batch->GetTuple(row_idx, child_schema));
+        memory_bytes_ += tuples_.back().GetLength() + encoder_.KeyWidth() + TUPLE_OVERHEAD;
+    }
+    if(memory_bytes_ > exec_ctx_->GetMemoryBudget()){
+        SpillRun();
+    }
+}
+
+void SortExecutor::FinishPush(uint32_t input_idx, BatchConsumer *consumer) {
+    SortInMemory();
+    if(runs_.empty()){
+        return;
+    }
+
+    // Merge the runs with what is left in memory.
+    for(auto &run : runs_){
+        cursors_.push_back(RunCursor{run.get(), 0, {}, 0, {}});
+    }
+    RunCursor in_memory{nullptr, 0, {}, 0, {}};
+    for(uint32_t idx : order_){
+        in_memory.tuples_.push_back(std::move(tuples_[idx]));
+    }
+    cursors_.push_back(std::move(in_memory));
+    tuples_.clear();
+    keys_.clear();
+    order_.clear();
+    for(size_t i = 0; i < cursors_.size(); ++i){
+        cursors_[i].key_.resize(encoder_.KeyWidth());
+        if(LoadCurrent(&cursors_[i])){
+            merge_heap_.push_back(i);
+        }
+    }
+    auto sorts_after = [this](size_t a, size_t b){ return SortsAfter(a, b); };
+    std::make_heap(merge_heap_.begin(), merge_heap_.end(), sorts_after);
+}
+
+void SortExecutor::SortInMemory() {
+    const Schema *child_schema = child_->GetOutputSchema();
+    size_t key_width = encoder_.KeyWidth();
+    order_.resize(tuples_.size());
+    for(uint32_t i = 0; i < order_.size(); ++i){
+        order_[i] = i;
+    }
+    std::sort(order_.begin(), order_.end(), [&](uint32_t a, uint32_t b){
+        return encoder_.Compare(&keys_[a * key_width], tuples_[a], &keys_[b * key_width], tuples_[b],
+                                child_schema) < 0;
+    });
+}
+
+void SortExecutor::SpillRun() {
+    SortInMemory();
+    auto run = std::make_unique<TmpTupleHeap>(exec_ctx_->GetBufferPoolManager());
+    for(uint32_t idx : order_){
+        run->Append(tuples_[idx]);
+    }
+    runs_.push_back(std::move(run));
+    tuples_.clear();
+    keys_.clear();
+    order_.clear();
+    memory_bytes_ = 0;
+}
+
+bool SortExecutor::LoadCurrent(RunCursor *cursor) {
+    if(cursor->pos_ >= cursor->tuples_.size()){
+        if(cursor->run_ == nullptr || cursor->next_page_ >= cursor->run_->NumPages()){
+            return false;
+        }
+        cursor->tuples_.clear();
+        cursor->run_->GetPageTuples(cursor->next_page_++, &cursor->tuples_);
+        // Pages hand back their tuples last appended first.
+        std::reverse(cursor->tuples_.begin(), cursor->tuples_.end());
+        cursor->pos_ = 0;
+    }
+    encoder_.Encode(cursor->tuples_[cursor->pos_], child_->GetOutputSchema(), cursor->key_.data());
+    return true;
+}
+
+bool SortExecutor::SortsAfter(size_t a, size_t b) const {
+    const RunCursor &cursor_a = cursors_[a];
+    const RunCursor &cursor_b = cursors_[b];
+    return encoder_.Compare(cursor_a.key_.data(), cursor_a.tuples_[cursor_a.pos_], cursor_b.key_.data(),
+                            cursor_b.tuples_[cursor_b.pos_], child_->GetOutputSchema()) > 0;
+}
+
+bool SortExecutor::Next(Tuple *tuple) {
+    if(cursors_.empty()){
+        if(next_ >= order_.size()){
+            return false;
+        }
+        *tuple = tuples_[order_[next_++]];
+        return true;
+    }
+    if(merge_heap_.empty()){
+        return false;
+    }
+    auto sorts_after = [this](size_t a, size_t b){ return SortsAfter(a, b); };
+    std::pop_heap(merge_heap_.begin(), merge_heap_.end(), sorts_after);
+    RunCursor &cursor = cursors_[merge_heap_.back()];
+    *tuple = cursor.tuples_[cursor.pos_];
+    cursor.pos_++;
+    if(LoadCurrent(&cursor)){
+        std::push_heap(merge_heap_.begin(), merge_heap_.end(), sorts_after);
+    } else {
+        merge_heap_.pop_back();
+    }
+    return true;
+}
+
+}  // namespace bustub
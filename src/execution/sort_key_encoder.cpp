@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key_encoder.cpp
+//
+// Identification: src/execution/sort_key_encoder.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the number of bytes that encode a value of the type, not counting the null byte */
+size_t EncodedWidth(TypeId type) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return 1;
+    case TypeId::SMALLINT:
+      return 2;
+    case TypeId::INTEGER:
+      return 4;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return 8;
+    case TypeId::VARCHAR:
+      return SortKeyEncoder::VARCHAR_PREFIX_SIZE;
+    default:
+      UNREACHABLE("Cannot sort on this type.");
+  }
+}
+
+/** Writes the low width bytes of bits in big-endian. */
+void StoreBigEndian(uint64_t bits, size_t width, uint8_t *out) {
+  for (size_t i = 0; i < width; i++) {
+    out[i] = static_cast<uint8_t>(bits >> (8 * (width - 1 - i)));
+  }
+}
+
+}  // namespace
+
+SortKeyEncoder::SortKeyEncoder(const std::vector<OrderBy> &order_bys) : order_bys_(order_bys) {
+  for (const auto &order_by : order_bys_) {
+    TypeId type = order_by.second->GetReturnType();
+    offsets_.push_back(key_width_);
+    key_width_ += 1 + EncodedWidth(type);
+    if (exact_) {
+      compare_width_ = key_width_;
+    }
+    exact_ = exact_ && type != TypeId::VARCHAR;
+  }
+  columns_.resize(order_bys_.size());
+}
+
+void SortKeyEncoder::EncodeValue(size_t key_idx, const Value &value, uint8_t *out) const {
+  TypeId type = order_bys_[key_idx].second->GetReturnType();
+  size_t width = EncodedWidth(type);
+  std::memset(out, 0, 1 + width);
+  if (!value.IsNull()) {
+    out[0] = 1;
+    uint8_t *data = out + 1;
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        StoreBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, width, data);
+        break;
+      case TypeId::SMALLINT:
+        StoreBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, width, data);
+        break;
+      case TypeId::INTEGER:
+        StoreBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, width, data);
+        break;
+      case TypeId::BIGINT:
+        StoreBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (uint64_t{1} << 63), width, data);
+        break;
+      case TypeId::TIMESTAMP:
+        StoreBigEndian(value.GetAs<uint64_t>(), width, data);
+        break;
+      case TypeId::DECIMAL: {
+        // Negative doubles order backwards, so all their bits are flipped; positive ones only need the sign bit.
+        auto decimal = value.GetAs<double>();
+        uint64_t bits;
+        std::memcpy(&bits, &decimal, sizeof(bits));
+        bits = (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+        StoreBigEndian(bits, width, data);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        // The length counts the terminating null character, which is not part of the string.
+        size_t length = value.GetLength() == 0 ? 0 : value.GetLength() - 1;
+        std::memcpy(data, value.GetData(), std::min(length, width));
+        break;
+      }
+      default:
+        UNREACHABLE("Cannot sort on this type.");
+    }
+  }
+  if (order_bys_[key_idx].first == OrderByType::Desc) {
+    for (size_t i = 0; i < 1 + width; i++) {
+      out[i] = static_cast<uint8_t>(~out[i]);
+    }
+  }
+}
+
+void SortKeyEncoder::EncodeBatch(const TupleBatch &batch, std::vector<uint8_t> *keys) {
+  std::vector<const std::vector<Value> *> columns(order_bys_.size());
+  for (size_t i = 0; i < order_bys_.size(); i++) {
+    columns[i] = &order_bys_[i].second->EvaluateBatchView(batch, &columns_[i]);
+  }
+  size_t begin = keys->size();
+  keys->resize(begin + batch.NumSelected() * key_width_);
+  uint8_t *key = keys->data() + begin;
+  for (uint32_t row_idx : batch.GetSelection()) {
+    for (size_t i = 0; i < order_bys_.size(); i++) {
+      EncodeValue(i, (*columns[i])[row_idx], key + offsets_[i]);
+    }
+    key += key_width_;
+  }
+}
+
+void SortKeyEncoder::Encode(const Tuple &tuple, const Schema *schema, uint8_t *key) const {
+  for (size_t i = 0; i < order_bys_.size(); i++) {
+    EncodeValue(i, order_bys_[i].second->Evaluate(&tuple, schema), key + offsets_[i]);
+  }
+}
+
+int SortKeyEncoder::Compare(const uint8_t *a_key, const Tuple &a, const uint8_t *b_key, const Tuple &b,
+                            const Schema *schema) const {
+  int cmp = CompareKeys(a_key, b_key);
+  if (cmp != 0 || exact_) {
+    return cmp;
+  }
+  return CompareValues(a, b, schema);
+}
+
+int SortKeyEncoder::CompareValues(const Tuple &a, const Tuple &b, const Schema *schema) const {
+  for (const auto &order_by : order_bys_) {
+    Value a_value = order_by.second->Evaluate(&a, schema);
+    Value b_value = order_by.second->Evaluate(&b, schema);
+    int cmp;
+    if (a_value.IsNull() || b_value.IsNull()) {
+      // Nulls sort before every value.
+      cmp = static_cast<int>(!a_value.IsNull()) - static_cast<int>(!b_value.IsNull());
+    } else if (a_value.CompareLessThan(b_value) == CmpBool::CmpTrue) {
+      cmp = -1;
+    } else {
+      cmp = a_value.CompareGreaterThan(b_value) == CmpBool::CmpTrue ? 1 : 0;
+    }
+    if (cmp != 0) {
+      return order_by.first == OrderByType::Desc ? -cmp : cmp;
+    }
+  }
+  return 0;
+}
+
+}  // namespace bustub
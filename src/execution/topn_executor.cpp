@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.cpp
+//
+// Identification: src/execution/topn_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/topn_executor.h"
+
+namespace bustub {
+
+TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)), encoder_(plan->GetOrderBys()) {}
+
+bool TopNExecutor::SortsBefore(size_t a, size_t b) const {
+    return encoder_.Compare(KeyAt(a), tuples_[a], KeyAt(b), tuples_[b], child_->GetOutputSchema()) < 0;
+}
+
+void TopNExecutor::Init() {
+    InitPush();
+    child_->Init();
+    TupleBatch batch;
+    while(plan_->GetN() > 0 && child_->NextBatch(&batch)){
+        Push(0, &batch, nullptr);
+    }
+    FinishPush(0, nullptr);
+}
+
+void TopNExecutor::InitPush() {
+    tuples_.clear();
+    keys_.clear();
+    heap_.clear();
+    next_ = 0;
+}
+
+void TopNExecutor::Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {
+    size_t n = plan_->GetN();
+    if(n == 0){
+        return;
+    }
+
+    size_t key_width = encoder_.KeyWidth();
+    const Schema *child_schema = child_->GetOutputSchema();
+    auto sorts_before = [this](size_t a, size_t b){ return SortsBefore(a, b); };
+    Tuple candidate;
+    batch_keys_.clear();
+    encoder_.EncodeBatch(*batch, &batch_keys_);
+    const uint8_t *key = batch_keys_.data();
+    for(uint32_t row_idx : batch->GetSelection()){
+        if(heap_.size() < n){
+            // Fill the heap up to n tuples.
+            heap_.push_back(tuples_.size());
+            tuples_.push_back(batch->GetTuple(row_idx, child_schema));
+            keys_.insert(keys_.end(), key, key + key_width);
+            std::push_heap(heap_.begin(), heap_.end(), sorts_before);
+        } else {
+            // Replace the tuple that sorts last if this one sorts before it. Most rows stop at the key comparison.
+            size_t last = heap_.front();
+            int cmp = encoder_.CompareKeys(key, KeyAt(last));
+            if(cmp == 0 && !encoder_.IsExact()){
+                candidate = batch->GetTuple(row_idx, child_schema);
+                cmp = encoder_.CompareValues(candidate, tuples_[last], child_schema);
+            }
+            if(cmp < 0){
+                std::pop_heap(heap_.begin(), heap_.end(), sorts_before);
+                tuples_[last] = batch->GetTuple(row_idx, child_schema);
+                std::memcpy(&keys_[last * key_width], key, key_width);
+                std::push_heap(heap_.begin(), heap_.end(), sorts_before);
+            }
+        }
+        key += key_width;
+    }
+}
+
+void TopNExecutor::FinishPush(uint32_t input_idx, BatchConsumer *consumer) {
+    auto sorts_before = [this](size_t a, size_t b){ return SortsBefore(a, b); };
+    std::sort_heap(heap_.begin(), heap_.end(), sorts_before);
+}
+
+bool TopNExecutor::Next(Tuple *tuple) {
+    if(next_ >= heap_.size()){
+        return false;
+    }
+    *tuple = tuples_[heap_[next_++]];
+    return true;
+}
+
+}  // namespace bustub
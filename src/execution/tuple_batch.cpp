@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(uint32_t num_columns) {
+  columns_.resize(num_columns);
+  for (auto &column : columns_) {
+    column.clear();
+    column.reserve(BATCH_SIZE);
+  }
+  selection_.clear();
+  num_rows_ = 0;
+}
+
+void TupleBatch::AppendRow(const std::vector<Value> &values) {
+  BUSTUB_ASSERT(values.size() == columns_.size(), "Row does not match the batch.");
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(values[i]);
+  }
+  selection_.push_back(num_rows_++);
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, const Schema *schema) {
+  BUSTUB_ASSERT(schema->GetColumnCount() == columns_.size(), "Tuple does not match the batch.");
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(schema, i));
+  }
+  selection_.push_back(num_rows_++);
+}
+
+void TupleBatch::AppendRowFrom(const TupleBatch &other, uint32_t row_idx) {
+  BUSTUB_ASSERT(other.columns_.size() == columns_.size(), "Row does not match the batch.");
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(other.columns_[i][row_idx]);
+  }
+  selection_.push_back(num_rows_++);
+}
+
+void TupleBatch::SetNumRows(uint32_t num_rows) {
+  num_rows_ = num_rows;
+  selection_.resize(num_rows);
+  for (uint32_t i = 0; i < num_rows; i++) {
+    selection_[i] = i;
+  }
+}
+
+void TupleBatch::Filter(const std::vector<Value> &predicate) {
+  uint32_t num_selected = 0;
+  for (uint32_t row_idx : selection_) {
+    if (!predicate[row_idx].IsNull() && predicate[row_idx].GetAs<bool>()) {
+      selection_[num_selected++] = row_idx;
+    }
+  }
+  selection_.resize(num_selected);
+}
+
+void TupleBatch::Filter(const std::vector<bool> &keep) {
+  uint32_t num_selected = 0;
+  for (uint32_t row_idx : selection_) {
+    if (keep[row_idx]) {
+      selection_[num_selected++] = row_idx;
+    }
+  }
+  selection_.resize(num_selected);
+}
+
+Tuple TupleBatch::GetTuple(uint32_t row_idx, const Schema *schema) const {
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row_idx]);
+  }
+  return Tuple(values, schema);
+}
+
+}  // namespace bustub
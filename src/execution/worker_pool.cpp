@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.cpp
+//
+// Identification: src/execution/worker_pool.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/worker_pool.h"
+
+namespace bustub {
+
+WorkerPool::WorkerPool(size_t num_workers) {
+  BUSTUB_ASSERT(num_workers > 0, "A worker pool needs at least one worker.");
+  workers_.reserve(num_workers);
+  for (size_t worker_id = 0; worker_id < num_workers; worker_id++) {
+    workers_.emplace_back(&WorkerPool::WorkerLoop, this, worker_id);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    shutdown_ = true;
+  }
+  task_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkerPool::RunOnAll(const std::function<void(size_t)> &task) {
+  std::lock_guard<std::mutex> run_guard(run_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  task_ = &task;
+  num_running_ = workers_.size();
+  generation_++;
+  task_cv_.notify_all();
+  done_cv_.wait(lock, [this] { return num_running_ == 0; });
+  task_ = nullptr;
+}
+
+void WorkerPool::WorkerLoop(size_t worker_id) {
+  uint64_t seen_generation = 0;
+  while (true) {
+    const std::function<void(size_t)> *task;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      task_cv_.wait(lock, [&] { return shutdown_ || generation_ != seen_generation; });
+      if (shutdown_) {
+        return;
+      }
+      seen_generation = generation_;
+      task = task_;
+    }
+
+    (*task)(worker_id);
+
+    std::lock_guard<std::mutex> guard(latch_);
+    if (--num_running_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+}  // namespace bustub
@@ -4,10 +4,13 @@
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "container/hash/hash_function.h"
 #include "storage/index/index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -17,6 +20,7 @@ namespace bustub {
  */
 using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
+using index_oid_t = uint32_t;
 
 /**
  * Metadata about a table.
@@ -30,12 +34,27 @@ struct TableMetadata {
   table_oid_t oid_;
 };
 
+/**
+ * Metadata about an index.
+ */
+struct IndexInfo {
+  IndexInfo(std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid, std::string table_name)
+      : name_(std::move(name)), index_(std::move(index)), index_oid_(index_oid), table_name_(std::move(table_name)) {}
+  std::string name_;
+  std::unique_ptr<Index> index_;
+  index_oid_t index_oid_;
+  std::string table_name_;
+};
+
 /**
  * SimpleCatalog is a non-persistent catalog that is designed for the executor to use.
- * It handles table creation and table lookup.
+ * It handles table and index creation, and their lookup.
  */
 class SimpleCatalog {
  public:
+  /** Initial number of block pages of an index, unless CreateIndex is told otherwise; indexes grow as needed. */
+  static constexpr size_t DEFAULT_INDEX_BUCKETS = 4;
+
   /**
    * Creates a new catalog object.
    * @param bpm the buffer pool manager backing tables created by this catalog
@@ -80,6 +99,66 @@ class SimpleCatalog {
       return search->second.get();
   }
 
+  /**
+   * Creates a hash index over some columns of a table, fills it with the tuples already in the table, and returns
+   * its metadata. Executors that insert into the table keep its indexes up to date.
+   * @tparam KeyType the key type of the index, large enough for the indexed columns, e.g. GenericKey<8>
+   * @param txn the transaction in which the index is being created
+   * @param index_name the name of the new index, unique among the indexes of the table
+   * @param table_name the name of the indexed table
+   * @param key_attrs the indexed columns of the table
+   * @param num_buckets the initial number of block pages of the hash table
+   * @return a pointer to the metadata of the new index
+   */
+  template <typename KeyType, typename ValueType, typename KeyComparator>
+  IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                         const std::vector<uint32_t> &key_attrs, size_t num_buckets = DEFAULT_INDEX_BUCKETS) {
+    TableMetadata *table = GetTable(table_name);
+    BUSTUB_ASSERT(table != nullptr, "Indexed table does not exist.");
+    BUSTUB_ASSERT(GetIndex(index_name, table_name) == nullptr, "Index names should be unique per table!");
+    auto metadata = new IndexMetadata(index_name, table_name, &table->schema_, key_attrs);
+    auto index = std::make_unique<LinearProbeHashTableIndex<KeyType, ValueType, KeyComparator>>(
+        metadata, bpm_, num_buckets, HashFunction<KeyType>());
+
+    for (auto iter = table->table_->Begin(txn); iter != table->table_->End(); ++iter) {
+      index->InsertEntry(iter->KeyFromTuple(&table->schema_, metadata->GetKeySchema(), key_attrs), iter->GetRid(),
+                         txn);
+    }
+
+    index_oid_t index_oid = next_index_oid_++;
+    indexes_.insert({index_oid, std::make_unique<IndexInfo>(index_name, std::move(index), index_oid, table_name)});
+    index_names_[table_name].insert({index_name, index_oid});
+    return indexes_[index_oid].get();
+  }
+
+  /** @return index metadata by index name and table name, or nullptr if there is no such index */
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes == index_names_.end()) {
+      return nullptr;
+    }
+    auto search = table_indexes->second.find(index_name);
+    return search == table_indexes->second.end() ? nullptr : GetIndex(search->second);
+  }
+
+  /** @return index metadata by oid, or nullptr if there is no such index */
+  IndexInfo *GetIndex(index_oid_t index_oid) {
+    auto search = indexes_.find(index_oid);
+    return search == indexes_.end() ? nullptr : search->second.get();
+  }
+
+  /** @return the metadata of every index of a table */
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::vector<IndexInfo *> result;
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes != index_names_.end()) {
+      for (const auto &entry : table_indexes->second) {
+        result.push_back(GetIndex(entry.second));
+      }
+    }
+    return result;
+  }
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -91,5 +170,12 @@ class SimpleCatalog {
   std::unordered_map<std::string, table_oid_t> names_;
   /** The next table identifier to be used. */
   std::atomic<table_oid_t> next_table_oid_{0};
+
+  /** indexes_ : index identifiers -> index metadata. Note that indexes_ owns all index metadata. */
+  std::unordered_map<index_oid_t, std::unique_ptr<IndexInfo>> indexes_;
+  /** index_names_ : table names -> index names -> index identifiers */
+  std::unordered_map<std::string, std::unordered_map<std::string, index_oid_t>> index_names_;
+  /** The next index identifier to be used. */
+  std::atomic<index_oid_t> next_index_oid_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_loader.h
+//
+// Identification: src/include/catalog/table_loader.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "catalog/simple_catalog.h"
+#include "execution/executor_context.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TableLoader bulk loads rows into a table, from a local file or from tuples built in memory.
+ *
+ * The input is cut into chunks of about chunk_size bytes at row boundaries. The chunks are parsed and packed into new
+ * table pages in parallel, on the worker pool of the executor context if it has one. Pages are filled directly rather
+ * than through TableHeap::InsertTuple, and are only linked at the end of the table, in input order, once every chunk
+ * is done. The indexes of the table are then updated with all the new rows at once.
+ *
+ * A load is neither logged nor added to the write set of the transaction, so it is meant for filling new tables.
+ *
+ * Files are in one of two formats:
+ * - CSV: one row per line, with the fields of the columns in order, separated by commas. There is no quoting, and an
+ *   empty field is null. Booleans are true/false or 1/0.
+ * - Binary: the rows back to back, each as written by Tuple::SerializeTo for the schema of the table, i.e. its size
+ *   in 4 bytes followed by its data.
+ */
+class TableLoader {
+ public:
+  /** Format of the file to load. */
+  enum class Format : uint8_t { CSV, Binary };
+
+  /** Chunks are cut at the first row boundary after this many bytes, unless told otherwise. */
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+  /**
+   * Creates a new table loader.
+   * @param exec_ctx the executor context, whose transaction and worker pool are used
+   * @param chunk_size the number of bytes after which a chunk is cut
+   */
+  explicit TableLoader(ExecutorContext *exec_ctx, size_t chunk_size = DEFAULT_CHUNK_SIZE)
+      : exec_ctx_{exec_ctx}, chunk_size_{chunk_size} {}
+
+  /**
+   * Loads a file into a table. Nothing is loaded if the file cannot be read or a row does not match the schema of the
+   * table; an Exception is thrown instead.
+   * @param table the table to load into
+   * @param path the path of the file
+   * @param format the format of the file
+   * @return the number of rows loaded
+   */
+  size_t LoadFile(TableMetadata *table, const std::string &path, Format format);
+
+  /**
+   * Loads tuples into a table.
+   * @param table the table to load into
+   * @param tuples tuples for the schema of the table
+   * @return the number of rows loaded
+   */
+  size_t LoadTuples(TableMetadata *table, const std::vector<Tuple> &tuples);
+
+ private:
+  /** What is loaded from one chunk of the input. */
+  struct Chunk {
+    /** The pages filled with the rows of the chunk, in order. */
+    std::vector<page_id_t> page_ids_;
+    /** The rids of the rows. */
+    std::vector<RID> rids_;
+    /** For each index of the table, the keys of the rows. */
+    std::vector<std::vector<Tuple>> keys_;
+  };
+
+  /**
+   * Runs load_chunk(chunk_idx, chunk) for every chunk on the workers, then links the pages of the chunks into the
+   * table and updates its indexes. If a chunk fails, the pages of all chunks are deleted and its exception rethrown.
+   * @return the number of rows loaded
+   */
+  size_t Load(TableMetadata *table, size_t num_chunks, const std::function<void(size_t, Chunk *)> &load_chunk);
+
+  /** Packs tuples into as few new pages as possible, and computes their keys. */
+  void PackTuples(const Tuple *begin, const Tuple *end, Chunk *chunk);
+
+  /** Parses the CSV lines in [begin, end) into tuples. */
+  void ParseCsv(const char *begin, const char *end, std::vector<Tuple> *tuples);
+
+  /**
+   * Makes views over the binary rows in [begin, end), which were checked to be complete. A row is rejected if it is
+   * shorter than the schema, or if the data of an uninlined column does not lie within it.
+   */
+  void ParseBinary(char *begin, char *end, std::vector<Tuple> *tuples);
+
+  /** Parses a CSV field into a value of the type of a column. */
+  static Value ParseValue(const std::string &field, const Column &column);
+
+  ExecutorContext *exec_ctx_;
+  size_t chunk_size_;
+  /** The table being loaded, and its indexes. */
+  TableMetadata *table_{nullptr};
+  std::vector<IndexInfo *> indexes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/common/epoch_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * EpochManager is a minimal RCU-style reclamation scheme.
+ *
+ * Readers announce themselves in the current epoch with Enter() / Exit() and never block. A writer that has unlinked
+ * a shared structure (e.g. published a new hash table header page) calls Synchronize(), which advances the epoch and
+ * waits until every reader that may still see the old structure has left. Only then may the old structure be freed.
+ *
+ * Synchronize() callers must be serialized externally.
+ */
+class EpochManager {
+ public:
+  EpochManager() = default;
+
+  DISALLOW_COPY_AND_MOVE(EpochManager);
+
+  /**
+   * Enters the current epoch.
+   * @return the epoch that was entered, to be passed to Exit()
+   */
+  uint64_t Enter() {
+    while (true) {
+      uint64_t epoch = global_epoch_.load();
+      active_[epoch & 1].fetch_add(1);
+      // If a writer advanced the epoch in between, it may already have seen our slot as empty. Retry.
+      if (global_epoch_.load() == epoch) {
+        return epoch;
+      }
+      active_[epoch & 1].fetch_sub(1);
+    }
+  }
+
+  /**
+   * Leaves an epoch previously entered with Enter().
+   * @param epoch the epoch returned by Enter()
+   */
+  void Exit(uint64_t epoch) { active_[epoch & 1].fetch_sub(1); }
+
+  /** Advances the epoch and waits for all readers of the previous epoch to leave. */
+  void Synchronize() {
+    uint64_t epoch = global_epoch_.fetch_add(1);
+    while (active_[epoch & 1].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+
+ private:
+  std::atomic<uint64_t> global_epoch_{0};
+  /** Number of readers in the even / odd epochs. */
+  std::atomic<uint64_t> active_[2]{{0}, {0}};
+};
+
+/**
+ * EpochGuard keeps the calling thread inside an epoch for the guard's lifetime.
+ */
+class EpochGuard {
+ public:
+  explicit EpochGuard(EpochManager *epoch_manager) : epoch_manager_(epoch_manager), epoch_(epoch_manager->Enter()) {}
+
+  ~EpochGuard() { epoch_manager_->Exit(epoch_); }
+
+  DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+ private:
+  EpochManager *epoch_manager_;
+  uint64_t epoch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// blocked_bloom_filter.h
+//
+// Identification: src/include/container/hash/blocked_bloom_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BlockedBloomFilter is a Bloom filter over 64-bit hashes whose bits are grouped into cache-line sized blocks. All
+ * bits of a key are set within a single block, so a lookup touches one cache line no matter how many bits it checks.
+ * The filter is not thread-safe; concurrent builders fill their own filters and Merge() them.
+ */
+class BlockedBloomFilter {
+ public:
+  /** Filter bits per expected key. */
+  static constexpr size_t BITS_PER_KEY = 12;
+  /** Number of bits set per key. */
+  static constexpr size_t NUM_PROBES = 4;
+  /** Number of 64-bit words in a block, i.e. one cache line. */
+  static constexpr size_t WORDS_PER_BLOCK = 8;
+
+  /**
+   * Creates an empty filter.
+   * @param num_keys the number of keys the filter is sized for
+   */
+  explicit BlockedBloomFilter(size_t num_keys)
+      : num_blocks_(std::max<size_t>(1, num_keys * BITS_PER_KEY / (64 * WORDS_PER_BLOCK))),
+        words_(num_blocks_ * WORDS_PER_BLOCK, 0) {}
+
+  /** Adds a key. */
+  void Insert(uint64_t hash) {
+    uint64_t mixed = Mix(hash);
+    uint64_t *block = &words_[BlockIndex(mixed) * WORDS_PER_BLOCK];
+    for (size_t i = 0; i < NUM_PROBES; ++i) {
+      block[WordInBlock(mixed, i)] |= BitInWord(mixed, i);
+    }
+  }
+
+  /** @return false if the key was definitely never added, true if it may have been */
+  bool MayContain(uint64_t hash) const {
+    uint64_t mixed = Mix(hash);
+    const uint64_t *block = &words_[BlockIndex(mixed) * WORDS_PER_BLOCK];
+    for (size_t i = 0; i < NUM_PROBES; ++i) {
+      if ((block[WordInBlock(mixed, i)] & BitInWord(mixed, i)) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Adds every key of another filter of the same size.
+   * @param other the filter to merge
+   */
+  void Merge(const BlockedBloomFilter &other) {
+    BUSTUB_ASSERT(other.num_blocks_ == num_blocks_, "Filters of different sizes cannot be merged.");
+    for (size_t i = 0; i < words_.size(); ++i) {
+      words_[i] |= other.words_[i];
+    }
+  }
+
+ private:
+  /** Re-mixes the hash, since callers may hand in hashes that only differ in a few bits. */
+  static uint64_t Mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /** The high half of the mixed hash picks the block, the low half the bits within it. */
+  size_t BlockIndex(uint64_t mixed) const { return static_cast<size_t>((mixed >> 32) % num_blocks_); }
+
+  static size_t WordInBlock(uint64_t mixed, size_t probe) { return (mixed >> (9 * probe)) % WORDS_PER_BLOCK; }
+
+  static uint64_t BitInWord(uint64_t mixed, size_t probe) { return uint64_t{1} << ((mixed >> (9 * probe + 3)) & 63); }
+
+  size_t num_blocks_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_probe_filter.h
+//
+// Identification: src/include/container/hash/hash_table_probe_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * HashTableProbeFilter is an in-memory Bloom filter over the keys of a LinearProbeHashTable, split into one section
+ * per block page. A key is added to the section of its home block, i.e. the block where its probe sequence starts,
+ * no matter where it ends up being stored. A lookup that misses in the section of its home block can therefore
+ * return without fetching any block page.
+ *
+ * Each key sets FILTER_NUM_PROBES bits inside a single 64-bit word of its section, so a check is one atomic load.
+ * Bits are never cleared: removed keys only cost false positives until the filter is rebuilt with the table.
+ */
+class HashTableProbeFilter {
+ public:
+  /** Filter bits per slot of a block page. */
+  static constexpr size_t FILTER_BITS_PER_SLOT = 8;
+  /** Number of bits set per key. */
+  static constexpr size_t FILTER_NUM_PROBES = 3;
+
+  /**
+   * Creates an empty filter.
+   * @param num_blocks number of block pages in the table
+   * @param slots_per_block number of slots in each block page
+   */
+  HashTableProbeFilter(size_t num_blocks, size_t slots_per_block)
+      : words_per_block_(std::max<size_t>(1, slots_per_block * FILTER_BITS_PER_SLOT / 64)),
+        words_(new std::atomic<uint64_t>[num_blocks * words_per_block_]()) {}
+
+  DISALLOW_COPY_AND_MOVE(HashTableProbeFilter);
+
+  /**
+   * Adds a key. Must be called before the key becomes visible in its block page.
+   * @param block_ind the home block of the key
+   * @param hash the hash of the key
+   */
+  void Add(size_t block_ind, uint64_t hash) {
+    uint64_t mixed = Mix(hash);
+    words_[WordIndex(block_ind, mixed)].fetch_or(Mask(mixed));
+  }
+
+  /**
+   * @param block_ind the home block of the key
+   * @param hash the hash of the key
+   * @return false if the key was definitely never added, true if it may have been
+   */
+  bool MayContain(size_t block_ind, uint64_t hash) const {
+    uint64_t mixed = Mix(hash);
+    uint64_t mask = Mask(mixed);
+    return (words_[WordIndex(block_ind, mixed)].load() & mask) == mask;
+  }
+
+ private:
+  /** Re-mixes the hash, whose low bits already chose the home block and slot. */
+  static uint64_t Mix(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  size_t WordIndex(size_t block_ind, uint64_t mixed) const {
+    return block_ind * words_per_block_ + static_cast<size_t>(mixed % words_per_block_);
+  }
+
+  static uint64_t Mask(uint64_t mixed) {
+    uint64_t mask = 0;
+    for (size_t i = 0; i < FILTER_NUM_PROBES; ++i) {
+      mask |= uint64_t{1} << ((mixed >> (40 + 6 * i)) & 63);
+    }
+    return mask;
+  }
+
+  size_t words_per_block_;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+}  // namespace bustub
@@ -12,13 +12,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/epoch_manager.h"
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
+#include "container/hash/hash_table_probe_filter.h"
 #include "container/hash/hash_table.h"
 #include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
@@ -28,6 +33,43 @@ namespace bustub {
 
 #define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
+/**
+ * Occupancy and probe length statistics of a LinearProbeHashTable.
+ */
+struct HashTableStats {
+    /** Total number of slots. */
+    size_t num_slots_{0};
+    /** Number of readable entries. */
+    size_t num_entries_{0};
+    /** Number of slots that are occupied but not readable. */
+    size_t num_tombstones_{0};
+    /** Average number of slots a lookup visits to reach an entry. */
+    double avg_probe_length_{0};
+    /** Largest number of slots a lookup visits to reach an entry. */
+    size_t max_probe_length_{0};
+
+    /** @return the fraction of all slots that are tombstones */
+    double TombstoneRatio() const {
+        return num_slots_ == 0 ? 0 : static_cast<double>(num_tombstones_) / static_cast<double>(num_slots_);
+    }
+};
+
+/**
+ * In-memory copy of the header page tree of a LinearProbeHashTable. The header pages of a table are never modified
+ * after the table is published, so the block page ids are resolved once here instead of on every probe. The directory
+ * also owns the probe filter of the table, which is rebuilt whenever the table is.
+ */
+struct HashTableDirectory {
+    /** Root of the header page tree. */
+    page_id_t header_page_id_{INVALID_PAGE_ID};
+    /** Every header page of the tree, at all levels. */
+    std::vector<page_id_t> header_page_ids_;
+    /** Block page ids, indexed by block index. */
+    std::vector<page_id_t> block_page_ids_;
+    /** Filter over the keys of the table, by home block. */
+    std::unique_ptr<HashTableProbeFilter> probe_filter_;
+};
+
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
@@ -48,6 +90,10 @@ namespace bustub {
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn);
 
+        ~LinearProbeHashTable();
+
+        DISALLOW_COPY_AND_MOVE(LinearProbeHashTable);
+
         /**
          * Inserts a key-value pair into the hash table.
          * @param transaction the current transaction
@@ -67,7 +113,9 @@ namespace bustub {
         bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
 
         /**
-         * Performs a point query on the hash table.
+         * Performs a point query on the hash table. Lookups take no latches: they run inside an epoch and validate
+         * each block page against its version, so they never wait for inserts, removes or a concurrent resize.
+         * Keys that the probe filter rules out are answered without fetching any block page.
          * @param transaction the current transaction
          * @param key the key to look up
          * @param[out] result the value(s) associated with a given key
@@ -75,29 +123,117 @@ namespace bustub {
          */
         bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
+        /**
+         * Loads many key-value pairs at once, e.g. when building an index over an existing table. The table is sized
+         * for the final number of entries up front, the entries are partitioned by the block their probe sequence
+         * starts in, and every block page is then filled in a single visit. Identical <k,v> pairs are skipped.
+         * Concurrent writers are excluded for the duration of the load; lookups may proceed.
+         * @param transaction the current transaction
+         * @param entries the key-value pairs to insert
+         * @param num_threads number of worker threads that fill disjoint ranges of blocks
+         * @return the number of pairs that were inserted
+         */
+        size_t BulkLoad(Transaction *transaction, const std::vector<MappingType> &entries, size_t num_threads = 1);
+
+        /**
+         * Loads the key-value pairs in [first, last). See the vector overload.
+         */
+        template<typename InputIterator>
+        size_t BulkLoad(Transaction *transaction, InputIterator first, InputIterator last, size_t num_threads = 1) {
+            return BulkLoad(transaction, std::vector<MappingType>(first, last), num_threads);
+        }
+
         /**
          * Resizes the table to at least twice the initial size provided.
          * @param initial_size the initial size of the hash table
          */
         void Resize(size_t initial_size);
 
+        /**
+         * Rebuilds the table at its current size, dropping every tombstone and moving each entry back as close to its
+         * home slot as possible. Remove triggers this on its own once tombstones exceed COMPACTION_TOMBSTONE_RATIO of
+         * the slots. Lookups may proceed during compaction; inserts and removes wait for it.
+         */
+        void Compact();
+
+        /**
+         * Scans the whole table. The result is exact when no insert or remove runs concurrently.
+         * @return occupancy and probe length statistics of the table
+         */
+        HashTableStats GetStats();
+
         /**
          * Gets the size of the hash table
          * @return current size of the hash table
          */
         size_t GetSize();
 
+        /**
+         * @return the page id of the root header page
+         */
+        page_id_t GetHeaderPageId();
+
         void GetIndex(const KeyType &key, const size_t &numBlocks, size_t &index, size_t &block_ind, size_t &bucket_ind);
 
     private:
+        void GetIndex(uint64_t hash, const size_t &numBlocks, size_t &index, size_t &block_ind, size_t &bucket_ind);
+
+        /** A pair to bulk load together with the slot in its block where probing starts. */
+        using BulkLoadSlot = std::pair<slot_offset_t, const MappingType *>;
+
+        /** BulkLoad sizes the table so that at most 1 / BULK_LOAD_SLOTS_PER_ENTRY of the slots are in use. */
+        static constexpr size_t BULK_LOAD_SLOTS_PER_ENTRY = 2;
+
+        /** Remove compacts the table once more than this fraction of its slots are tombstones. */
+        static constexpr double COMPACTION_TOMBSTONE_RATIO = 0.25;
+
+        /**
+         * Allocates num_buckets empty block pages and the header pages that reference them. A single header page is
+         * used while it can hold every block page id; beyond that, header pages are stacked into a tree.
+         * @param num_buckets number of block pages
+         * @return the directory of the new table, not yet published
+         */
+        HashTableDirectory *AllocateTable(size_t num_buckets);
+
+        /**
+         * Replaces the table with a new one of num_buckets block pages and rehashes every entry into it.
+         * The caller must hold table_latch_ in write mode.
+         */
+        void GrowTo(size_t num_buckets);
+
+        /**
+         * Inserts every slot into one block page, probing linearly from its starting slot.
+         * @param block_page_id the block page to fill
+         * @param slots the pairs to insert and the slot to start probing from
+         * @param[out] carry pairs that found no free slot before the end of the block, to continue in the next block
+         * @return the number of pairs that were inserted
+         */
+        size_t FillBlock(page_id_t block_page_id, const std::vector<BulkLoadSlot> &slots,
+                         std::vector<BulkLoadSlot> *carry);
+
+        /** @return the number of readable entries in the table described by directory */
+        size_t CountEntries(const HashTableDirectory &directory);
+
+        /**
+         * Inserts a key-value pair into a table that is still private to Resize. No latches are taken.
+         */
+        void ReinsertForResize(HashTableDirectory *directory, const KeyType &key, const ValueType &value);
+
         // member variable
-        page_id_t header_page_id_;
+        // Directory of the current table. Replaced by Resize, and freed once no lookup can still be reading it.
+        std::atomic<const HashTableDirectory *> directory_;
         BufferPoolManager *buffer_pool_manager_;
         KeyComparator comparator_;
 
-        // Readers includes inserts and removes, writer is only resize
+        // Tombstones left by Remove and not reused by an insert since the table was last rebuilt.
+        std::atomic<size_t> num_tombstones_{0};
+
+        // Readers includes inserts and removes, writer is only resize. Lookups do not take this latch.
         ReaderWriterLatch table_latch_;
 
+        // Protects the directory, header and block pages that lock-free lookups may still be reading across a resize.
+        EpochManager epoch_manager_;
+
         // Hash function
         HashFunction<KeyType> hash_fn_;
     };
@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.h
+//
+// Identification: src/include/execution/compiled_predicate.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * CompiledPredicate is a predicate lowered once, when an executor is initialized, into a flat program of
+ * type-specialized kernels such as "INTEGER column < constant", which are instantiated from templates. The kernels
+ * read fixed-width values straight from the tuple data, or from the columns of a batch, without any virtual call,
+ * Value construction or type dispatch per row. On a batch, whether of Values or of tuples, comparisons with a
+ * constant run on SimdFilter.
+ *
+ * A row passes if every kernel of the program passes. Unlike in the interpreter, a comparison with null never
+ * passes, which is also how TupleBatch::Filter treats a null result.
+ */
+class CompiledPredicate {
+ public:
+  /**
+   * Lowers a predicate, if every expression and type in it has a kernel.
+   * @param predicate the predicate to compile
+   * @param schema the schema of the tuples or of the batch the predicate is evaluated on; for a join predicate, that
+   * of the left side
+   * @param right_schema for a join predicate, the schema of the right side, whose columns have tuple index 1
+   * @return the compiled predicate, or nullptr if the predicate has to be interpreted
+   */
+  static std::unique_ptr<CompiledPredicate> Compile(const AbstractExpression *predicate, const Schema *schema,
+                                                    const Schema *right_schema = nullptr);
+
+  /**
+   * @param tuple a tuple laid out as the schema the predicate was compiled for, e.g. a view of a table page
+   * @return true if the tuple passes
+   */
+  bool Evaluate(const Tuple &tuple) const {
+    for (const auto &kernel : program_) {
+      if (!kernel.row_fn_(kernel, tuple.GetData())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Narrows the selection of a batch to the rows that pass.
+   * @param batch rows laid out as the schema the predicate was compiled for
+   */
+  void Filter(TupleBatch *batch) const { Filter(batch, *batch); }
+
+  /**
+   * Narrows a selection of tuples to those that pass. For a comparison with a constant, the column is gathered from
+   * the data of the selected tuples into a contiguous array, which SimdFilter compares with the constant.
+   * @param tuples the data of tuples laid out as the schema the predicate was compiled for
+   * @param[in,out] selection indexes into tuples, in increasing order
+   */
+  void Filter(const char *const *tuples, std::vector<uint32_t> *selection) const {
+    for (const auto &kernel : program_) {
+      kernel.tuples_fn_(kernel, tuples, selection);
+    }
+  }
+
+  /**
+   * Narrows the selection of the left rows of candidate join pairs to the pairs that pass.
+   * @param left the left rows of the pairs
+   * @param right the right rows of the pairs: row i of left is paired with row i of right
+   */
+  void Filter(TupleBatch *left, const TupleBatch &right) const {
+    for (const auto &kernel : program_) {
+      kernel.batch_fn_(kernel, left, right);
+    }
+  }
+
+  /** A column that a kernel reads. */
+  struct Operand {
+    /** 0 for the left side, 1 for the right side of a join. */
+    uint32_t tuple_idx_;
+    uint32_t col_idx_;
+    /** Offset of the column in the tuple data. */
+    uint32_t offset_;
+  };
+
+  /** One comparison, specialized for the types of its operands. */
+  struct Kernel {
+    bool (*row_fn_)(const Kernel &kernel, const char *data);
+    void (*batch_fn_)(const Kernel &kernel, TupleBatch *left, const TupleBatch &right);
+    void (*tuples_fn_)(const Kernel &kernel, const char *const *tuples, std::vector<uint32_t> *selection);
+    Operand lhs_;
+    Operand rhs_;
+    ComparisonType comp_type_;
+    /** The constant the column is compared with, as the type the comparison is made in. */
+    int64_t int_constant_;
+    double decimal_constant_;
+  };
+
+ private:
+  CompiledPredicate() = default;
+
+  std::vector<Kernel> program_;
+};
+
+}  // namespace bustub
@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <limits>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "catalog/simple_catalog.h"
 #include "concurrency/transaction.h"
+#include "execution/worker_pool.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
@@ -31,9 +33,19 @@ class ExecutorContext {
    * @param transaction the transaction executing the query
    * @param catalog the catalog that the executor should use
    * @param bpm the buffer pool manager that the executor should use
+   * @param worker_pool the workers that parallel pipelines run on, or nullptr to run everything on the calling thread
+   * @param memory_budget the number of bytes each executor may hold in memory before spilling to temporary pages
    */
-  ExecutorContext(Transaction *transaction, SimpleCatalog *catalog, BufferPoolManager *bpm)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm} {}
+  ExecutorContext(Transaction *transaction, SimpleCatalog *catalog, BufferPoolManager *bpm,
+                  WorkerPool *worker_pool = nullptr, size_t memory_budget = UNLIMITED_MEMORY_BUDGET)
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        worker_pool_{worker_pool},
+        memory_budget_{memory_budget} {}
+
+  /** Memory budget of a context that never spills. */
+  static constexpr size_t UNLIMITED_MEMORY_BUDGET = std::numeric_limits<size_t>::max();
 
   DISALLOW_COPY_AND_MOVE(ExecutorContext);
 
@@ -48,6 +60,12 @@ class ExecutorContext {
   /** @return the buffer pool manager */
   BufferPoolManager *GetBufferPoolManager() { return bpm_; }
 
+  /** @return the worker pool, or nullptr if the query runs single-threaded */
+  WorkerPool *GetWorkerPool() { return worker_pool_; }
+
+  /** @return the number of bytes each executor may hold in memory before spilling */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
   /** @return the log manager - don't worry about it for now */
   LogManager *GetLogManager() { return nullptr; }
 
@@ -58,6 +76,8 @@ class ExecutorContext {
   Transaction *transaction_;
   SimpleCatalog *catalog_;
   BufferPoolManager *bpm_;
+  WorkerPool *worker_pool_;
+  size_t memory_budget_;
 };
 
 }  // namespace bustub
@@ -15,6 +15,7 @@
 #include <memory>
 
 #include "execution/executors/abstract_executor.h"
+#include "execution/morsel_queue.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
@@ -30,5 +31,41 @@ class ExecutorFactory {
    * @return an executor for the given plan and context
    */
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
+
+  /**
+   * Creates an executor that runs the executor tree of a plan in push-based execution (see PipelineExecutor). It
+   * produces the same tuples as the executor created by CreateExecutor.
+   * @param exec_ctx the executor context for the created executor
+   * @param plan the plan node that needs to be executed
+   * @return an executor for the given plan and context
+   */
+  static std::unique_ptr<AbstractExecutor> CreatePushExecutor(ExecutorContext *exec_ctx,
+                                                              const AbstractPlanNode *plan);
+
+  /**
+   * A parallel pipeline is a plan that can run as several independent instances, each of which scans the morsels it
+   * claims from a shared MorselQueue. Currently this is a sequential scan, together with its predicate.
+   * @param plan the plan node
+   * @return true if the plan can be executed by CreatePipelineExecutor
+   */
+  static bool IsParallelPipeline(const AbstractPlanNode *plan);
+
+  /**
+   * Creates one instance of a parallel pipeline. Every worker creates its own instance over the same morsels.
+   * @param exec_ctx the executor context for the created executor
+   * @param plan the plan node, for which IsParallelPipeline must be true
+   * @param morsels the morsels of the table scanned by the pipeline, shared by all instances
+   * @return an executor that produces the results of the plan on the morsels it claims
+   */
+  static std::unique_ptr<AbstractExecutor> CreatePipelineExecutor(ExecutorContext *exec_ctx,
+                                                                  const AbstractPlanNode *plan, MorselQueue *morsels);
+
+  /**
+   * Creates the morsels for a parallel pipeline.
+   * @param exec_ctx the executor context
+   * @param plan the plan node, for which IsParallelPipeline must be true
+   * @return a queue over the table that the pipeline scans
+   */
+  static std::unique_ptr<MorselQueue> CreateMorselQueue(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
 };
 }  // namespace bustub
@@ -12,12 +12,36 @@
 
 #pragma once
 
+#include <vector>
+
 #include "execution/executor_context.h"
+#include "execution/runtime_filter.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
- * AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
+ * BatchConsumer receives the batches that are pushed along a pipeline in push-based execution.
+ */
+class BatchConsumer {
+ public:
+  virtual ~BatchConsumer() = default;
+
+  /**
+   * Consumes a batch.
+   * @param batch the batch, which the consumer may modify or move from
+   */
+  virtual void Consume(TupleBatch *batch) = 0;
+};
+
+/**
+ * AbstractExecutor implements the Volcano tuple-at-a-time iterator model, as well as a vectorized model in which
+ * executors exchange batches of up to TupleBatch::BATCH_SIZE rows. A consumer uses either Next() or NextBatch() on a
+ * given executor, never both.
+ *
+ * Executors may also support push-based execution, in which their inputs are pushed into them instead of pulled
+ * (see PipelineExecutor). An executor is then initialized with InitPush() instead of Init(), and its output is still
+ * read through NextBatch() once all of its pipeline breaker inputs are finished.
  */
 class AbstractExecutor {
  public:
@@ -43,6 +67,61 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple) = 0;
 
+  /**
+   * Produces the next batch of tuples from this executor. The columns of the batch are laid out as in
+   * GetOutputSchema(). The default implementation adapts Next(); executors override it to work on whole batches.
+   * @param[out] batch the next batch produced by this executor, with at least one selected row
+   * @return true if a batch was produced, false if there are no more tuples
+   */
+  virtual bool NextBatch(TupleBatch *batch) {
+    batch->Reset(GetOutputSchema()->GetColumnCount());
+    Tuple tuple;
+    while (!batch->IsFull() && Next(&tuple)) {
+      batch->AppendTuple(tuple, GetOutputSchema());
+    }
+    return !batch->IsEmpty();
+  }
+
+  /**
+   * Offers a runtime filter on the output of this executor, e.g. from the hash join that consumes it. Applying it
+   * is optional: executors that can drop tuples early use it, all others ignore it.
+   * @param filter the filter, or nullptr to stop filtering; it must stay alive while this executor produces tuples
+   * @return true if the executor applies the filter
+   */
+  virtual bool PushRuntimeFilter(const RuntimeFilter *filter) { return false; }
+
+  /**
+   * @return the children whose output is pushed into this executor in push-based execution, in the order in which
+   * they must be finished. An executor without push inputs runs in pull mode, with its whole subtree, as the source
+   * of a pipeline.
+   */
+  virtual std::vector<AbstractExecutor *> GetPushInputs() { return {}; }
+
+  /**
+   * @param input_idx the index of a push input
+   * @return true if the input is a pipeline breaker, which is consumed entirely before this executor produces
+   * anything; otherwise this executor streams the results of every batch of the input on to a consumer
+   */
+  virtual bool IsPipelineBreaker(uint32_t input_idx) { return true; }
+
+  /** Initializes this executor for push-based execution. Unlike Init(), this leaves the push inputs alone. */
+  virtual void InitPush() {}
+
+  /**
+   * Consumes a batch of a push input.
+   * @param input_idx the index of the push input
+   * @param batch the batch, which may be modified or moved from
+   * @param consumer the consumer that a streamed input passes its results on to, or nullptr for a pipeline breaker
+   */
+  virtual void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) {}
+
+  /**
+   * Called after the last batch of a push input was pushed.
+   * @param input_idx the index of the push input
+   * @param consumer as in Push()
+   */
+  virtual void FinishPush(uint32_t input_idx, BatchConsumer *consumer) {}
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
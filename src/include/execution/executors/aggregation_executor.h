@@ -22,7 +22,9 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/fixed_width_aggregation_hash_table.h"
 #include "execution/plans/aggregation_plan.h"
+#include "storage/table/tmp_tuple_heap.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
@@ -97,12 +99,79 @@ class SimpleAggregationHashTable {
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht.count(agg_key) == 0) {
-      ht.insert({agg_key, GenerateInitialAggregateValue()});
+    // A null key never equals itself, so the group is looked up once and kept by iterator.
+    auto iter = ht.find(agg_key);
+    if (iter == ht.end()) {
+      iter = ht.insert({agg_key, GenerateInitialAggregateValue()}).first;
     }
-    CombineAggregateValues(&ht[agg_key], agg_val);
+    CombineAggregateValues(&iter->second, agg_val);
   }
 
+  /**
+   * Merges the groups of another table, built over different tuples with the same aggregates, into this one.
+   * @param other the table to merge, e.g. the thread-local table of a worker
+   */
+  void Merge(const SimpleAggregationHashTable &other) {
+    for (const auto &entry : other.ht) {
+      MergeGroup(entry.first, entry.second);
+    }
+  }
+
+  /**
+   * Merges one partially aggregated group, e.g. read back from a spilled partition, into the hash table.
+   * @param agg_key the key of the group
+   * @param partial the aggregates of the group over some of its tuples
+   */
+  void MergeGroup(const AggregateKey &agg_key, const AggregateValue &partial) {
+    auto iter = ht.find(agg_key);
+    if (iter == ht.end()) {
+      ht.insert({agg_key, partial});
+      return;
+    }
+    auto &result = iter->second;
+    for (uint32_t i = 0; i < agg_types_.size(); i++) {
+      switch (agg_types_[i]) {
+        case AggregationType::CountAggregate:
+        case AggregationType::SumAggregate:
+          // Partial counts and sums add up.
+          result.aggregates_[i] = result.aggregates_[i].Add(partial.aggregates_[i]);
+          break;
+        case AggregationType::MinAggregate:
+          result.aggregates_[i] = result.aggregates_[i].Min(partial.aggregates_[i]);
+          break;
+        case AggregationType::MaxAggregate:
+          result.aggregates_[i] = result.aggregates_[i].Max(partial.aggregates_[i]);
+          break;
+      }
+    }
+  }
+
+  /**
+   * Moves every group into one of several tables by the hash of its key, and leaves this table empty.
+   * @param parts the tables to move the groups into
+   */
+  void SplitInto(const std::vector<std::unique_ptr<SimpleAggregationHashTable>> &parts) {
+    for (const auto &entry : ht) {
+      parts[std::hash<AggregateKey>{}(entry.first) % parts.size()]->ht.insert(entry);
+    }
+    ht.clear();
+  }
+
+  /**
+   * Replaces the groups of this table with those of another table with the same aggregates.
+   * @param other the table to take the groups from; it is left empty
+   */
+  void MoveFrom(SimpleAggregationHashTable *other) {
+    ht = std::move(other->ht);
+    other->ht.clear();
+  }
+
+  /** @return the number of groups */
+  size_t Size() const { return ht.size(); }
+
+  /** Removes all groups. */
+  void Clear() { ht.clear(); }
+
   /**
    * An iterator through the simplified aggregation hash table.
    */
@@ -168,10 +237,33 @@ class AggregationExecutor : public AbstractExecutor {
 
   const Schema *GetOutputSchema() override;
 
+  /**
+   * Builds the aggregation hash table. If the executor context has a worker pool and the child plan is a parallel
+   * pipeline, the aggregation runs in two parallel phases, see ParallelBuild(). The child executor is not used in
+   * that case.
+   *
+   * Otherwise, whenever the groups outgrow the memory budget of the executor context, they are spilled as partial
+   * aggregates to temporary pages, partitioned by the hash of their keys, and aggregation starts over with an empty
+   * table. The partitions are then re-aggregated one at a time while the groups are produced; a partition that
+   * still exceeds the budget is partitioned again on the next bits of the hashes.
+   */
   void Init() override;
 
   bool Next(Tuple *tuple) override;
 
+  /** Produces the groups that pass the having clause, up to TupleBatch::BATCH_SIZE at a time. */
+  bool NextBatch(TupleBatch *batch) override;
+
+  std::vector<AbstractExecutor *> GetPushInputs() override { return {child_.get()}; }
+
+  /** Prepares a serial build; the worker pool is not used in push-based execution. */
+  void InitPush() override;
+
+  /** Aggregates a batch of the child, spilling groups as in Init(). */
+  void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) override;
+
+  void FinishPush(uint32_t input_idx, BatchConsumer *consumer) override;
+
   /** @return the tuple as an AggregateKey */
   AggregateKey MakeKey(const Tuple *tuple) {
     std::vector<Value> keys;
@@ -199,5 +291,127 @@ class AggregationExecutor : public AbstractExecutor {
   SimpleAggregationHashTable aht_;
   /** Simple aggregation hash table iterator. */
   SimpleAggregationHashTable::Iterator aht_iterator_;
+
+  /** What a build keeps from one batch to the next. */
+  struct BuildState {
+    explicit BuildState(const AggregationPlanNode *plan);
+
+    /** The group bys and the aggregates of the current batch, by expression and then by physical row. */
+    std::vector<const std::vector<Value> *> group_bys_;
+    std::vector<const std::vector<Value> *> aggregates_;
+    /** Where the group bys and the aggregates that are not columns of the batch are computed. */
+    std::vector<std::vector<Value>> group_by_scratch_;
+    std::vector<std::vector<Value>> aggregate_scratch_;
+    AggregateKey key_;
+    AggregateValue value_;
+    /** Integer-only aggregations run on unboxed values in a typed table, or nullptr. */
+    std::unique_ptr<FixedWidthAggregationHashTable> typed_aht_;
+    /** The rows of the current batch that the typed table left out because of a null key. */
+    std::vector<uint32_t> null_key_rows_;
+  };
+
+  /**
+   * Aggregates all tuples of an executor into a hash table.
+   * @param child the executor to drain, batch by batch
+   * @param aht the table to aggregate into
+   * @param memory_budget the number of bytes the table may hold before its groups are spilled
+   * @param spill_heaps the partitions to spill to, created on the first spill
+   */
+  void BuildFrom(AbstractExecutor *child, SimpleAggregationHashTable *aht, size_t memory_budget,
+                 std::vector<std::unique_ptr<TmpTupleHeap>> *spill_heaps);
+
+  /** Aggregates the selected rows of a batch into a hash table, see BuildFrom(). */
+  void AggregateBatch(const TupleBatch &batch, SimpleAggregationHashTable *aht, size_t memory_budget,
+                      std::vector<std::unique_ptr<TmpTupleHeap>> *spill_heaps, BuildState *state);
+
+  /** Moves the groups that are left in the typed table of a build into the hash table. */
+  void FlushTyped(SimpleAggregationHashTable *aht, BuildState *state);
+
+  /** Once a serial build is over, spills the rest of aht_ too if it has spilled, and loads the first partition. */
+  void FinishSpilling();
+
+  /**
+   * Aggregates the child plan on the worker pool. In the first phase, every worker pre-aggregates the morsels it
+   * claims into a thread-local table, and splits that table into PARTITIONS_PER_WORKER partitions per worker by the
+   * hashes of the group keys. In the second phase, the workers claim partitions and merge the thread-local tables
+   * of each into one table per partition. The merged partitions are then produced one after the other, so the
+   * having clause and the output columns are evaluated on fully merged groups only.
+   *
+   * Every worker gets an equal share of the memory budget. If a thread-local table outgrows its share, its groups are
+   * spilled to partitions of the worker, as in a serial build. Once any worker has spilled, all groups are spilled
+   * instead of merged, and the partitions are re-aggregated one at a time from the spills of all workers.
+   */
+  void ParallelBuild(WorkerPool *worker_pool);
+
+  /** A spilled partition of partially aggregated groups. */
+  struct SpillPartition {
+    /** The groups, in one heap per worker that spilled them in a parallel build, or in a single heap. */
+    std::vector<std::unique_ptr<TmpTupleHeap>> groups_;
+    /** The partitioning that produced this partition, which selects the hash bits of the next one. */
+    size_t level_{0};
+  };
+
+  /** Creates SPILL_FANOUT empty partitions. */
+  std::vector<std::unique_ptr<TmpTupleHeap>> CreateSpillHeaps();
+
+  /**
+   * Appends every group of a hash table as a partial aggregate to the partition of its key hash, and empties the
+   * table.
+   */
+  void SpillGroups(SimpleAggregationHashTable *aht, size_t level, std::vector<std::unique_ptr<TmpTupleHeap>> *heaps);
+
+  /**
+   * @return the layout of a spilled group, with the types of the group bys and of the aggregate results of a plan
+   */
+  static std::unique_ptr<Schema> MakeSpillSchema(const AggregationPlanNode *plan);
+
+  /** Splits a spilled group tuple back into its key and partial aggregates. */
+  void ReadGroup(const Tuple &tuple, AggregateKey *key, AggregateValue *value);
+
+  /**
+   * Moves the next merged partition of a parallel build into aht_, or re-aggregates the next pending spilled
+   * partition into aht_, partitioning again any spilled partition that does not fit in the memory budget.
+   * @return false if no partition is left
+   */
+  bool LoadNextPartition();
+
+  /** @return the number of bytes a group is charged against the memory budget */
+  size_t GroupFootprint() const {
+    return (plan_->GetGroupBys().size() + plan_->GetAggregates().size()) * sizeof(Value) + sizeof(AggregateKey) +
+           sizeof(AggregateValue) + GROUP_OVERHEAD;
+  }
+
+  /** @return the partition of a key hash */
+  static size_t SpillPartitionOf(size_t hash, size_t level) {
+    return (hash >> (level * SPILL_PARTITION_BITS)) & (SPILL_FANOUT - 1);
+  }
+
+  /** A parallel build merges groups in this many partitions per worker. */
+  static constexpr size_t PARTITIONS_PER_WORKER = 4;
+  /** Bytes of hash table bookkeeping charged per group, on top of its keys and aggregates. */
+  static constexpr size_t GROUP_OVERHEAD = 32;
+  /** Spilled groups are split on this many bits of the key hashes at a time. */
+  static constexpr size_t SPILL_PARTITION_BITS = 4;
+  static constexpr size_t SPILL_FANOUT = size_t{1} << SPILL_PARTITION_BITS;
+  /** A partition is split at most this many times before it is re-aggregated regardless of the budget. */
+  static constexpr size_t MAX_SPILL_LEVEL = 8;
+
+  /** Merged partitions of a parallel build that are still to be produced. */
+  std::vector<std::unique_ptr<SimpleAggregationHashTable>> merged_partitions_;
+  /** Partitions the build phase spills to, or empty if it has not spilled. */
+  std::vector<std::unique_ptr<TmpTupleHeap>> spill_heaps_;
+  /** Spilled partitions that are still to be re-aggregated. */
+  std::vector<SpillPartition> spill_partitions_;
+  /** Layout of a spilled group: the group bys followed by the partial aggregates. */
+  std::unique_ptr<Schema> spill_schema_;
+  /** The build that the child pushes into, in push-based execution. */
+  std::unique_ptr<BuildState> push_state_;
+
+  /**
+   * Moves the iterator to the next group that passes the having clause and evaluates the output columns on it.
+   * @param[out] out_values the output values of the group
+   * @return false if there are no more groups
+   */
+  bool NextGroup(std::vector<Value> *out_values);
 };
 }  // namespace bustub
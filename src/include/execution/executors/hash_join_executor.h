@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -21,12 +23,16 @@
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
 #include "container/hash/linear_probe_hash_table.h"
+#include "execution/compiled_predicate.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/runtime_filter.h"
+#include "execution/worker_pool.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/hash_join_plan.h"
 #include "storage/index/hash_comparator.h"
 #include "storage/table/tmp_tuple.h"
+#include "storage/table/tmp_tuple_heap.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -45,12 +51,52 @@ class IdentityHashFunction : public HashFunction<hash_t> {
 
 /**
  * A simple hash table that supports hash joins.
+ *
+ * The build tuples are serialized back to back into a single arena, and the table itself is an open-addressing
+ * directory of (hash key, arena offset) entries with linear probing. Lookups walk the directory from the home slot of
+ * the hash key and hand out the matching tuples as views into the arena, so probing neither allocates nor copies.
  */
 class SimpleHashJoinHashTable {
+  /** A directory slot: the hash key of a tuple and the offset of the tuple in the arena. */
+  struct Entry {
+    hash_t hash_;
+    size_t offset_;
+  };
+
  public:
   /** Creates a new simple hash join hash table. */
   SimpleHashJoinHashTable(const std::string &name, BufferPoolManager *bpm, HashComparator cmp, uint32_t buckets,
-                          const IdentityHashFunction &hash_fn) {}
+                          const IdentityHashFunction &hash_fn) {
+    Clear();
+  }
+
+  /**
+   * MatchIterator walks the tuples of one hash key. The tuples it returns point into the hash table, and are only
+   * valid until the next insert.
+   */
+  class MatchIterator {
+   public:
+    /** @return the current tuple, a view into the arena */
+    Tuple operator*() const { return table_->TupleAt(table_->directory_[slot_].offset_); }
+
+    /** Advances to the next tuple with the same hash key. */
+    MatchIterator &operator++() {
+      slot_ = table_->FindSlot(hash_, (slot_ + 1) & table_->mask_);
+      return *this;
+    }
+
+    bool operator==(const MatchIterator &other) const { return slot_ == other.slot_; }
+    bool operator!=(const MatchIterator &other) const { return slot_ != other.slot_; }
+
+   private:
+    friend class SimpleHashJoinHashTable;
+    MatchIterator(const SimpleHashJoinHashTable *table, hash_t hash, size_t slot)
+        : table_(table), hash_(hash), slot_(slot) {}
+
+    const SimpleHashJoinHashTable *table_;
+    hash_t hash_;
+    size_t slot_;
+  };
 
   /**
    * Inserts a (hash key, tuple) pair into the hash table.
@@ -60,20 +106,134 @@ class SimpleHashJoinHashTable {
    * @return true if the insert succeeded
    */
   bool Insert(Transaction *txn, hash_t h, const Tuple &t) {
-    hash_table_[h].emplace_back(t);
+    if ((num_entries_ + 1) * MAX_LOAD_FACTOR_INVERSE > directory_.size()) {
+      Grow();
+    }
+    size_t offset = arena_.size();
+    arena_.resize(offset + sizeof(uint32_t) + t.GetLength());
+    t.SerializeTo(&arena_[offset]);
+    Place(h, offset);
     return true;
   }
 
+  /**
+   * @param h the hash key
+   * @return an iterator to the first tuple that matches the hash key
+   */
+  MatchIterator BeginMatches(hash_t h) const { return MatchIterator(this, h, FindSlot(h, HomeSlot(h))); }
+
+  /** @return the iterator past the last match of any hash key */
+  MatchIterator EndMatches() const { return MatchIterator(this, 0, directory_.size()); }
+
   /**
    * Gets the values in the hash table that match the given hash key.
    * @param txn the transaction that we execute in
    * @param h the hash key
-   * @param[out] t the list of tuples that matched the key
+   * @param[out] t the list of tuples that matched the key, as views that are valid until the next insert
    */
-  void GetValue(Transaction *txn, hash_t h, std::vector<Tuple> *t) { *t = hash_table_[h]; }
+  void GetValue(Transaction *txn, hash_t h, std::vector<Tuple> *t) {
+    t->clear();
+    for (auto it = BeginMatches(h); it != EndMatches(); ++it) {
+      t->push_back(*it);
+    }
+  }
+
+  /**
+   * Copies all entries of another hash table into this one.
+   * @param other the table to merge, e.g. the thread-local table of a worker; it is left empty
+   */
+  void Merge(SimpleHashJoinHashTable *other) {
+    other->ForEach([this](hash_t hash, const Tuple &tuple) { Insert(nullptr, hash, tuple); });
+    other->Clear();
+  }
+
+  /**
+   * Calls func(h, t) on every (hash key, tuple) pair of the hash table.
+   */
+  template <typename Func>
+  void ForEach(Func &&func) const {
+    for (const auto &entry : directory_) {
+      if (entry.offset_ != EMPTY_OFFSET) {
+        func(entry.hash_, TupleAt(entry.offset_));
+      }
+    }
+  }
+
+  /** Removes all entries. */
+  void Clear() {
+    arena_.clear();
+    directory_.assign(INITIAL_DIRECTORY_SIZE, Entry{0, EMPTY_OFFSET});
+    mask_ = INITIAL_DIRECTORY_SIZE - 1;
+    num_entries_ = 0;
+  }
+
+  /** @return the number of tuples in the hash table */
+  size_t Size() const { return num_entries_; }
+
+  /** @return the number of bytes a tuple of the given length takes in the hash table, directory included */
+  static size_t Footprint(size_t tuple_length) {
+    return sizeof(uint32_t) + tuple_length + MAX_LOAD_FACTOR_INVERSE * sizeof(Entry);
+  }
 
  private:
-  std::unordered_map<hash_t, std::vector<Tuple>> hash_table_;
+  /** Marks an empty directory slot. */
+  static constexpr size_t EMPTY_OFFSET = std::numeric_limits<size_t>::max();
+  static constexpr size_t INITIAL_DIRECTORY_SIZE = 64;
+  /** The directory is kept at most half full. */
+  static constexpr size_t MAX_LOAD_FACTOR_INVERSE = 2;
+
+  /**
+   * Picks the home slot from the high bits of a multiplicative hash, since the low bits of the keys of one partition
+   * of a partitioned join are all the same.
+   */
+  size_t HomeSlot(hash_t h) const { return static_cast<size_t>((h * 0x9E3779B97F4A7C15ULL) >> 32) & mask_; }
+
+  /** @return a view of the tuple at the given offset of the arena */
+  Tuple TupleAt(size_t offset) const {
+    const char *data = &arena_[offset];
+    return Tuple(const_cast<char *>(data + sizeof(uint32_t)), *reinterpret_cast<const uint32_t *>(data));
+  }
+
+  /** @return the first slot from slot on that holds hash key h, or directory_.size() if an empty slot comes first */
+  size_t FindSlot(hash_t h, size_t slot) const {
+    while (directory_[slot].offset_ != EMPTY_OFFSET) {
+      if (directory_[slot].hash_ == h) {
+        return slot;
+      }
+      slot = (slot + 1) & mask_;
+    }
+    return directory_.size();
+  }
+
+  /** Puts an entry into the first empty slot of its probe sequence. */
+  void Place(hash_t h, size_t offset) {
+    size_t slot = HomeSlot(h);
+    while (directory_[slot].offset_ != EMPTY_OFFSET) {
+      slot = (slot + 1) & mask_;
+    }
+    directory_[slot] = Entry{h, offset};
+    num_entries_++;
+  }
+
+  /** Doubles the directory. The arena does not move. */
+  void Grow() {
+    std::vector<Entry> old_directory(directory_.size() * 2, Entry{0, EMPTY_OFFSET});
+    old_directory.swap(directory_);
+    mask_ = directory_.size() - 1;
+    num_entries_ = 0;
+    for (const auto &entry : old_directory) {
+      if (entry.offset_ != EMPTY_OFFSET) {
+        Place(entry.hash_, entry.offset_);
+      }
+    }
+  }
+
+  /** The serialized build tuples, each as its length followed by its data. */
+  std::vector<char> arena_;
+  /** Open-addressing directory over the arena; its size is a power of two. */
+  std::vector<Entry> directory_;
+  size_t mask_{0};
+  size_t num_entries_{0};
 };
 
 // TODO(student): when you are ready to attempt task 3, replace the using declaration!
@@ -103,10 +263,48 @@ class HashJoinExecutor : public AbstractExecutor {
 
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
+  /**
+   * Builds the hash table from the left child. If the executor context has a worker pool, the join runs as a
+   * radix-partitioned join instead, see PartitionedJoin(), as long as both sides fit in the memory budget of the
+   * executor context. Next() and NextBatch() then join a few partitions at a time on the workers.
+   *
+   * Otherwise, or if the partitioned join gave up on the budget, the join runs serially. If the build side then
+   * outgrows the memory budget, the join turns into a Grace hash join: both sides are partitioned into temporary pages
+   * by their key hashes, and the partitions are then joined one at a time. A partition whose build side still exceeds
+   * the budget is partitioned again on the next bits of the hashes.
+   *
+   * Whenever the build side is known before the right child is read, a RuntimeFilter over the build keys is pushed
+   * into the right child, so that it can drop tuples without a match before they are hashed and probed here.
+   */
   void Init() override;
 
   bool Next(Tuple *tuple) override;
 
+  /**
+   * Probes the hash table with a whole batch of right tuples at a time. Candidate (left, right) pairs are gathered
+   * into a pair of batches, on which the join predicate and the output expressions are then evaluated.
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return the number of output batches of the partitioned join that are buffered for NextBatch() */
+  size_t NumBufferedBatches() const { return results_.size() - result_idx_; }
+
+  /** The left child builds the hash table, and the right child is streamed through it. */
+  std::vector<AbstractExecutor *> GetPushInputs() override { return {left_.get(), right_.get()}; }
+
+  bool IsPipelineBreaker(uint32_t input_idx) override { return input_idx == 0; }
+
+  /** Prepares a serial join; the worker pool is not used in push-based execution. */
+  void InitPush() override;
+
+  /**
+   * Inserts a left batch into the hash table, or probes it with a right batch and passes the joined rows on. Once the
+   * build side exceeds the memory budget, both sides are spilled instead, and joined when the right side finishes.
+   */
+  void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) override;
+
+  void FinishPush(uint32_t input_idx, BatchConsumer *consumer) override;
+
   /**
    * Hashes a tuple by evaluating it against every expression on the given schema, combining all non-null hashes.
    * @param tuple tuple to be hashed
@@ -129,7 +327,196 @@ class HashJoinExecutor : public AbstractExecutor {
     return curr_hash;
   }
 
+  /**
+   * Hashes every selected row of a batch, combining all non-null hashes as in HashValues.
+   * @param batch batch to be hashed
+   * @param exprs expressions to evaluate the batch with
+   * @param[out] hashes the hashes, indexed by physical row
+   */
+  void HashBatch(const TupleBatch &batch, const std::vector<const AbstractExpression *> &exprs,
+                 std::vector<hash_t> *hashes) {
+    hashes->assign(batch.NumRows(), 0);
+    std::vector<Value> scratch;
+    for (const auto &expr : exprs) {
+      const auto &vals = expr->EvaluateBatchView(batch, &scratch);
+      for (uint32_t row_idx : batch.GetSelection()) {
+        if (!vals[row_idx].IsNull()) {
+          (*hashes)[row_idx] = HashUtil::CombineHashes((*hashes)[row_idx], HashUtil::HashValue(&vals[row_idx]));
+        }
+      }
+    }
+  }
+
  private:
+  /**
+   * Inserts all tuples of an executor into a hash table, or stops early once they exceed a memory budget.
+   * @param child the executor to drain, batch by batch
+   * @param jht the table to insert into
+   * @param memory_budget the number of bytes the table may hold
+   * @return false if the build stopped on the memory budget, in which case child is not drained yet
+   */
+  bool BuildFrom(AbstractExecutor *child, HT *jht, size_t memory_budget);
+
+  /** Inserts the selected rows of a batch into a hash table, and returns how many bytes they take. */
+  size_t InsertBatch(const TupleBatch &batch, const Schema *schema, HT *jht);
+
+  /** Both sides of one partition of a spilled join. */
+  struct SpillPartition {
+    std::unique_ptr<TmpTupleHeap> left_;
+    std::unique_ptr<TmpTupleHeap> right_;
+    /** The partitioning that produced this partition, which selects the hash bits of the next one. */
+    size_t level_;
+  };
+
+  /**
+   * Spills everything to SPILL_FANOUT partitions: the build tuples already in jht_ and the rest of both children.
+   */
+  void SpillInputs();
+
+  /** Moves the build tuples in jht_ to new partitions spill_left_, next to empty partitions spill_right_. */
+  void StartSpilling();
+
+  /** Makes the partitions in spill_left_ and spill_right_ pending. */
+  void FinishSpilling();
+
+  /** Sets up the probe phase once the build side is in jht_, pushing a runtime filter into the right child. */
+  void StartProbing();
+
+  /** Creates SPILL_FANOUT empty partitions. */
+  std::vector<std::unique_ptr<TmpTupleHeap>> CreateSpillHeaps();
+
+  /**
+   * Appends the selected rows of a batch to the partitions of their key hashes.
+   * @param batch the rows to spill
+   * @param keys the join keys of the side of the rows
+   * @param schema the schema of the rows
+   * @param level the partitioning, which selects the hash bits
+   * @param heaps the partitions
+   */
+  void SpillBatch(const TupleBatch &batch, const std::vector<const AbstractExpression *> &keys, const Schema *schema,
+                  size_t level, std::vector<std::unique_ptr<TmpTupleHeap>> *heaps);
+
+  /**
+   * Reads the tuples of one spilled page into a batch.
+   * @return false if the page index is past the end of the heap
+   */
+  bool ReadSpilledPage(TmpTupleHeap *heap, size_t page_idx, const Schema *schema, TupleBatch *batch);
+
+  /**
+   * Loads the build side of the next pending partition into jht_ and makes its probe side current, partitioning
+   * again any partition that does not fit in the memory budget.
+   * @return false if no partition is left
+   */
+  bool LoadNextPartition();
+
+  /** Fills right_batch_ with the next right tuples to probe, from the right child or from the spilled partitions. */
+  bool NextProbeBatch();
+
+  /** @return the partition of a key hash in a spilled join */
+  static size_t SpillPartitionOf(hash_t hash, size_t level) {
+    return (hash >> (level * SPILL_PARTITION_BITS)) & (SPILL_FANOUT - 1);
+  }
+
+  /** A tuple together with the hash of its join keys. */
+  using HashedTuple = std::pair<hash_t, Tuple>;
+  /** The tuples of one side of the join, by worker and then by partition. */
+  using PartitionedTuples = std::vector<std::vector<std::vector<HashedTuple>>>;
+
+  /**
+   * Prepares a join of both children on the worker pool. Both sides are split into partitions by the low bits of
+   * their key hashes, each worker scanning its own morsels when the child is a parallel pipeline. There are enough
+   * partitions for the hash table of one partition to stay in cache. The partitions are then joined as the output is
+   * pulled, see JoinNextPartitions().
+   *
+   * Both sides are held in memory, so partitioning stops as soon as they take more than the memory budget. Since the
+   * children are then partly consumed, everything is dropped, and the join has to run serially from the start.
+   * @return false if the partitions did not fit in the memory budget
+   */
+  bool PartitionedJoin(WorkerPool *worker_pool);
+
+  /** Where a worker of the partitioned join stands in the partition it joins, from one JoinNextPartitions() on. */
+  struct PartitionProbe {
+    explicit PartitionProbe(HashJoinExecutor *executor)
+        : part_(executor->num_partitions_),
+          jht_("HashTable", executor->exec_ctx_->GetBufferPoolManager(), executor->jht_comp_,
+               executor->jht_num_buckets_, executor->jht_hash_fn_) {}
+
+    /** The partition being joined, or num_partitions_ if there is none. */
+    size_t part_;
+    /** The hash table over the left tuples of the partition. */
+    HT jht_;
+    /** The next right tuple to probe with, the entry_idx_-th of the partition of the worker_idx_-th worker. */
+    size_t worker_idx_{0};
+    size_t entry_idx_{0};
+    /** The right tuple being probed with, and its matches that are left to pair it with. */
+    const HashedTuple *entry_{nullptr};
+    HT::MatchIterator match_it_{jht_.EndMatches()};
+    HT::MatchIterator match_end_{jht_.EndMatches()};
+  };
+
+  /**
+   * Joins the next pairs of the partitioned join into results_, a batch per worker at most. A worker without a
+   * partition claims the next one, building a hash table over its left tuples, and then probes it with the right tuples
+   * of the same partition until a batch of pairs is full, resuming where it stopped in the next call. The tuples of a
+   * partition are freed once it is joined.
+   * @return false if every partition was already joined
+   */
+  bool JoinNextPartitions(WorkerPool *worker_pool);
+
+  /**
+   * Gathers the next candidate pairs of the partition of a worker, until the pair batches are full.
+   * @return true if the partition is done
+   */
+  bool ProbePartition(PartitionProbe *probe, TupleBatch *left_pairs, TupleBatch *right_pairs);
+
+  /**
+   * Partitions one side of the join, in parallel if its plan is a parallel pipeline.
+   * @param worker_pool the workers to partition on
+   * @param plan the plan of the side
+   * @param child the executor of the side, only used if the plan is not a parallel pipeline
+   * @param keys the join keys of the side
+   * @param filter a runtime filter to push into the executors of the side, or nullptr
+   * @param memory_used the bytes taken by the partitions of both sides, shared by the workers
+   * @param[out] partitions the hashed tuples, by worker and then by partition
+   * @return false if the partitions outgrew the memory budget, in which case the side is not drained yet
+   */
+  bool PartitionSide(WorkerPool *worker_pool, const AbstractPlanNode *plan, AbstractExecutor *child,
+                     const std::vector<const AbstractExpression *> &keys, const RuntimeFilter *filter,
+                     std::atomic<size_t> *memory_used, PartitionedTuples *partitions);
+
+  /**
+   * Appends the tuples of an executor to the partitions of their key hashes, or stops early once the partitions of
+   * both sides take more than the memory budget.
+   * @return false if it stopped on the memory budget
+   */
+  bool PartitionFrom(AbstractExecutor *child, const std::vector<const AbstractExpression *> &keys,
+                     std::atomic<size_t> *memory_used, std::vector<std::vector<HashedTuple>> *partitions);
+
+  /** @return the partition of a key hash */
+  size_t PartitionOf(hash_t hash) const { return hash & (num_partitions_ - 1); }
+
+  /**
+   * Evaluates the join predicate on candidate pairs and the output expressions on the pairs that pass it.
+   * @param left_pairs the left tuples of the pairs, whose selection is narrowed to the passing pairs
+   * @param right_pairs the right tuples of the pairs
+   * @param[out] batch the output rows
+   * @return false if no pair passes
+   */
+  bool JoinPairs(TupleBatch *left_pairs, const TupleBatch &right_pairs, TupleBatch *batch);
+
+  /** The partitioned join aims for at most this many bytes of build tuples per partition. */
+  static constexpr size_t PARTITION_CACHE_SIZE = 256 * 1024;
+  /** Upper bound on the number of partitions. */
+  static constexpr size_t MAX_PARTITIONS = 1024;
+  /** A spilled join splits its inputs on this many bits of the key hashes at a time. */
+  static constexpr size_t SPILL_PARTITION_BITS = 4;
+  static constexpr size_t SPILL_FANOUT = size_t{1} << SPILL_PARTITION_BITS;
+  /**
+   * A partition is split at most this many times. Beyond that, its build side is loaded in memory regardless of the
+   * budget, since its tuples are likely to share a single key.
+   */
+  static constexpr size_t MAX_SPILL_LEVEL = 8;
+
   /** The hash join plan node. */
   const HashJoinPlanNode *plan_;
   /** The comparator is used to compare hashes. */
@@ -138,10 +525,59 @@ class HashJoinExecutor : public AbstractExecutor {
   IdentityHashFunction jht_hash_fn_{};
 
   std::unique_ptr<AbstractExecutor> left_, right_;
+  /** The predicate, compiled against the left and right schemas, or nullptr if it is interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
   /** The hash table that we are using. */
   HT jht_;
   /** The number of buckets in the hash table. */
   static constexpr uint32_t jht_num_buckets_ = 2;
 
+  /** The batch of right tuples being probed, and their hashes. */
+  TupleBatch right_batch_;
+  std::vector<hash_t> right_hashes_;
+  /** Position of the next right tuple to probe in the selection of right_batch_. */
+  uint32_t right_pos_{0};
+  /** The next left tuple matching the hash of the right tuple being probed, and the end of the matches. */
+  HT::MatchIterator match_it_{jht_.EndMatches()};
+  HT::MatchIterator match_end_{jht_.EndMatches()};
+  /** Candidate pairs: row i of left_pairs_ is joined with row i of right_pairs_. */
+  TupleBatch left_pairs_;
+  TupleBatch right_pairs_;
+
+  /** Filter over the build keys, pushed into the right child. */
+  std::unique_ptr<RuntimeFilter> runtime_filter_;
+
+  /** True in push-based execution, where the right tuples to probe are pushed instead of pulled. */
+  bool push_mode_{false};
+  /** Bytes taken by the build side pushed so far. */
+  size_t build_bytes_{0};
+
+  /** True if the build side did not fit in the memory budget. */
+  bool spilled_{false};
+  /** Both sides, by partition, while they are being spilled. */
+  std::vector<std::unique_ptr<TmpTupleHeap>> spill_left_;
+  std::vector<std::unique_ptr<TmpTupleHeap>> spill_right_;
+  /** Spilled partitions that are still to be joined. */
+  std::vector<SpillPartition> spill_partitions_;
+  /** The probe side of the spilled partition being joined, and the next page of it to probe. */
+  std::unique_ptr<TmpTupleHeap> probe_heap_;
+  size_t probe_page_idx_{0};
+
+  /** True if Init() set up the partitioned join. */
+  bool partitioned_{false};
+  /** The number of partitions of the partitioned join, a power of two. */
+  size_t num_partitions_{1};
+  /** Both sides of the partitioned join, and the first partition that is not joined yet. */
+  PartitionedTuples left_parts_;
+  PartitionedTuples right_parts_;
+  size_t next_partition_{0};
+  /** Where each worker stands in the partition it joins. */
+  std::vector<std::unique_ptr<PartitionProbe>> partition_probes_;
+  /** The output of the last JoinNextPartitions(), and the next batch to return. */
+  std::vector<TupleBatch> results_;
+  size_t result_idx_{0};
+  /** The batch Next() returns tuples from, and the next row of it. */
+  TupleBatch out_batch_;
+  uint32_t result_pos_{0};
 };
 }  // namespace bustub
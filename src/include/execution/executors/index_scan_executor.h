@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// index_scan_executor.h
+//
+// Identification: src/include/execution/executors/index_scan_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/compiled_predicate.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/index_scan_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IndexScanExecutor looks up the RIDs of the tuples that match the key of its plan in a hash index, and fetches only
+ * those tuples from the table heap.
+ */
+class IndexScanExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new index scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the index scan plan to be executed
+   */
+  IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan);
+
+  /** Looks up the key in the index. */
+  void Init() override;
+
+  /** Produces the next matching tuple, projected onto the output schema. */
+  bool Next(Tuple *tuple) override;
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** The index scan plan node to be executed. */
+  const IndexScanPlanNode *plan_;
+  TableHeap *table_heap_;
+  /** The schema of the table, which the predicate and the output expressions refer to. */
+  const Schema *table_schema_;
+  /** The predicate, compiled against the table schema, or nullptr if it is interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** The RIDs that the index returned for the key. */
+  std::vector<RID> rids_;
+  /** The next RID to fetch. */
+  size_t next_rid_{0};
+};
+}  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -44,11 +45,60 @@ class InsertExecutor : public AbstractExecutor {
   // We return false if the insert failed for any reason, and return true if all inserts succeeded.
   bool Next([[maybe_unused]] Tuple *tuple) override;
 
+  /**
+   * Same as Next(): inserts everything and produces no tuples, so the batch is left empty.
+   * Tuples from the child executor are always pulled a batch at a time.
+   * @return true if all inserts succeeded, false otherwise
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** A raw insert has no push input, and inserts its values when it is pulled. */
+  std::vector<AbstractExecutor *> GetPushInputs() override {
+    if (plan_->IsRawInsert()) {
+      return {};
+    }
+    return {child_executor_.get()};
+  }
+
+  void InitPush() override;
+
+  /** Inserts the selected rows of a batch of the child. */
+  void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) override;
+
  private:
+  /** Looks up the table and its indexes. */
+  void OpenTable();
+
+  /**
+   * Inserts the selected rows of a batch of the child executor.
+   * @return false if an insert failed
+   */
+  bool InsertBatch(const TupleBatch &batch);
+
+  /**
+   * Inserts tuples_ into the table and its indexes.
+   * @return false if an insert failed
+   */
+  bool InsertTuples();
+
+  /** Adds an inserted tuple to every index of the table. */
+  void InsertIndexEntries(const Tuple &tuple, const RID &rid);
+
   /** The insert plan node to be executed. */
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableMetadata *table_MetaData_;
+  /** The indexes of the table. */
+  std::vector<IndexInfo *> indexes_;
+  /** Batch of tuples pulled from the child executor. */
+  TupleBatch child_batch_;
+  /** The tuples being inserted, and their rids. */
+  std::vector<Tuple> tuples_;
+  std::vector<RID> rids_;
+  /** True in push-based execution, where the rows of the child are inserted as they are pushed. */
+  bool pushed_{false};
+  /** False once an insert of a pushed row failed. */
+  bool push_succeeded_{true};
 
 };
 }  // namespace bustub
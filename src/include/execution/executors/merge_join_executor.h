@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "execution/compiled_predicate.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinExecutor joins two inputs sorted on their join keys in a single pass over both. Only the run of right
+ * tuples that share the current key is buffered, so memory does not grow with the inputs, only with the longest
+ * run of duplicate right keys.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new merge join executor.
+   * @param exec_ctx the executor context
+   * @param plan the merge join plan to be executed
+   * @param left the executor of the left input
+   * @param right the executor of the right input
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan, std::unique_ptr<AbstractExecutor> &&left,
+                    std::unique_ptr<AbstractExecutor> &&right);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple) override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+ private:
+  /** Walks through the rows of a sorted input a batch at a time, with the join keys of each batch. */
+  class SortedInput {
+   public:
+    SortedInput(AbstractExecutor *child, const std::vector<const AbstractExpression *> &keys)
+        : child_(child), keys_(keys), key_scratch_(keys.size()), key_columns_(keys.size()) {}
+
+    /** Starts over from the first row. */
+    void Init();
+
+    /** @return true while the input has a current row */
+    bool Valid() const { return pos_ < batch_.NumSelected(); }
+
+    /** @return the current batch */
+    const TupleBatch &Batch() const { return batch_; }
+
+    /** @return the physical index of the current row in Batch() */
+    uint32_t Row() const { return batch_.GetSelection()[pos_]; }
+
+    /** @return the value of join key key_idx of the current row */
+    const Value &Key(size_t key_idx) const { return (*key_columns_[key_idx])[Row()]; }
+
+    /** @return true if a join key of the current row is null */
+    bool HasNullKey() const;
+
+    /** Moves to the next row, pulling the next batch if needed. */
+    void Advance();
+
+   private:
+    /** Pulls batches until one has a row, or the child is exhausted. */
+    void NextBatch();
+
+    AbstractExecutor *child_;
+    const std::vector<const AbstractExpression *> &keys_;
+    TupleBatch batch_;
+    /** The values of the keys that have to be computed, and the values of every key, indexed by physical row. */
+    std::vector<std::vector<Value>> key_scratch_;
+    std::vector<const std::vector<Value> *> key_columns_;
+    uint32_t pos_{0};
+  };
+
+  /** @return a negative number, zero or a positive number if the key of the left row is below, equal to or above
+   * the key of the right row, which must not be null */
+  int CompareKeys(const SortedInput &left, const SortedInput &right) const;
+
+  /** @return true if the key of the current left row equals the key of the buffered right run */
+  bool LeftMatchesRun() const;
+
+  /** The merge join plan node to be executed. */
+  const MergeJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_;
+  std::unique_ptr<AbstractExecutor> right_;
+  SortedInput left_input_;
+  SortedInput right_input_;
+  /** The predicate, compiled against the left and right schemas, or nullptr if it is interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+
+  /** The run of right rows with the key run_key_, which the current left row joins with while in_run_. */
+  std::vector<Tuple> run_;
+  std::vector<Value> run_key_;
+  bool in_run_{false};
+  /** The next row of run_ to pair with the current left row. */
+  size_t run_pos_{0};
+
+  /** Pairs of left and right rows, before the predicate. */
+  TupleBatch left_pairs_;
+  TupleBatch right_pairs_;
+  /** Output of NextBatch() that Next() hands out a tuple at a time. */
+  TupleBatch out_batch_;
+  size_t out_pos_{0};
+};
+}  // namespace bustub
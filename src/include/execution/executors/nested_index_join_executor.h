@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nested_index_join_executor.h
+//
+// Identification: src/include/execution/executors/nested_index_join_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "execution/compiled_predicate.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * NestedIndexJoinExecutor probes the index of the inner table with the key of every outer tuple. The outer side is
+ * read a batch at a time: the RIDs found for the whole batch are sorted by page before the inner tuples are fetched,
+ * so that each inner page is fetched once per outer batch.
+ */
+class NestedIndexJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new nested index join executor.
+   * @param exec_ctx the executor context
+   * @param plan the nested index join plan to be executed
+   * @param outer the executor of the outer side
+   */
+  NestedIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
+                          std::unique_ptr<AbstractExecutor> &&outer);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple) override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** The outer side is streamed: every outer batch is joined as soon as it is pushed. */
+  std::vector<AbstractExecutor *> GetPushInputs() override { return {outer_.get()}; }
+
+  bool IsPipelineBreaker(uint32_t input_idx) override { return false; }
+
+  void InitPush() override;
+
+  void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) override;
+
+ private:
+  /** An inner tuple to fetch, and the outer row it joins with. */
+  using Match = std::pair<RID, uint32_t>;
+
+  /** Looks up the inner table and its index, and compiles the predicate. */
+  void OpenInner();
+
+  /**
+   * Probes the index with the next outer batch, and fetches the inner tuples of its matches.
+   * @return false if the outer side is exhausted
+   */
+  bool ProbeNextOuterBatch();
+
+  /** Probes the index with outer_batch_, and fetches the inner tuples of its matches. */
+  void ProbeOuterBatch();
+
+  /** The nested index join plan node to be executed. */
+  const NestedIndexJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> outer_;
+  TableHeap *inner_table_;
+  const Schema *inner_schema_;
+  /** The predicate, compiled against the outer and inner schemas, or nullptr if it is interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  Index *index_;
+  /** True in push-based execution, where the outer batches are pushed instead of pulled. */
+  bool push_mode_{false};
+
+  /** The current outer batch. */
+  TupleBatch outer_batch_;
+  /** The matches of the current outer batch, sorted by RID. */
+  std::vector<Match> matches_;
+  /** The inner tuple of each match, and whether it still exists. */
+  std::vector<Tuple> inner_tuples_;
+  std::vector<bool> found_;
+  /** The next match to join. */
+  size_t match_pos_{0};
+
+  /** Pairs of outer and inner rows, before the predicate. */
+  TupleBatch outer_pairs_;
+  TupleBatch inner_pairs_;
+  /** Output of NextBatch() that Next() hands out a tuple at a time. */
+  TupleBatch out_batch_;
+  size_t out_pos_{0};
+};
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pipeline_executor.h
+//
+// Identification: src/include/execution/executors/pipeline_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * PipelineExecutor runs an executor tree, as built by ExecutorFactory, in push-based execution. The tree is split
+ * into pipelines at its pipeline breakers, such as the build side of a hash join or the input of an aggregation.
+ * Each pipeline runs from a source, which is pulled a batch at a time, through the executors that stream its batches
+ * (e.g. the probe side of a hash join), into the executor that breaks it. Each batch thus makes its way through the
+ * whole pipeline in a single call chain, and no executor pulls from a child.
+ *
+ * Pipelines run in dependency order: all but the last one in Init(), and the last one, which ends in this executor,
+ * as its output is pulled. A pipeline breaker then becomes the source of the pipeline that consumes its output.
+ * Executors without push inputs, e.g. scans or a merge join, are sources that run in pull mode with their subtree.
+ * The worker pool of the executor context is not used.
+ */
+class PipelineExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new pipeline executor.
+   * @param exec_ctx the executor context
+   * @param root the root of the executor tree to run
+   */
+  PipelineExecutor(ExecutorContext *exec_ctx, std::unique_ptr<AbstractExecutor> &&root);
+
+  const Schema *GetOutputSchema() override { return root_->GetOutputSchema(); }
+
+  /** Splits the tree into pipelines, and runs every pipeline but the last one. */
+  void Init() override;
+
+  bool Next(Tuple *tuple) override;
+
+  /** Pushes batches through the last pipeline until some rows come out of it. */
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return the number of pipelines the tree was split into */
+  size_t NumPipelines() const { return pipelines_.size(); }
+
+ private:
+  /** An executor that a pipeline pushes into, and the push input of it that the pipeline feeds. */
+  struct Stage : public BatchConsumer {
+    Stage(AbstractExecutor *executor, uint32_t input_idx) : executor_(executor), input_idx_(input_idx) {}
+
+    void Consume(TupleBatch *batch) override { executor_->Push(input_idx_, batch, next_); }
+
+    AbstractExecutor *executor_;
+    uint32_t input_idx_;
+    /** The next stage, the output of the last pipeline, or nullptr after a pipeline breaker. */
+    BatchConsumer *next_{nullptr};
+  };
+
+  /** Collects the output of the last pipeline. */
+  struct Output : public BatchConsumer {
+    void Consume(TupleBatch *batch) override { batches_.push_back(std::move(*batch)); }
+
+    std::deque<TupleBatch> batches_;
+  };
+
+  struct Pipeline {
+    AbstractExecutor *source_{nullptr};
+    /** From the first stage after the source to the last one. */
+    std::vector<std::unique_ptr<Stage>> stages_;
+  };
+
+  /**
+   * Adds an executor and its subtree to a pipeline that is built from its end, initializing the executors on the way.
+   * The pipelines of the breaker inputs of the executor are completed and added to pipelines_.
+   */
+  void Decompose(AbstractExecutor *executor, Pipeline *pipeline);
+
+  /**
+   * Pushes the next batch of the source of a pipeline through it, or finishes the stages of the pipeline once the
+   * source is exhausted.
+   * @return false if the source was exhausted
+   */
+  bool PushNextBatch(Pipeline *pipeline);
+
+  std::unique_ptr<AbstractExecutor> root_;
+  /** In the order in which they run; the last one ends in output_. */
+  std::vector<std::unique_ptr<Pipeline>> pipelines_;
+  Output output_;
+  /** True once the last pipeline is finished. */
+  bool done_{false};
+  /** The batch that the source of a pipeline produces. */
+  TupleBatch source_batch_;
+  /** The batch Next() returns tuples from, and the next row of it. */
+  TupleBatch out_batch_;
+  uint32_t out_pos_{0};
+};
+
+}  // namespace bustub
@@ -12,11 +12,15 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "execution/compiled_predicate.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/morsel_queue.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -30,20 +34,95 @@ namespace bustub {
          * Creates a new sequential scan executor.
          * @param exec_ctx the executor context
          * @param plan the sequential scan plan to be executed
+         * @param morsels if not nullptr, only the morsels claimed from this queue are scanned, so that several
+         * executors sharing the queue scan the table in parallel
          */
-        SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+        SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, MorselQueue *morsels = nullptr);
 
         void Init() override;
 
         bool Next(Tuple *tuple) override;
 
+        /**
+         * Scans up to TupleBatch::BATCH_SIZE tuples at a time. The predicate is evaluated in place on the page data:
+         * a compiled one on the tuples of a page at once, with each comparison with a constant gathering its column
+         * for SimdFilter, and an interpreted one a tuple at a time. Only the columns that the output schema refers to
+         * are read out of the tuples that pass it, before they are projected onto the output schema as a whole batch.
+         */
+        bool NextBatch(TupleBatch *batch) override;
+
+        /** Drops the tuples that do not pass the filter, right after the predicate and the projection. */
+        bool PushRuntimeFilter(const RuntimeFilter *filter) override {
+            runtime_filter_ = filter;
+            return true;
+        }
+
         const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
+        /** @return the number of tuples that NextBatch() filtered with the compiled predicate since Init() */
+        size_t NumBatchFilteredTuples() const { return num_batch_filtered_; }
+
+        /** @return the size of the tuples that NextBatch() read columns out of since Init() */
+        size_t NumTupleBytesRead() const { return num_bytes_read_; }
+
     private:
+        /**
+         * Visits the tuples of the table, or of the claimed morsels, in place and in order, resuming where the last
+         * call stopped. func(tuple) gets a view of the page data, and returns false to stop after that tuple.
+         * @return false if the table ran out before func asked to stop
+         */
+        template<typename Func>
+        bool ScanTuples(Func &&func);
+
+        /** Same as above, but calls end_func() at the end of each page visit, while the views are still valid. */
+        template<typename Func, typename EndFunc>
+        bool ScanTuples(Func &&func, EndFunc &&end_func);
+
+        /** Reads the scan_columns_ of a tuple, viewed in place, into a new row of scan_batch_. */
+        void ReadColumns(const Tuple &view);
+
+        /** @return true if a tuple, viewed in place, passes the predicate */
+        bool Matches(const Tuple &tuple) const;
+
+        /** Builds the output tuple of a table tuple, viewed in place, with the output expressions. */
+        void Project(const Tuple &view, Tuple *tuple);
+
+        /** Marks the columns of the table that expr refers to. */
+        static void CollectColumns(const AbstractExpression *expr, std::vector<bool> *referenced);
+
         /** The sequential scan plan node to be executed. */
         const SeqScanPlanNode *plan_;
         TableHeap *table_heap_;
-        std::unique_ptr<TableIterator> iterator_;
+        /** The schema of the table, which the predicate and the output expressions refer to. */
+        const Schema *table_schema_;
+        /** The predicate, compiled against the table schema, or nullptr if it is interpreted. */
+        std::unique_ptr<CompiledPredicate> compiled_predicate_;
+        /** The columns of the table that the output expressions refer to, the only ones read into scan_batch_. */
+        std::vector<uint32_t> scan_columns_;
+        /** True if the output schema lays out the table columns as they are, so that Next() copies tuples whole. */
+        bool identity_projection_{false};
+        /** The output values of the tuple being projected by Next(). */
+        std::vector<Value> out_values_;
+        /** Morsel mode: the shared queue, the morsel being scanned and the position of its current page. */
+        MorselQueue *morsels_;
+        Morsel morsel_;
+        size_t page_idx_{0};
+        /** The page being scanned, or INVALID_PAGE_ID between morsels, and the slot to resume from. */
+        page_id_t page_id_{INVALID_PAGE_ID};
+        uint32_t slot_num_{0};
+        /** Tuples that passed the predicate, before projection; only the scan_columns_ columns are filled in. */
+        TupleBatch scan_batch_;
+        /**
+         * The data and size of the tuples of the page being visited, which NextBatch() filters with the compiled
+         * predicate, and the indexes of those that pass it.
+         */
+        std::vector<char *> row_data_;
+        std::vector<uint32_t> row_sizes_;
+        std::vector<uint32_t> selection_;
+        size_t num_batch_filtered_{0};
+        size_t num_bytes_read_{0};
+        /** Filter pushed down by a consumer, or nullptr. */
+        const RuntimeFilter *runtime_filter_{nullptr};
 
     };
 }  // namespace bustub
@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key_encoder.h"
+#include "storage/table/tmp_tuple_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+/**
+ * SortExecutor orders the tuples of its child executor. Tuples are sorted in memory by their encoded keys (see
+ * SortKeyEncoder). Once they exceed the memory budget of the executor context, they are sorted and written out as a
+ * run to temporary pages, and the runs are merged at the end.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new sort executor.
+   * @param exec_ctx the executor context
+   * @param plan the sort plan to be executed
+   * @param child the child executor whose tuples are sorted
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  /** Sorts every tuple of the child executor. */
+  void Init() override;
+
+  bool Next(Tuple *tuple) override;
+
+  std::vector<AbstractExecutor *> GetPushInputs() override { return {child_.get()}; }
+
+  void InitPush() override;
+
+  /** Adds the tuples of a batch of the child, spilling a run if they exceed the memory budget. */
+  void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) override;
+
+  /** Sorts the tuples in memory and prepares to merge the runs, if any. */
+  void FinishPush(uint32_t input_idx, BatchConsumer *consumer) override;
+
+ private:
+  /** Memory taken by a tuple in addition to its data and its key. */
+  static constexpr size_t TUPLE_OVERHEAD = sizeof(Tuple) + sizeof(uint32_t);
+
+  /** Reads a sorted run back, a page at a time. */
+  struct RunCursor {
+    /** The run, or nullptr for the tuples that were still in memory. */
+    TmpTupleHeap *run_;
+    /** The next page of the run to read. */
+    size_t next_page_;
+    /** The tuples of the current page, in order. */
+    std::vector<Tuple> tuples_;
+    /** The current tuple. */
+    size_t pos_;
+    /** The encoded key of the current tuple. */
+    std::vector<uint8_t> key_;
+  };
+
+  /** Sorts the tuples in memory into order_. */
+  void SortInMemory();
+
+  /** Writes the tuples in memory out as a sorted run. */
+  void SpillRun();
+
+  /**
+   * Encodes the key of the current tuple of a cursor, reading the next page of its run first if the cursor moved past
+   * the end of its page.
+   * @return false if the run is exhausted
+   */
+  bool LoadCurrent(RunCursor *cursor);
+
+  /** @return true if the current tuple of cursor a sorts after that of cursor b */
+  bool SortsAfter(size_t a, size_t b) const;
+
+  /** The sort plan node to be executed. */
+  const SortPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_;
+  SortKeyEncoder encoder_;
+
+  /** The tuples in memory. */
+  std::vector<Tuple> tuples_;
+  /** The encoded key of each tuple in memory, KeyWidth() bytes each. */
+  std::vector<uint8_t> keys_;
+  /** Indexes of the tuples in memory, in sorted order once sorted. */
+  std::vector<uint32_t> order_;
+  /** Bytes taken by the tuples in memory. */
+  size_t memory_bytes_{0};
+  /** The next tuple in order_ to produce, when nothing was spilled. */
+  size_t next_{0};
+
+  /** The sorted runs that were spilled. */
+  std::vector<std::unique_ptr<TmpTupleHeap>> runs_;
+  /** One cursor per run, plus one over the tuples that were left in memory. */
+  std::vector<RunCursor> cursors_;
+  /** Min-heap of the cursors that are not exhausted, by their current tuple. */
+  std::vector<size_t> merge_heap_;
+};
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.h
+//
+// Identification: src/include/execution/executors/topn_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/sort_key_encoder.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+/**
+ * TopNExecutor produces the first n tuples of its child executor in sort order. It keeps the best n tuples seen so
+ * far in a bounded max-heap, so it never holds more than n tuples, and only materializes the tuples that enter the
+ * heap.
+ */
+class TopNExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new top-n executor.
+   * @param exec_ctx the executor context
+   * @param plan the top-n plan to be executed
+   * @param child the child executor whose tuples are sorted
+   */
+  TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  /** Finds the first n tuples of the child executor. */
+  void Init() override;
+
+  bool Next(Tuple *tuple) override;
+
+  std::vector<AbstractExecutor *> GetPushInputs() override { return {child_.get()}; }
+
+  void InitPush() override;
+
+  /** Keeps the tuples of a batch of the child that sort before the last of the first n so far. */
+  void Push(uint32_t input_idx, TupleBatch *batch, BatchConsumer *consumer) override;
+
+  /** Sorts the first n tuples. */
+  void FinishPush(uint32_t input_idx, BatchConsumer *consumer) override;
+
+ private:
+  /** @return the encoded key of the tuple in slot */
+  const uint8_t *KeyAt(size_t slot) const { return &keys_[slot * encoder_.KeyWidth()]; }
+
+  /** @return true if the tuple in slot a sorts before the tuple in slot b */
+  bool SortsBefore(size_t a, size_t b) const;
+
+  /** The top-n plan node to be executed. */
+  const TopNPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> child_;
+  SortKeyEncoder encoder_;
+
+  /** The tuples in the heap, by slot. */
+  std::vector<Tuple> tuples_;
+  /** The encoded key of the tuple in each slot. */
+  std::vector<uint8_t> keys_;
+  /** Max-heap of slots, with the tuple that sorts last on top; sorted once the child is exhausted. */
+  std::vector<size_t> heap_;
+  /** The next tuple in heap_ to produce. */
+  size_t next_{0};
+  /** The encoded keys of the batch being pushed. */
+  std::vector<uint8_t> batch_keys_;
+};
+}  // namespace bustub
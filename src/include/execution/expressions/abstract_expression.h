@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -58,6 +59,43 @@ class AbstractExpression {
    */
   virtual Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const = 0;
 
+  /**
+   * Evaluates the expression on every selected row of a batch.
+   * @param batch the batch, whose columns are laid out as in the schema that Evaluate would be called with
+   * @param[out] result the values, indexed by physical row; entries of rows that are not selected are unspecified
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const = 0;
+
+  /**
+   * Evaluates a join on every selected row of a pair of batches. Physical row i of the left batch is joined with
+   * physical row i of the right batch, and the selection of the left batch is used.
+   * @param left the left batch
+   * @param right the right batch
+   * @param[out] result the values, indexed by physical row; entries of rows that are not selected are unspecified
+   */
+  virtual void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const = 0;
+
+  /**
+   * Same as EvaluateBatch, but values that are already in the batch, e.g. those of a column, are not copied.
+   * @param batch the batch
+   * @param scratch where the values are put if they have to be computed
+   * @return the values, indexed by physical row, which live in the batch or in scratch
+   */
+  virtual const std::vector<Value> &EvaluateBatchView(const TupleBatch &batch, std::vector<Value> *scratch) const {
+    EvaluateBatch(batch, scratch);
+    return *scratch;
+  }
+
+  /**
+   * Same as EvaluateJoinBatch, but values that are already in one of the batches are not copied.
+   * @return the values, indexed by physical row, which live in one of the batches or in scratch
+   */
+  virtual const std::vector<Value> &EvaluateJoinBatchView(const TupleBatch &left, const TupleBatch &right,
+                                                          std::vector<Value> *scratch) const {
+    EvaluateJoinBatch(left, right, scratch);
+    return *scratch;
+  }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpression *GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
@@ -46,6 +46,14 @@ class AggregateValueExpression : public AbstractExpression {
     return is_group_by_term_ ? group_bys[term_idx_] : aggregates[term_idx_];
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const override {
+    BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
+  }
+
  private:
   bool is_group_by_term_;
   uint32_t term_idx_;
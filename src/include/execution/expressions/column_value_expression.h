@@ -45,6 +45,31 @@ class ColumnValueExpression : public AbstractExpression {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    *result = batch.GetColumn(col_idx_);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const override {
+    *result = tuple_idx_ == 0 ? left.GetColumn(col_idx_) : right.GetColumn(col_idx_);
+  }
+
+  /** The column of the batch itself. */
+  const std::vector<Value> &EvaluateBatchView(const TupleBatch &batch, std::vector<Value> *scratch) const override {
+    return batch.GetColumn(col_idx_);
+  }
+
+  /** The column of the batch on the side of the join that the column is from. */
+  const std::vector<Value> &EvaluateJoinBatchView(const TupleBatch &left, const TupleBatch &right,
+                                                  std::vector<Value> *scratch) const override {
+    return tuple_idx_ == 0 ? left.GetColumn(col_idx_) : right.GetColumn(col_idx_);
+  }
+
+  /** @return the tuple index of the column, 0 = left side of join, 1 = right side of join */
+  uint32_t GetTupleIdx() const { return tuple_idx_; }
+
+  /** @return the index of the column in the schema */
+  uint32_t GetColIdx() const { return col_idx_; }
+
  private:
   /** Tuple index 0 = left side of join, tuple index 1 = right side of join */
   uint32_t tuple_idx_;
@@ -53,6 +53,23 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    CompareBatch(batch, GetChildAt(0)->EvaluateBatchView(batch, &lhs), GetChildAt(1)->EvaluateBatchView(batch, &rhs),
+                 result);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    CompareBatch(left, GetChildAt(0)->EvaluateJoinBatchView(left, right, &lhs),
+                 GetChildAt(1)->EvaluateJoinBatchView(left, right, &rhs), result);
+  }
+
+  /** @return the comparison that this expression performs */
+  ComparisonType GetComparisonType() const { return comp_type_; }
+
  private:
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
     switch (comp_type_) {
@@ -73,6 +90,15 @@ class ComparisonExpression : public AbstractExpression {
     }
   }
 
+  /** Compares lhs and rhs on every selected row of batch. */
+  void CompareBatch(const TupleBatch &batch, const std::vector<Value> &lhs, const std::vector<Value> &rhs,
+                    std::vector<Value> *result) const {
+    result->resize(batch.NumRows());
+    for (uint32_t row_idx : batch.GetSelection()) {
+      (*result)[row_idx] = ValueFactory::GetBooleanValue(PerformComparison(lhs[row_idx], rhs[row_idx]));
+    }
+  }
+
   std::vector<const AbstractExpression *> children_;
   ComparisonType comp_type_;
 };
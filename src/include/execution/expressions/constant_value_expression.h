@@ -36,6 +36,14 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, std::vector<Value> *result) const override {
+    result->assign(batch.NumRows(), val_);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, const TupleBatch &right, std::vector<Value> *result) const override {
+    result->assign(left.NumRows(), val_);
+  }
+
  private:
   Value val_;
 };
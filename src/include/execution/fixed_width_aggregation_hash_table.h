@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// fixed_width_aggregation_hash_table.h
+//
+// Identification: src/include/execution/fixed_width_aggregation_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/plans/aggregation_plan.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * FixedWidthAggregationHashTable aggregates plans whose group bys and aggregate inputs are all integers, without
+ * boxing anything in a Value per row. Each group is a fixed-width row of 64-bit words: the group by values, the
+ * accumulators, and a word of null flags for the accumulators. The rows sit back to back in one vector, and an
+ * open-addressing directory maps key hashes to them. Batches are unboxed one column at a time, and the accumulators
+ * of each aggregate are updated by a kernel specialized for its AggregationType.
+ *
+ * The results are those of SimpleAggregationHashTable: accumulators start from the same initial values, nulls are
+ * sticky for sums, mins and maxes, and a sum that overflows its result type throws. Rows with a null group by are
+ * left to the caller, because a null key never equals another key.
+ */
+class FixedWidthAggregationHashTable {
+ public:
+  /** @return true if every group by and aggregate input of the plan is an integer */
+  static bool Supports(const AggregationPlanNode *plan);
+
+  /**
+   * Creates an empty table.
+   * @param plan the aggregation plan, which must be supported
+   */
+  explicit FixedWidthAggregationHashTable(const AggregationPlanNode *plan);
+
+  /**
+   * Aggregates the selected rows of a batch.
+   * @param group_bys the values of each group by, indexed by physical row
+   * @param aggregates the values of each aggregate input, indexed by physical row
+   * @param selection the physical rows to aggregate
+   * @param[out] null_key_rows the rows with a null group by, which are not aggregated
+   */
+  void Aggregate(const std::vector<const std::vector<Value> *> &group_bys,
+                 const std::vector<const std::vector<Value> *> &aggregates, const std::vector<uint32_t> &selection,
+                 std::vector<uint32_t> *null_key_rows);
+
+  /** @return the number of groups */
+  size_t Size() const { return num_groups_; }
+
+  /** @return the number of bytes a group takes, directory included */
+  size_t GroupFootprint() const { return (stride_ + MAX_LOAD_FACTOR_INVERSE) * sizeof(int64_t); }
+
+  /**
+   * Calls func(key, value) on every group, boxed as in SimpleAggregationHashTable.
+   */
+  template <typename Func>
+  void ForEachGroup(Func &&func) const {
+    AggregateKey key;
+    AggregateValue value;
+    for (size_t group_idx = 0; group_idx < num_groups_; ++group_idx) {
+      BoxGroup(group_idx, &key, &value);
+      func(key, value);
+    }
+  }
+
+  /** Removes all groups. */
+  void Clear();
+
+ private:
+  /** Marks an empty directory slot. */
+  static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+  static constexpr size_t INITIAL_DIRECTORY_SIZE = 256;
+  /** The directory is kept at most half full. */
+  static constexpr size_t MAX_LOAD_FACTOR_INVERSE = 2;
+
+  /** Unboxes a column of integers into 64-bit words, and flags its nulls. */
+  template <typename CppType>
+  static void UnboxColumn(const std::vector<Value> &values, const std::vector<uint32_t> &selection,
+                          std::vector<int64_t> *words, std::vector<uint8_t> *nulls);
+
+  /** Unboxes a column of integers of the given type. */
+  static void Unbox(TypeId type, const std::vector<Value> &values, const std::vector<uint32_t> &selection,
+                    std::vector<int64_t> *words, std::vector<uint8_t> *nulls);
+
+  /** Boxes a 64-bit word as an integer Value of the given type. */
+  static Value Box(TypeId type, int64_t word);
+
+  /**
+   * Updates accumulator agg_idx of the group of every row with its input, using the kernel of agg_type.
+   * @param rows the rows to update, which all have a group
+   * @param inputs the unboxed input of each physical row
+   * @param nulls the null flag of each physical row
+   */
+  template <AggregationType agg_type>
+  void UpdateAccumulators(size_t agg_idx, const std::vector<uint32_t> &rows, const std::vector<int64_t> &inputs,
+                          const std::vector<uint8_t> &nulls);
+
+  /** @return the index of the group with the given key, which is created if it does not exist yet */
+  uint32_t FindOrInsertGroup(const int64_t *key, uint64_t hash);
+
+  /** Doubles the directory. */
+  void Grow();
+
+  /** Boxes a group as in SimpleAggregationHashTable. */
+  void BoxGroup(size_t group_idx, AggregateKey *key, AggregateValue *value) const;
+
+  size_t SlotOf(uint64_t hash) const { return static_cast<size_t>(hash) & (directory_.size() - 1); }
+
+  int64_t *GroupAt(size_t group_idx) { return &groups_[group_idx * stride_]; }
+  const int64_t *GroupAt(size_t group_idx) const { return &groups_[group_idx * stride_]; }
+
+  std::vector<TypeId> key_types_;
+  std::vector<TypeId> input_types_;
+  std::vector<AggregationType> agg_types_;
+  /** The type of the result of each aggregate. */
+  std::vector<TypeId> result_types_;
+  /** Words per group: the keys, the accumulators, and the null flags of the accumulators. */
+  size_t stride_;
+
+  /** The groups, stride_ words each. */
+  std::vector<int64_t> groups_;
+  /** The key hash of each group. */
+  std::vector<uint64_t> group_hashes_;
+  size_t num_groups_{0};
+  /** Open-addressing directory of group indexes; its size is a power of two. */
+  std::vector<uint32_t> directory_;
+
+  /** Per-batch scratch space, indexed by physical row. */
+  std::vector<std::vector<int64_t>> key_words_;
+  std::vector<uint8_t> key_nulls_;
+  std::vector<int64_t> input_words_;
+  std::vector<uint8_t> input_nulls_;
+  std::vector<uint32_t> row_groups_;
+  std::vector<uint32_t> keyed_rows_;
+};
+
+}  // namespace bustub
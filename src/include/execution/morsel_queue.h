@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_queue.h
+//
+// Identification: src/include/execution/morsel_queue.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * A morsel is a range of consecutive pages of a table, [begin_, end_) in MorselQueue::GetPageId() order.
+ */
+struct Morsel {
+  size_t begin_{0};
+  size_t end_{0};
+};
+
+/**
+ * MorselQueue splits a table into morsels and hands them out to the workers that scan it in parallel.
+ * Every page is handed out exactly once; Next() is lock-free and may be called from any number of threads.
+ */
+class MorselQueue {
+ public:
+  /** Default number of pages per morsel. */
+  static constexpr size_t MORSEL_SIZE = 8;
+
+  /**
+   * Creates a queue over all pages of a table.
+   * @param table_heap the table to scan
+   * @param pages_per_morsel the number of pages per morsel
+   */
+  explicit MorselQueue(TableHeap *table_heap, size_t pages_per_morsel = MORSEL_SIZE)
+      : table_heap_(table_heap), page_ids_(table_heap->GetPageIds()), pages_per_morsel_(pages_per_morsel) {
+    BUSTUB_ASSERT(pages_per_morsel > 0, "Morsels cannot be empty.");
+  }
+
+  DISALLOW_COPY_AND_MOVE(MorselQueue);
+
+  /**
+   * Claims the next morsel.
+   * @param[out] morsel the claimed morsel
+   * @return false if the whole table has been handed out
+   */
+  bool Next(Morsel *morsel) {
+    size_t begin = next_.fetch_add(pages_per_morsel_);
+    if (begin >= page_ids_.size()) {
+      return false;
+    }
+    morsel->begin_ = begin;
+    morsel->end_ = std::min(begin + pages_per_morsel_, page_ids_.size());
+    return true;
+  }
+
+  /** @return the number of pages in the table */
+  size_t NumPages() const { return page_ids_.size(); }
+
+  /** @return the id of the page at the given position in the table */
+  page_id_t GetPageId(size_t page_idx) const { return page_ids_[page_idx]; }
+
+  /** @return the table that is being scanned */
+  TableHeap *GetTableHeap() const { return table_heap_; }
+
+ private:
+  TableHeap *table_heap_;
+  std::vector<page_id_t> page_ids_;
+  size_t pages_per_morsel_;
+  std::atomic<size_t> next_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_plan.h
+//
+// Identification: src/include/execution/plans/merge_join_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinPlanNode represents an equi-join of two children whose tuples both come sorted in ascending order of their
+ * join keys, e.g. from SortPlanNodes with OrderByType::Asc keys. Tuples with a null key never join.
+ */
+class MergeJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new merge join plan node.
+   * @param output_schema the output format of this plan node
+   * @param children the left and the right plan nodes, both sorted on their keys
+   * @param predicate the predicate that joined pairs must also satisfy, or nullptr
+   * @param left_keys the join keys of the left tuples, most significant first
+   * @param right_keys the join keys of the right tuples, in the same order
+   */
+  MergeJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
+                    const AbstractExpression *predicate, std::vector<const AbstractExpression *> &&left_keys,
+                    std::vector<const AbstractExpression *> &&right_keys)
+      : AbstractPlanNode(output_schema, std::move(children)),
+        predicate_(predicate),
+        left_keys_(std::move(left_keys)),
+        right_keys_(std::move(right_keys)) {}
+
+  PlanType GetType() const override { return PlanType::MergeJoin; }
+
+  /** @return the predicate that joined pairs must also satisfy, or nullptr */
+  const AbstractExpression *Predicate() const { return predicate_; }
+
+  /** @return the left plan node of the merge join */
+  const AbstractPlanNode *GetLeftPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Merge joins should have exactly two children plans.");
+    return GetChildAt(0);
+  }
+
+  /** @return the right plan node of the merge join */
+  const AbstractPlanNode *GetRightPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 2, "Merge joins should have exactly two children plans.");
+    return GetChildAt(1);
+  }
+
+  /** @return the join keys of the left tuples */
+  const std::vector<const AbstractExpression *> &GetLeftKeys() const { return left_keys_; }
+
+  /** @return the join keys of the right tuples */
+  const std::vector<const AbstractExpression *> &GetRightKeys() const { return right_keys_; }
+
+ private:
+  const AbstractExpression *predicate_;
+  std::vector<const AbstractExpression *> left_keys_;
+  std::vector<const AbstractExpression *> right_keys_;
+};
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// nested_index_join_plan.h
+//
+// Identification: src/include/execution/plans/nested_index_join_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/simple_catalog.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * NestedIndexJoinPlanNode joins the tuples of its only child, the outer side, with the tuples of an inner table whose
+ * indexed columns equal a key computed from each outer tuple. In the predicate and the output schema, the outer tuple
+ * is the left tuple and the inner table tuple is the right tuple.
+ */
+class NestedIndexJoinPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new nested index join plan node.
+   * @param output_schema the output format of this plan node
+   * @param outer the outer plan node
+   * @param predicate the predicate that joined pairs must also satisfy, or nullptr
+   * @param outer_keys one expression per indexed column, evaluated over the outer tuples
+   * @param inner_table_oid the identifier of the inner table
+   * @param index_oid the identifier of the index of the inner table to probe
+   */
+  NestedIndexJoinPlanNode(const Schema *output_schema, const AbstractPlanNode *outer,
+                          const AbstractExpression *predicate, std::vector<const AbstractExpression *> &&outer_keys,
+                          table_oid_t inner_table_oid, index_oid_t index_oid)
+      : AbstractPlanNode(output_schema, {outer}),
+        predicate_(predicate),
+        outer_keys_(std::move(outer_keys)),
+        inner_table_oid_(inner_table_oid),
+        index_oid_(index_oid) {}
+
+  PlanType GetType() const override { return PlanType::NestedIndexJoin; }
+
+  /** @return the predicate that joined pairs must also satisfy, or nullptr */
+  const AbstractExpression *Predicate() const { return predicate_; }
+
+  /** @return the outer plan node */
+  const AbstractPlanNode *GetOuterPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Nested index joins should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return the expressions that compute the index key of an outer tuple */
+  const std::vector<const AbstractExpression *> &GetOuterKeys() const { return outer_keys_; }
+
+  /** @return the identifier of the inner table */
+  table_oid_t GetInnerTableOid() const { return inner_table_oid_; }
+
+  /** @return the identifier of the index to probe */
+  index_oid_t GetIndexOid() const { return index_oid_; }
+
+ private:
+  const AbstractExpression *predicate_;
+  std::vector<const AbstractExpression *> outer_keys_;
+  table_oid_t inner_table_oid_;
+  index_oid_t index_oid_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_plan.h
+//
+// Identification: src/include/execution/plans/sort_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** OrderByType is the direction of an ORDER BY key. Nulls come first in ascending order, and last in descending. */
+enum class OrderByType { Asc, Desc };
+
+/** An ORDER BY key: its direction, and the expression to sort on, evaluated over the tuples of the child. */
+using OrderBy = std::pair<OrderByType, const AbstractExpression *>;
+
+/**
+ * SortPlanNode orders the tuples of its child (ORDER BY). The tuples themselves are unchanged, so the output schema
+ * must be the output schema of the child.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new SortPlanNode.
+   * @param output_schema the output format of this plan node, which is the output format of the child
+   * @param child the child plan whose tuples are sorted
+   * @param order_bys the keys to sort on, most significant first
+   */
+  SortPlanNode(const Schema *output_schema, const AbstractPlanNode *child, std::vector<OrderBy> &&order_bys)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)) {}
+
+  PlanType GetType() const override { return PlanType::Sort; }
+
+  /** @return the child of this sort plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Sort expected to only have one child.");
+    return GetChildAt(0);
+  }
+
+  /** @return the keys to sort on, most significant first */
+  const std::vector<OrderBy> &GetOrderBys() const { return order_bys_; }
+
+ private:
+  std::vector<OrderBy> order_bys_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_plan.h
+//
+// Identification: src/include/execution/plans/topn_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/sort_plan.h"
+
+namespace bustub {
+
+/**
+ * TopNPlanNode produces the first n tuples of its child in the given order (ORDER BY ... LIMIT n). As with
+ * SortPlanNode, the output schema must be the output schema of the child.
+ */
+class TopNPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new TopNPlanNode.
+   * @param output_schema the output format of this plan node, which is the output format of the child
+   * @param child the child plan whose tuples are sorted
+   * @param order_bys the keys to sort on, most significant first
+   * @param n the maximum number of tuples to produce
+   */
+  TopNPlanNode(const Schema *output_schema, const AbstractPlanNode *child, std::vector<OrderBy> &&order_bys,
+               size_t n)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)), n_(n) {}
+
+  PlanType GetType() const override { return PlanType::TopN; }
+
+  /** @return the child of this top-n plan node */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "TopN expected to only have one child.");
+    return GetChildAt(0);
+  }
+
+  /** @return the keys to sort on, most significant first */
+  const std::vector<OrderBy> &GetOrderBys() const { return order_bys_; }
+
+  /** @return the maximum number of tuples to produce */
+  size_t GetN() const { return n_; }
+
+ private:
+  std::vector<OrderBy> order_bys_;
+  size_t n_;
+};
+
+}  // namespace bustub
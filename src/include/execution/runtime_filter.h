@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// runtime_filter.h
+//
+// Identification: src/include/execution/runtime_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "container/hash/blocked_bloom_filter.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * RuntimeFilter is built by a hash join over the key hashes of its build side, and handed to the probe side so that
+ * tuples whose keys cannot match are dropped before they ever reach the join. Keys are hashed exactly as
+ * HashJoinExecutor::HashValues does, so the join can fill the filter with the hashes it already computed.
+ */
+class RuntimeFilter {
+ public:
+  /**
+   * Creates an empty filter.
+   * @param num_keys the number of build tuples the filter is sized for
+   * @param keys the join keys of the probe side, evaluated on its output schema
+   */
+  RuntimeFilter(size_t num_keys, std::vector<const AbstractExpression *> keys)
+      : keys_(std::move(keys)), filter_(num_keys) {}
+
+  /** Adds the key hash of a build tuple. */
+  void Insert(hash_t hash) { filter_.Insert(hash); }
+
+  /** Adds every key of another filter built for the same number of tuples. */
+  void Merge(const RuntimeFilter &other) { filter_.Merge(other.filter_); }
+
+  /** @return false if no build tuple has the key hash */
+  bool MayMatch(hash_t hash) const { return filter_.MayContain(hash); }
+
+  /**
+   * @param tuple a probe tuple
+   * @param schema the schema to evaluate the keys on
+   * @return false if the tuple cannot match any build tuple
+   */
+  bool MayMatch(const Tuple *tuple, const Schema *schema) const {
+    hash_t hash = 0;
+    for (const auto &key : keys_) {
+      Value val = key->Evaluate(tuple, schema);
+      if (!val.IsNull()) {
+        hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&val));
+      }
+    }
+    return MayMatch(hash);
+  }
+
+  /**
+   * Narrows the selection of a batch of probe tuples to those that may match.
+   * @param batch the batch, laid out as the output schema of the probe side
+   */
+  void Filter(TupleBatch *batch) const {
+    std::vector<hash_t> hashes(batch->NumRows(), 0);
+    std::vector<Value> scratch;
+    for (const auto &key : keys_) {
+      const auto &vals = key->EvaluateBatchView(*batch, &scratch);
+      for (uint32_t row_idx : batch->GetSelection()) {
+        if (!vals[row_idx].IsNull()) {
+          hashes[row_idx] = HashUtil::CombineHashes(hashes[row_idx], HashUtil::HashValue(&vals[row_idx]));
+        }
+      }
+    }
+    std::vector<bool> keep(batch->NumRows(), false);
+    for (uint32_t row_idx : batch->GetSelection()) {
+      keep[row_idx] = MayMatch(hashes[row_idx]);
+    }
+    batch->Filter(keep);
+  }
+
+ private:
+  std::vector<const AbstractExpression *> keys_;
+  BlockedBloomFilter filter_;
+};
+
+}  // namespace bustub
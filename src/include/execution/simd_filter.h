@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simd_filter.h
+//
+// Identification: src/include/execution/simd_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "execution/expressions/comparison_expression.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+/**
+ * SimdFilter compares a contiguous array of fixed-width values with a constant and produces a selection bitmap, with
+ * AVX2 or SSE4.2 kernels when the CPU has them and a scalar loop otherwise. The instruction set is detected once, at
+ * run time, so the binary runs on any x86-64 CPU.
+ *
+ * Values are int32_t, int64_t or double; narrower integer types are widened to one of them first. A value equal to
+ * the null of its type (BUSTUB_INT32_NULL, BUSTUB_INT64_NULL or BUSTUB_DECIMAL_NULL) never passes.
+ */
+class SimdFilter {
+ public:
+  /** Instruction sets that the kernels are written for, from the least to the most capable. */
+  enum class Isa { Scalar, SSE42, AVX2 };
+
+  /** @return the value that stands for null in a fixed-width column of type T */
+  template <typename T>
+  static constexpr T NullOf() {
+    if constexpr (std::is_same_v<T, int8_t>) {
+      return BUSTUB_INT8_NULL;
+    } else if constexpr (std::is_same_v<T, int16_t>) {
+      return BUSTUB_INT16_NULL;
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+      return BUSTUB_INT32_NULL;
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+      return BUSTUB_INT64_NULL;
+    } else {
+      return BUSTUB_DECIMAL_NULL;
+    }
+  }
+
+  /** @return the most capable instruction set that this CPU supports */
+  static Isa DetectIsa();
+
+  /**
+   * Compares values[i] with the constant, for all i < num_values, with the kernels of the detected instruction set.
+   * @param values the values to compare
+   * @param num_values the number of values
+   * @param comp_type the comparison, with the value on the left
+   * @param constant the constant on the right
+   * @param[out] bitmap (num_values + 63) / 64 words; bit i % 64 of word i / 64 is set iff values[i] passes
+   */
+  template <typename T>
+  static void Compare(const T *values, size_t num_values, ComparisonType comp_type, T constant, uint64_t *bitmap) {
+    Compare(DetectIsa(), values, num_values, comp_type, constant, bitmap);
+  }
+
+  /**
+   * Compares with the kernels of a given instruction set, which must be supported by this CPU.
+   */
+  template <typename T>
+  static void Compare(Isa isa, const T *values, size_t num_values, ComparisonType comp_type, T constant,
+                      uint64_t *bitmap);
+};
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key_encoder.h
+//
+// Identification: src/include/execution/sort_key_encoder.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortKeyEncoder encodes the ORDER BY keys of a tuple into a fixed-width string of bytes whose memcmp() order is the
+ * sort order, so that sorts compare keys without evaluating or comparing any Value.
+ *
+ * Each key is a null byte followed by its value in big-endian, with the sign bit flipped for signed types; all its
+ * bytes are inverted for a descending key. Varchars only keep a prefix of VARCHAR_PREFIX_SIZE bytes, so keys with
+ * varchars are not exact: the bytes past the first varchar do not decide anything, and equal encodings must be told
+ * apart with CompareValues().
+ */
+class SortKeyEncoder {
+ public:
+  /** Bytes of a varchar that are encoded in the key. */
+  static constexpr size_t VARCHAR_PREFIX_SIZE = 16;
+
+  /**
+   * Creates an encoder.
+   * @param order_bys the keys to encode, most significant first
+   */
+  explicit SortKeyEncoder(const std::vector<OrderBy> &order_bys);
+
+  /** @return the size of an encoded key, in bytes */
+  size_t KeyWidth() const { return key_width_; }
+
+  /** @return true if tuples with equal encoded keys are always equal in the sort order */
+  bool IsExact() const { return exact_; }
+
+  /**
+   * Encodes the keys of the selected rows of a batch.
+   * @param batch the rows to encode
+   * @param[out] keys KeyWidth() bytes per selected row are appended here, in the order of the selection
+   */
+  void EncodeBatch(const TupleBatch &batch, std::vector<uint8_t> *keys);
+
+  /**
+   * Encodes the key of a tuple.
+   * @param tuple the tuple to encode
+   * @param schema the schema of the tuple
+   * @param[out] key KeyWidth() bytes
+   */
+  void Encode(const Tuple &tuple, const Schema *schema, uint8_t *key) const;
+
+  /**
+   * Compares two encoded keys, as far as they can tell.
+   * @return a negative number or a positive number if a sorts before or after b, or zero if the keys cannot tell
+   * and IsExact() is false
+   */
+  int CompareKeys(const uint8_t *a_key, const uint8_t *b_key) const {
+    return std::memcmp(a_key, b_key, compare_width_);
+  }
+
+  /**
+   * Compares two tuples in the sort order, looking at their values only if their encoded keys cannot tell.
+   * @return a negative number, zero or a positive number if a sorts before, with or after b
+   */
+  int Compare(const uint8_t *a_key, const Tuple &a, const uint8_t *b_key, const Tuple &b, const Schema *schema) const;
+
+  /**
+   * Compares two tuples in the sort order by their values.
+   * @return a negative number, zero or a positive number if a sorts before, with or after b
+   */
+  int CompareValues(const Tuple &a, const Tuple &b, const Schema *schema) const;
+
+ private:
+  /** Encodes the value of key key_idx at out. */
+  void EncodeValue(size_t key_idx, const Value &value, uint8_t *out) const;
+
+  std::vector<OrderBy> order_bys_;
+  /** The offset of each key in the encoding. */
+  std::vector<size_t> offsets_;
+  size_t key_width_{0};
+  /** The bytes that CompareKeys() looks at: up to the end of the first varchar, or the whole key. */
+  size_t compare_width_{0};
+  bool exact_{true};
+  /** The values of each key that has to be computed, indexed by physical row, for EncodeBatch(). */
+  std::vector<std::vector<Value>> columns_;
+};
+
+}  // namespace bustub
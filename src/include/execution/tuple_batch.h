@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch holds up to BATCH_SIZE rows in column-major order, and is what executors exchange in the vectorized
+ * execution model (see AbstractExecutor::NextBatch).
+ *
+ * Rows are addressed by their physical index. The selection vector lists the physical rows that are still live, in
+ * order; filters narrow the selection instead of moving values around. Consumers must only look at selected rows.
+ */
+class TupleBatch {
+ public:
+  /** Maximum number of rows in a batch. */
+  static constexpr uint32_t BATCH_SIZE = 1024;
+
+  TupleBatch() = default;
+
+  /**
+   * Empties the batch and sets its number of columns.
+   * @param num_columns the number of columns of the rows that will be appended
+   */
+  void Reset(uint32_t num_columns);
+
+  /** @return the number of columns */
+  uint32_t NumColumns() const { return static_cast<uint32_t>(columns_.size()); }
+
+  /** @return the number of physical rows, selected or not */
+  uint32_t NumRows() const { return num_rows_; }
+
+  /** @return the number of selected rows */
+  uint32_t NumSelected() const { return static_cast<uint32_t>(selection_.size()); }
+
+  /** @return true if no more rows can be appended */
+  bool IsFull() const { return num_rows_ >= BATCH_SIZE; }
+
+  /** @return true if no row is selected */
+  bool IsEmpty() const { return selection_.empty(); }
+
+  /** @return the physical indexes of the selected rows */
+  const std::vector<uint32_t> &GetSelection() const { return selection_; }
+
+  /** @return the values of column col_idx, indexed by physical row */
+  const std::vector<Value> &GetColumn(uint32_t col_idx) const { return columns_[col_idx]; }
+
+  /** @return the values of column col_idx, indexed by physical row */
+  std::vector<Value> *GetMutableColumn(uint32_t col_idx) { return &columns_[col_idx]; }
+
+  /** @return the value at physical row row_idx of column col_idx */
+  const Value &GetValue(uint32_t row_idx, uint32_t col_idx) const { return columns_[col_idx][row_idx]; }
+
+  /**
+   * Appends a row and selects it.
+   * @param values one value per column
+   */
+  void AppendRow(const std::vector<Value> &values);
+
+  /**
+   * Appends a tuple as a row and selects it.
+   * @param tuple the tuple to append
+   * @param schema the schema of the tuple, which must have NumColumns() columns
+   */
+  void AppendTuple(const Tuple &tuple, const Schema *schema);
+
+  /**
+   * Appends physical row row_idx of another batch with the same number of columns, and selects it.
+   */
+  void AppendRowFrom(const TupleBatch &other, uint32_t row_idx);
+
+  /**
+   * Sets the number of physical rows after the columns were filled directly through GetMutableColumn(), and selects
+   * all of them.
+   */
+  void SetNumRows(uint32_t num_rows);
+
+  /**
+   * Narrows the selection to the rows for which the predicate is true; a null result does not pass.
+   * @param predicate boolean values indexed by physical row, as produced by AbstractExpression::EvaluateBatch
+   */
+  void Filter(const std::vector<Value> &predicate);
+
+  /**
+   * Narrows the selection to the rows that are kept.
+   * @param keep one flag per physical row
+   */
+  void Filter(const std::vector<bool> &keep);
+
+  /**
+   * Narrows the selection to the rows for which keep(row_idx) is true.
+   */
+  template <typename Keep>
+  void FilterRows(Keep &&keep) {
+    uint32_t num_selected = 0;
+    for (uint32_t row_idx : selection_) {
+      if (keep(row_idx)) {
+        selection_[num_selected++] = row_idx;
+      }
+    }
+    selection_.resize(num_selected);
+  }
+
+  /**
+   * Materializes a row as a tuple.
+   * @param row_idx the physical row
+   * @param schema the schema of the tuple to build
+   * @return the row as a tuple
+   */
+  Tuple GetTuple(uint32_t row_idx, const Schema *schema) const;
+
+ private:
+  /** One vector of values per column, indexed by physical row. */
+  std::vector<std::vector<Value>> columns_;
+  /** Physical indexes of the selected rows. */
+  std::vector<uint32_t> selection_;
+  uint32_t num_rows_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.h
+//
+// Identification: src/include/execution/worker_pool.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * WorkerPool is a fixed set of threads that run the parallel parts of a query plan.
+ *
+ * Work is handed out with RunOnAll(), which runs the same task on every worker and waits for all of them. The
+ * task itself decides what each worker does, typically by pulling morsels from a shared MorselQueue until it is
+ * drained. RunOnAll() must not be called from inside a task.
+ */
+class WorkerPool {
+ public:
+  /**
+   * Starts the workers.
+   * @param num_workers the number of worker threads
+   */
+  explicit WorkerPool(size_t num_workers);
+
+  /** Stops and joins the workers. */
+  ~WorkerPool();
+
+  DISALLOW_COPY_AND_MOVE(WorkerPool);
+
+  /** @return the number of worker threads */
+  size_t NumWorkers() const { return workers_.size(); }
+
+  /**
+   * Runs task(worker_id) once on every worker, with worker_id in [0, NumWorkers()), and waits until all are done.
+   * @param task the task to run
+   */
+  void RunOnAll(const std::function<void(size_t)> &task);
+
+ private:
+  void WorkerLoop(size_t worker_id);
+
+  std::vector<std::thread> workers_;
+  /** Serializes RunOnAll() callers. */
+  std::mutex run_latch_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(size_t)> *task_{nullptr};
+  /** Incremented for every task, so that workers can tell a new task from a spurious wakeup. */
+  uint64_t generation_{0};
+  size_t num_running_{0};
+  bool shutdown_{false};
+};
+
+}  // namespace bustub
@@ -132,6 +132,15 @@ class Index {
   // designed for secondary indexes.
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  // insert many entries at once, e.g. after a bulk load: keys[i] is the key of rids[i].
+  // num_threads is a hint for indexes that can insert in parallel.
+  virtual void InsertEntries(const std::vector<Tuple> &keys, const std::vector<RID> &rids, Transaction *transaction,
+                             size_t num_threads) {
+    for (size_t i = 0; i < keys.size(); i++) {
+      InsertEntry(keys[i], rids[i], transaction);
+    }
+  }
+
   // delete the index entry linked to given tuple
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
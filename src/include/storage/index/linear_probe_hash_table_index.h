@@ -34,6 +34,10 @@ class LinearProbeHashTableIndex : public Index {
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  /** Loads the entries into the hash table with LinearProbeHashTable::BulkLoad. */
+  void InsertEntries(const std::vector<Tuple> &keys, const std::vector<RID> &rids, Transaction *transaction,
+                     size_t num_threads) override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
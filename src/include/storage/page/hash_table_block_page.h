@@ -26,12 +26,15 @@ namespace bustub {
  * non-unique keys.
  *
  * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------
+ * | Version (4) | Occupied bitmap | Readable bitmap | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
+ * The version is a sequence counter that lets readers scan the page without taking the page latch. Writers (which
+ * still hold the page write latch) make it odd before modifying the page and even again afterwards. A reader records
+ * an even version with GetVersion(), copies what it needs, and keeps the copy only if ValidateVersion() succeeds.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -93,7 +96,24 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Reads the version counter for an optimistic read. Spins while a writer is modifying the page.
+   *
+   * @return the (even) version observed before the read
+   */
+  uint32_t GetVersion() const;
+
+  /**
+   * Checks whether the page has been modified since GetVersion() returned version.
+   *
+   * @param version the version returned by GetVersion()
+   * @return true if everything read since then is consistent, false if the read must be retried
+   */
+  bool ValidateVersion(uint32_t version) const;
+
  private:
+  std::atomic<uint32_t> version_;
+
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
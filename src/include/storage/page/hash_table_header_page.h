@@ -26,13 +26,22 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 32 bytes in total, padding included):
+ * ---------------------------------------------------------------------------
+ * | LSN (4) | Size (8) | PageId(4) | Level (4) | NextBlockIndex(8) | PageIds...
+ * ---------------------------------------------------------------------------
+ *
+ * A single header page can only reference MAX_NUM_BLOCKS pages. Larger tables use a tree of header pages: a header
+ * page at level 0 lists block page ids, a header page at level n > 0 lists the page ids of level n - 1 header pages.
  */
 class HashTableHeaderPage {
  public:
+  /** Size of the fixed part of the header page, before the page id array. */
+  static constexpr size_t HEADER_METADATA_SIZE = 32;
+
+  /** Maximum number of page ids one header page can hold. */
+  static constexpr size_t MAX_NUM_BLOCKS = (PAGE_SIZE - HEADER_METADATA_SIZE) / sizeof(page_id_t);
+
   /**
    * @return the number of buckets in the hash table;
    */
@@ -69,6 +78,18 @@ class HashTableHeaderPage {
    */
   void SetLSN(lsn_t lsn);
 
+  /**
+   * @return the level of this page in the header page tree, 0 if it lists block pages
+   */
+  uint32_t GetLevel() const;
+
+  /**
+   * Sets the level of this page in the header page tree
+   *
+   * @param level the level for the level field to be set to
+   */
+  void SetLevel(uint32_t level);
+
   /**
    * Adds a block page_id to the end of header page
    *
@@ -93,6 +114,7 @@ class HashTableHeaderPage {
   __attribute__((unused)) lsn_t lsn_;
   __attribute__((unused)) size_t size_;
   __attribute__((unused)) page_id_t page_id_;
+  __attribute__((unused)) uint32_t level_;
   __attribute__((unused)) size_t next_ind_;
   __attribute__((unused)) page_id_t block_page_ids_[0];
 };
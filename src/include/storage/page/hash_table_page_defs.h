@@ -14,11 +14,14 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
+/** BLOCK_PAGE_HEADER_SIZE is the number of bytes reserved at the start of a block page for its version counter. */
+#define BLOCK_PAGE_HEADER_SIZE sizeof(uint32_t)
+
 /** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
  * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
  * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
  * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+ * and readable flags for a key value pair. The block page header is subtracted from PAGE_SIZE first.*/
+#define BLOCK_ARRAY_SIZE (4 * (PAGE_SIZE - BLOCK_PAGE_HEADER_SIZE) / (4 * sizeof(MappingType) + 1))
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
@@ -83,6 +83,15 @@ class TablePage : public Page {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Append a tuple after the tuples of a page that is being filled by a bulk load. Unlike InsertTuple, this neither
+   * looks for the slot of a deleted tuple to reuse nor locks or logs the new tuple.
+   * @param tuple tuple to append
+   * @param[out] rid rid of the appended tuple
+   * @return true if the append is successful (i.e. there is enough space)
+   */
+  bool AppendTuple(const Tuple &tuple, RID *rid);
+
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
@@ -137,6 +146,40 @@ class TablePage : public Page {
    */
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
+  /**
+   * Visits the tuples of this page in place, without copying them out. func(tuple) is called on every live tuple
+   * from slot *slot_num on, with a view of the page data that is only valid during the call; scanning stops after
+   * the first tuple for which func returns false.
+   * @param[in,out] slot_num the slot to start from, set to the slot to resume from
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @param func the visitor
+   * @return true if the page was scanned to the end
+   */
+  template <typename Func>
+  bool ScanTuples(uint32_t *slot_num, Transaction *txn, LockManager *lock_manager, Func &&func) {
+    uint32_t tuple_count = GetTupleCount();
+    while (*slot_num < tuple_count) {
+      uint32_t slot = (*slot_num)++;
+      uint32_t tuple_size = GetTupleSize(slot);
+      if (IsDeleted(tuple_size)) {
+        continue;
+      }
+      RID rid(GetTablePageId(), slot);
+      if (enable_logging) {
+        if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+          continue;
+        }
+      }
+      Tuple tuple(GetData() + GetTupleOffsetAtSlot(slot), tuple_size);
+      tuple.rid_ = rid;
+      if (!func(static_cast<const Tuple &>(tuple))) {
+        break;
+      }
+    }
+    return *slot_num == tuple_count;
+  }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
@@ -20,14 +22,65 @@ namespace bustub {
  */
 class TmpTuplePage : public Page {
  public:
-  void Init(page_id_t page_id, uint32_t page_size) {}
+  /**
+   * Initializes an empty page.
+   * @param page_id the page id of this page
+   * @param page_size the size of the page
+   */
+  void Init(page_id_t page_id, uint32_t page_size) {
+    memcpy(GetData() + OFFSET_PAGE_ID, &page_id, sizeof(page_id_t));
+    SetFreeSpacePointer(page_size);
+  }
+
+  /** @return the page id of this page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PAGE_ID); }
+
+  /**
+   * Inserts a tuple at the end of the free space.
+   * @param tuple the tuple to insert
+   * @param[out] out the location of the inserted tuple
+   * @return false if the page does not have enough free space left
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    uint32_t free_space_pointer = GetFreeSpacePointer();
+    if (free_space_pointer < SIZE_TMP_PAGE_HEADER + size) {
+      return false;
+    }
+    free_space_pointer -= size;
+    tuple.SerializeTo(GetData() + free_space_pointer);
+    SetFreeSpacePointer(free_space_pointer);
+    *out = TmpTuple(GetTablePageId(), free_space_pointer);
+    return true;
+  }
+
+  /**
+   * Reads a tuple back.
+   * @param offset the offset of the tuple, as returned by Insert()
+   * @param[out] tuple the tuple
+   */
+  void Get(size_t offset, Tuple *tuple) { tuple->DeserializeFrom(GetData() + offset); }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /** @return the offset of the most recently inserted tuple, or the page size if the page is empty */
+  uint32_t GetFirstOffset() { return GetFreeSpacePointer(); }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /** @return the offset of the tuple inserted right before the one at offset, or the page size if there is none */
+  uint32_t GetNextOffset(size_t offset) {
+    return offset + sizeof(uint32_t) + *reinterpret_cast<uint32_t *>(GetData() + offset);
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t SIZE_TMP_PAGE_HEADER = 12;
+  static constexpr size_t OFFSET_PAGE_ID = 0;
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
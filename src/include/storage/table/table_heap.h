@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -59,6 +63,25 @@ class TableHeap {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
 
+  /**
+   * Insert many tuples, e.g. for a bulk load. Unlike InsertTuple, which looks for space from the first page on, this
+   * appends at the end of the table: it starts from the last page that was filled this way, keeps each page pinned
+   * and latched until it is full, and then moves on to the next page or creates a new one. Space freed by deletes in
+   * earlier pages is not reused. If a tuple is too large, nothing is inserted.
+   * @param tuples tuples to insert
+   * @param[out] rids rids[i] is the rid of tuples[i]; on failure, the rids of the tuples that were inserted
+   * @param txn the transaction performing the insert
+   * @return true iff all inserts are successful
+   */
+  bool InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn);
+
+  /**
+   * Link pages at the end of the table, e.g. the pages filled by a bulk load. The pages must be initialized table
+   * pages that are in no table yet. They are linked in order, and InsertTuples goes on from the last one.
+   * @param page_ids ids of the pages to link
+   */
+  void AppendPages(const std::vector<page_id_t> &page_ids);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -99,6 +122,59 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read many tuples, fetching each page only once for consecutive rids on the same page. Sorting the rids by page
+   * first makes every page be fetched once.
+   * @param rids rids of the tuples to read
+   * @param[out] tuples tuples[i] is the tuple of rids[i]
+   * @param[out] found found[i] is true if the tuple of rids[i] exists
+   * @param txn transaction performing the read
+   */
+  void GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, std::vector<bool> *found, Transaction *txn);
+
+  /**
+   * Read all tuples stored in one page of the table.
+   * @param page_id id of a page of this table
+   * @param[out] tuples the tuples of the page are appended here
+   * @param txn transaction performing the read
+   */
+  void GetPageTuples(page_id_t page_id, std::vector<Tuple> *tuples, Transaction *txn);
+
+  /**
+   * Visits the tuples of one page of the table in place, see TablePage::ScanTuples. The page stays pinned and latched
+   * while func runs.
+   * @param page_id id of a page of this table
+   * @param[in,out] slot_num the slot to start from, set to the slot to resume from
+   * @param[out] next_page_id the id of the page that follows page_id in the table
+   * @param txn transaction performing the read
+   * @param func the visitor, called with a view of each tuple
+   * @return true if the page was scanned to the end
+   */
+  template <typename Func>
+  bool ScanPage(page_id_t page_id, uint32_t *slot_num, page_id_t *next_page_id, Transaction *txn, Func &&func) {
+    return ScanPage(page_id, slot_num, next_page_id, txn, std::forward<Func>(func), []() {});
+  }
+
+  /**
+   * Same as above, but calls end_func() once the tuples were visited and before the page is unlatched and unpinned,
+   * so that the views that func got remain valid until end_func returns.
+   */
+  template <typename Func, typename EndFunc>
+  bool ScanPage(page_id_t page_id, uint32_t *slot_num, page_id_t *next_page_id, Transaction *txn, Func &&func,
+                EndFunc &&end_func) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    bool done = page->ScanTuples(slot_num, txn, lock_manager_, std::forward<Func>(func));
+    end_func();
+    *next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return done;
+  }
+
+  /** @return the ids of all pages of this table, in chain order */
+  std::vector<page_id_t> GetPageIds();
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -113,6 +189,8 @@ class TableHeap {
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** The page InsertTuples starts from; the free space of the pages before it is left to InsertTuple. */
+  std::atomic<page_id_t> last_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -21,22 +21,32 @@
 namespace bustub {
 
 class TableHeap;
+class TablePage;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * The iterator keeps the page of its current tuple pinned and read-latched, and hands out the tuple as a view of the
+ * page data, valid until the iterator moves or is destroyed. Each page is thus fetched once, and no tuple is copied.
+ * The caller must not write to the table through the same thread while the iterator stands on one of its pages.
+ * A copy of an iterator owns a copy of the current tuple instead, and holds no page until it is advanced.
  */
 class TableIterator {
   friend class Cursor;
 
  public:
+  /**
+   * Creates an iterator on the first tuple at or after rid, or the end iterator if rid is invalid.
+   */
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
-  TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+  TableIterator(const TableIterator &other);
 
-  ~TableIterator() { delete tuple_; }
+  TableIterator &operator=(const TableIterator &other);
 
-  inline bool operator==(const TableIterator &itr) const { return tuple_->rid_.Get() == itr.tuple_->rid_.Get(); }
+  ~TableIterator() { Release(); }
+
+  inline bool operator==(const TableIterator &itr) const { return tuple_.rid_.Get() == itr.tuple_.rid_.Get(); }
 
   inline bool operator!=(const TableIterator &itr) const { return !(*this == itr); }
 
@@ -49,8 +59,25 @@ class TableIterator {
   TableIterator operator++(int);
 
  private:
+  /** Pins and read-latches a page, which becomes the current page. */
+  void Pin(page_id_t page_id);
+
+  /** Unlatches and unpins the current page, if any. */
+  void Release();
+
+  /** Moves to the first tuple from slot_num_ of the current page on, following the page chain; or to the end. */
+  void Seek();
+
+  /** Makes this iterator a detached copy of other. */
+  void CopyFrom(const TableIterator &other);
+
   TableHeap *table_heap_;
-  Tuple *tuple_;
+  /** The pinned page of the current tuple, or nullptr at the end or in a copy. */
+  TablePage *page_{nullptr};
+  /** The slot of the current page to look at next. */
+  uint32_t slot_num_{0};
+  /** The current tuple: a view of page_, or an owned copy if page_ is nullptr. */
+  Tuple tuple_;
   Transaction *txn_;
 };
 
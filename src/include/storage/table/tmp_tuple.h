@@ -4,8 +4,9 @@
 
 namespace bustub {
 
-// Document this class! What does it represent?
-
+/**
+ * TmpTuple is the location of a tuple in a TmpTuplePage: the page id and the offset of the tuple within the page.
+ */
 class TmpTuple {
  public:
   TmpTuple(page_id_t page_id, size_t offset) : page_id_(page_id), offset_(offset) {}
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_heap.h
+//
+// Identification: src/include/storage/table/tmp_tuple_heap.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tmp_tuple.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleHeap is an append-only list of TmpTuplePages, used by executors to spill intermediate tuples through the
+ * buffer pool once they no longer fit in memory. No page stays pinned between calls, so the buffer pool is free to
+ * write the pages out to disk. The pages are deleted with the heap.
+ */
+class TmpTupleHeap {
+ public:
+  /**
+   * Creates an empty heap.
+   * @param buffer_pool_manager the buffer pool manager to allocate pages from
+   */
+  explicit TmpTupleHeap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /** Deletes every page of the heap. */
+  ~TmpTupleHeap();
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleHeap);
+
+  /**
+   * Appends a tuple, allocating a new page if the last one is full.
+   * @param tuple the tuple to append, which must fit in an empty page
+   * @return the location of the appended tuple
+   */
+  TmpTuple Append(const Tuple &tuple);
+
+  /**
+   * Reads back a tuple.
+   * @param tmp_tuple the location returned by Append()
+   * @param[out] tuple the tuple
+   */
+  void Get(const TmpTuple &tmp_tuple, Tuple *tuple);
+
+  /**
+   * Reads all tuples of one page, in no particular order.
+   * @param page_idx the position of the page in the heap, in [0, NumPages())
+   * @param[out] tuples the tuples of the page are appended here
+   */
+  void GetPageTuples(size_t page_idx, std::vector<Tuple> *tuples);
+
+  /** @return the number of pages in the heap */
+  size_t NumPages() const { return page_ids_.size(); }
+
+  /** @return the number of tuples in the heap */
+  size_t NumTuples() const { return num_tuples_; }
+
+  /** @return the total size of the tuples in the heap, in bytes */
+  size_t NumBytes() const { return num_bytes_; }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  std::vector<page_id_t> page_ids_;
+  size_t num_tuples_{0};
+  size_t num_bytes_{0};
+};
+
+}  // namespace bustub
@@ -41,6 +41,9 @@ class Tuple {
   // constructor for table heap tuple
   explicit Tuple(RID rid) : rid_(rid) {}
 
+  // constructor for a tuple that points to data owned elsewhere, e.g. by a join hash table (shallow, never freed)
+  Tuple(char *data, uint32_t size) : size_(size), data_(data) {}
+
   // constructor for creating a new tuple based on input value
   Tuple(std::vector<Value> values, const Schema *schema);
 
@@ -63,6 +66,9 @@ class Tuple {
   // deserialize tuple data(deep copy)
   void DeserializeFrom(const char *storage);
 
+  // deep copy of another tuple, also of one that points to data owned elsewhere, e.g. a view of a table page
+  void CopyFrom(const Tuple &other);
+
   // return RID of current tuple
   inline RID GetRid() const { return rid_; }
 
@@ -76,6 +82,9 @@ class Tuple {
   // checks the schema to see how to return the Value.
   Value GetValue(const Schema *schema, uint32_t column_idx) const;
 
+  // Get the key of an index over this tuple: the key_attrs columns of schema, laid out as in key_schema
+  Tuple KeyFromTuple(const Schema *schema, const Schema *key_schema, const std::vector<uint32_t> &key_attrs) const;
+
   // Is the column value null ?
   inline bool IsNull(const Schema *schema, uint32_t column_idx) const {
     Value value = GetValue(schema, column_idx);
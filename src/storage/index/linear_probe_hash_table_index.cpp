@@ -1,3 +1,4 @@
+#include <utility>
 #include <vector>
 
 #include "storage/index/linear_probe_hash_table_index.h"
@@ -22,6 +23,17 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   container_.Insert(transaction, index_key, rid);
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::InsertEntries(const std::vector<Tuple> &keys, const std::vector<RID> &rids,
+                                          Transaction *transaction, size_t num_threads) {
+  std::vector<std::pair<KeyType, ValueType>> entries(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    entries[i].first.SetFromKey(keys[i]);
+    entries[i].second = rids[i];
+  }
+  container_.BulkLoad(transaction, entries, num_threads);
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
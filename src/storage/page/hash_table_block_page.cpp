@@ -9,6 +9,8 @@
 // Copyright (c) 2015-2019, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <thread>  // NOLINT
+
 #include "storage/page/hash_table_block_page.h"
 #include "storage/index/generic_key.h"
 #include "common/logger.h"
@@ -28,16 +30,20 @@ namespace bustub {
     bool HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) {
         if (IsReadable(bucket_ind)) return false;
 
-        readable_[bucket_ind / 8] |= (1 << (bucket_ind % 8));
-        occupied_[bucket_ind / 8] |= (1 << (bucket_ind % 8));
+        version_.fetch_add(1, std::memory_order_acq_rel);
         array_[bucket_ind] = MappingType(key, value);
+        occupied_[bucket_ind / 8] |= (1 << (bucket_ind % 8));
+        readable_[bucket_ind / 8] |= (1 << (bucket_ind % 8));
+        version_.fetch_add(1, std::memory_order_release);
         return true;
     }
 
     template<typename KeyType, typename ValueType, typename KeyComparator>
     void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
         if (!IsOccupied((bucket_ind))) return;
+        version_.fetch_add(1, std::memory_order_acq_rel);
         readable_[bucket_ind / 8] &= ~(1 << bucket_ind % 8);
+        version_.fetch_add(1, std::memory_order_release);
     }
 
     template<typename KeyType, typename ValueType, typename KeyComparator>
@@ -50,6 +56,23 @@ namespace bustub {
         return readable_[bucket_ind / 8] & (1 << (bucket_ind % 8));
     }
 
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    uint32_t HASH_TABLE_BLOCK_TYPE::GetVersion() const {
+        uint32_t version = version_.load(std::memory_order_acquire);
+        while (version % 2 == 1) {
+            std::this_thread::yield();
+            version = version_.load(std::memory_order_acquire);
+        }
+        return version;
+    }
+
+    template<typename KeyType, typename ValueType, typename KeyComparator>
+    bool HASH_TABLE_BLOCK_TYPE::ValidateVersion(uint32_t version) const {
+        // Order the preceding plain reads of array_ before the version re-check.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == version;
+    }
+
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
     template
     class HashTableBlockPage<int, int, IntComparator>;
@@ -12,7 +12,12 @@
 
 #include "storage/page/hash_table_header_page.h"
 
+#include "common/macros.h"
+
 namespace bustub {
+    static_assert(sizeof(HashTableHeaderPage) == HashTableHeaderPage::HEADER_METADATA_SIZE,
+                  "Header page metadata size mismatch");
+
     page_id_t HashTableHeaderPage::GetBlockPageId(size_t index) { return block_page_ids_[index]; }
 
     page_id_t HashTableHeaderPage::GetPageId() const { return page_id_; }
@@ -23,7 +28,14 @@ namespace bustub {
 
     void HashTableHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
-    void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) { block_page_ids_[next_ind_++] = page_id; }
+    uint32_t HashTableHeaderPage::GetLevel() const { return level_; }
+
+    void HashTableHeaderPage::SetLevel(uint32_t level) { level_ = level; }
+
+    void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+        BUSTUB_ASSERT(next_ind_ < MAX_NUM_BLOCKS, "Header page is full.");
+        block_page_ids_[next_ind_++] = page_id;
+    }
 
     size_t HashTableHeaderPage::NumBlocks() { return next_ind_; }
 
@@ -85,6 +85,21 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
   return true;
 }
 
+bool TablePage::AppendTuple(const Tuple &tuple, RID *rid) {
+  BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
+    return false;
+  }
+  uint32_t slot = GetTupleCount();
+  SetFreeSpacePointer(GetFreeSpacePointer() - tuple.size_);
+  memcpy(GetData() + GetFreeSpacePointer(), tuple.data_, tuple.size_);
+  SetTupleOffsetAtSlot(slot, GetFreeSpacePointer());
+  SetTupleSize(slot, tuple.size_);
+  SetTupleCount(slot + 1);
+  rid->Set(GetTablePageId(), slot);
+  return true;
+}
+
 bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
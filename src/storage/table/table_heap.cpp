@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -22,7 +23,8 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      last_page_id_(first_page_id) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
@@ -34,6 +36,7 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  last_page_id_ = first_page_id_;
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
@@ -90,6 +93,102 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
   return true;
 }
 
+bool TableHeap::InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) {
+  rids->clear();
+  for (const auto &tuple : tuples) {
+    if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  if (tuples.empty()) {
+    return true;
+  }
+  rids->reserve(tuples.size());
+
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (cur_page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  cur_page->WLatch();
+  // Whether cur_page was modified.
+  bool is_dirty = false;
+  RID rid;
+  for (const auto &tuple : tuples) {
+    // Fill the current page until the tuple does not fit, then move on to the next page, appending it if needed.
+    // INVARIANT: cur_page is pinned and WLatched.
+    while (!cur_page->InsertTuple(tuple, &rid, txn, lock_manager_, log_manager_)) {
+      auto next_page_id = cur_page->GetNextPageId();
+      bool is_new = next_page_id == INVALID_PAGE_ID;
+      TablePage *next_page;
+      if (!is_new) {
+        next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      } else {
+        next_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      }
+      if (next_page == nullptr) {
+        cur_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), is_dirty);
+        txn->SetState(TransactionState::ABORTED);
+        return false;
+      }
+      next_page->WLatch();
+      if (is_new) {
+        cur_page->SetNextPageId(next_page_id);
+        next_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      }
+      cur_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), is_dirty || is_new);
+      cur_page = next_page;
+      // A new page must be written back even if nothing ends up in it.
+      is_dirty = is_new;
+      last_page_id_ = next_page_id;
+    }
+    is_dirty = true;
+    rids->push_back(rid);
+    // Update the transaction's write set.
+    txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
+  }
+  cur_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  return true;
+}
+
+void TableHeap::AppendPages(const std::vector<page_id_t> &page_ids) {
+  if (page_ids.empty()) {
+    return;
+  }
+  // Find the last page of the table.
+  // INVARIANT: prev_page is pinned and WLatched.
+  auto prev_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  BUSTUB_ASSERT(prev_page != nullptr, "Couldn't fetch a page of the table heap.");
+  prev_page->WLatch();
+  while (prev_page->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page_id = prev_page->GetNextPageId();
+    prev_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), false);
+    prev_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    BUSTUB_ASSERT(prev_page != nullptr, "Couldn't fetch a page of the table heap.");
+    prev_page->WLatch();
+  }
+  // Link every page after it.
+  for (auto page_id : page_ids) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page to append to the table heap.");
+    page->WLatch();
+    prev_page->SetNextPageId(page_id);
+    page->SetPrevPageId(prev_page->GetTablePageId());
+    page->SetNextPageId(INVALID_PAGE_ID);
+    prev_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), true);
+    prev_page = page;
+  }
+  last_page_id_ = prev_page->GetTablePageId();
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), true);
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -169,16 +268,65 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
-  // Start an iterator from the first page.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+void TableHeap::GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, std::vector<bool> *found,
+                          Transaction *txn) {
+  tuples->resize(rids.size());
+  found->assign(rids.size(), false);
+  size_t begin = 0;
+  while (begin < rids.size()) {
+    // Read the run of rids on the same page while the page is pinned.
+    page_id_t page_id = rids[begin].GetPageId();
+    size_t end = begin + 1;
+    while (end < rids.size() && rids[end].GetPageId() == page_id) {
+      end++;
+    }
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return;
+    }
+    page->RLatch();
+    for (size_t i = begin; i < end; i++) {
+      (*found)[i] = page->GetTuple(rids[i], &(*tuples)[i], txn, lock_manager_);
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    begin = end;
+  }
+}
+
+void TableHeap::GetPageTuples(page_id_t page_id, std::vector<Tuple> *tuples, Transaction *txn) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
   page->RLatch();
   RID rid;
-  // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-  page->GetFirstTupleRid(&rid);
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    tuples->emplace_back();
+    if (!page->GetTuple(rid, &tuples->back(), txn, lock_manager_)) {
+      tuples->pop_back();
+    }
+  }
   page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(first_page_id_, false);
-  return TableIterator(this, rid, txn);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+}
+
+std::vector<page_id_t> TableHeap::GetPageIds() {
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids.push_back(page_id);
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return page_ids;
+}
+
+TableIterator TableHeap::Begin(Transaction *txn) {
+  // Start an iterator from the first tuple of the first page that has one.
+  return TableIterator(this, RID(first_page_id_, 0), txn);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
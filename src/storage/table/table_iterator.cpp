@@ -17,50 +17,93 @@
 namespace bustub {
 
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+    : table_heap_(table_heap), tuple_(RID(INVALID_PAGE_ID, 0)), txn_(txn) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    Pin(rid.GetPageId());
+    slot_num_ = rid.GetSlotNum();
+    Seek();
+  }
+}
+
+TableIterator::TableIterator(const TableIterator &other) : table_heap_(other.table_heap_), txn_(other.txn_) {
+  CopyFrom(other);
+}
+
+TableIterator &TableIterator::operator=(const TableIterator &other) {
+  if (this != &other) {
+    Release();
+    table_heap_ = other.table_heap_;
+    txn_ = other.txn_;
+    CopyFrom(other);
+  }
+  return *this;
+}
+
+void TableIterator::CopyFrom(const TableIterator &other) {
+  if (other.tuple_.rid_.GetPageId() == INVALID_PAGE_ID) {
+    tuple_ = Tuple(RID(INVALID_PAGE_ID, 0));
+  } else {
+    tuple_.CopyFrom(other.tuple_);
+  }
+}
+
+void TableIterator::Pin(page_id_t page_id) {
+  page_ = static_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(page_id));
+  assert(page_ != nullptr);
+  page_->RLatch();
+}
+
+void TableIterator::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+    page_ = nullptr;
+  }
+}
+
+void TableIterator::Seek() {
+  while (true) {
+    bool found = false;
+    page_->ScanTuples(&slot_num_, txn_, table_heap_->lock_manager_, [&](const Tuple &tuple) {
+      tuple_ = tuple;
+      found = true;
+      return false;
+    });
+    if (found) {
+      return;
+    }
+    // End of this page.
+    page_id_t next_page_id = page_->GetNextPageId();
+    Release();
+    if (next_page_id == INVALID_PAGE_ID) {
+      tuple_ = Tuple(RID(INVALID_PAGE_ID, 0));
+      return;
+    }
+    Pin(next_page_id);
+    slot_num_ = 0;
   }
 }
 
 const Tuple &TableIterator::operator*() {
   assert(*this != table_heap_->End());
-  return *tuple_;
+  return tuple_;
 }
 
 Tuple *TableIterator::operator->() {
   assert(*this != table_heap_->End());
-  return tuple_;
+  return &tuple_;
 }
 
 TableIterator &TableIterator::operator++() {
-  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
-
-  RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
-        break;
-      }
+  if (page_ == nullptr) {
+    // A copy: resume from its tuple.
+    if (tuple_.rid_.GetPageId() == INVALID_PAGE_ID) {
+      return *this;
     }
+    Pin(tuple_.rid_.GetPageId());
+    slot_num_ = tuple_.rid_.GetSlotNum() + 1;
   }
-  tuple_->rid_ = next_tuple_rid;
-
-  if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
-  }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  Seek();
   return *this;
 }
 
@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_heap.cpp
+//
+// Identification: src/storage/table/tmp_tuple_heap.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_heap.h"
+
+#include <vector>
+
+namespace bustub {
+
+TmpTupleHeap::~TmpTupleHeap() {
+  for (auto page_id : page_ids_) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+}
+
+TmpTuple TmpTupleHeap::Append(const Tuple &tuple) {
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  if (!page_ids_.empty()) {
+    auto page = reinterpret_cast<TmpTuplePage *>(buffer_pool_manager_->FetchPage(page_ids_.back()));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the tmp tuple heap.");
+    bool inserted = page->Insert(tuple, &tmp_tuple);
+    buffer_pool_manager_->UnpinPage(page_ids_.back(), inserted);
+    if (inserted) {
+      num_tuples_++;
+      num_bytes_ += tuple.GetLength();
+      return tmp_tuple;
+    }
+  }
+
+  // The last page is full, or there is none yet.
+  page_id_t page_id;
+  auto page = reinterpret_cast<TmpTuplePage *>(buffer_pool_manager_->NewPage(&page_id));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't create a page for the tmp tuple heap.");
+  page->Init(page_id, PAGE_SIZE);
+  bool inserted = page->Insert(tuple, &tmp_tuple);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  BUSTUB_ASSERT(inserted, "Tuple does not fit in a tmp tuple page.");
+  page_ids_.push_back(page_id);
+  num_tuples_++;
+  num_bytes_ += tuple.GetLength();
+  return tmp_tuple;
+}
+
+void TmpTupleHeap::Get(const TmpTuple &tmp_tuple, Tuple *tuple) {
+  auto page = reinterpret_cast<TmpTuplePage *>(buffer_pool_manager_->FetchPage(tmp_tuple.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the tmp tuple heap.");
+  page->Get(tmp_tuple.GetOffset(), tuple);
+  buffer_pool_manager_->UnpinPage(tmp_tuple.GetPageId(), false);
+}
+
+void TmpTupleHeap::GetPageTuples(size_t page_idx, std::vector<Tuple> *tuples) {
+  auto page = reinterpret_cast<TmpTuplePage *>(buffer_pool_manager_->FetchPage(page_ids_[page_idx]));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the tmp tuple heap.");
+  for (uint32_t offset = page->GetFirstOffset(); offset < PAGE_SIZE; offset = page->GetNextOffset(offset)) {
+    tuples->emplace_back();
+    page->Get(offset, &tuples->back());
+  }
+  buffer_pool_manager_->UnpinPage(page_ids_[page_idx], false);
+}
+
+}  // namespace bustub
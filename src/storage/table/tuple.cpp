@@ -111,6 +111,16 @@ const char *Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) c
   return (data_ + offset);
 }
 
+Tuple Tuple::KeyFromTuple(const Schema *schema, const Schema *key_schema,
+                          const std::vector<uint32_t> &key_attrs) const {
+  std::vector<Value> values;
+  values.reserve(key_attrs.size());
+  for (auto idx : key_attrs) {
+    values.emplace_back(GetValue(schema, idx));
+  }
+  return Tuple(values, key_schema);
+}
+
 std::string Tuple::ToString(const Schema *schema) const {
   std::stringstream os;
 
@@ -153,4 +163,18 @@ void Tuple::DeserializeFrom(const char *storage) {
   this->allocated_ = true;
 }
 
+void Tuple::CopyFrom(const Tuple &other) {
+  if (this == &other) {
+    return;
+  }
+  if (allocated_) {
+    delete[] data_;
+  }
+  size_ = other.size_;
+  data_ = new char[size_];
+  memcpy(data_, other.data_, size_);
+  rid_ = other.rid_;
+  allocated_ = true;
+}
+
 }  // namespace bustub
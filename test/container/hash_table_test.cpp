@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -104,4 +105,295 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // Start with a single block page so that the table has to grow several times.
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  const int num_keys = 2000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_GT(ht.GetSize(), initial_size);
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Lost " << i << " while resizing" << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentGetValueTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // A small table so that the inserters force resizes while the readers are running.
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  const int num_preloaded = 300;
+  for (int i = 0; i < num_preloaded; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+
+  const int num_readers = 4;
+  const int num_inserters = 2;
+  const int keys_per_inserter = 1000;
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_inserters; t++) {
+    threads.emplace_back([&ht, t] {
+      int base = num_preloaded + t * keys_per_inserter;
+      for (int i = base; i < base + keys_per_inserter; i++) {
+        ht.Insert(nullptr, i, i);
+      }
+    });
+  }
+  for (int t = 0; t < num_readers; t++) {
+    threads.emplace_back([&ht, &failed] {
+      for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < num_preloaded; i++) {
+          std::vector<int> res;
+          ht.GetValue(nullptr, i, &res);
+          if (res.size() != 1 || res[0] != i) {
+            failed = true;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(failed);
+
+  for (int i = 0; i < num_preloaded + num_inserters * keys_per_inserter; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, BulkLoadTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  ht.Insert(nullptr, 0, 0);
+
+  // (0, 0) is already in the table and (1, 1) appears twice, so neither should be loaded again.
+  const int num_keys = 5000;
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < num_keys; i++) {
+    entries.emplace_back(i, i);
+  }
+  entries.emplace_back(1, 1);
+  entries.emplace_back(1, 2);
+
+  EXPECT_EQ(num_keys, ht.BulkLoad(nullptr, entries.begin(), entries.end(), 4));
+  EXPECT_GE(ht.GetSize(), 2 * (num_keys + 1));
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 1) {
+      EXPECT_EQ(2, res.size());
+    } else {
+      ASSERT_EQ(1, res.size()) << "Failed to load " << i << std::endl;
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+
+  // The table keeps working normally after a bulk load.
+  EXPECT_TRUE(ht.Insert(nullptr, num_keys, num_keys));
+  EXPECT_FALSE(ht.Insert(nullptr, 2, 2));
+  EXPECT_TRUE(ht.Remove(nullptr, 3, 3));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, MultiLevelHeaderTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // More block pages than a single header page can reference.
+  const size_t num_blocks = HashTableHeaderPage::MAX_NUM_BLOCKS + 100;
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), num_blocks, HashFunction<int>());
+
+  // The root header page points to two level 0 header pages.
+  auto root_page = reinterpret_cast<HashTableHeaderPage *>(bpm->FetchPage(ht.GetHeaderPageId())->GetData());
+  EXPECT_EQ(1, root_page->GetLevel());
+  ASSERT_EQ(2, root_page->NumBlocks());
+  size_t num_referenced = 0;
+  for (size_t i = 0; i < root_page->NumBlocks(); i++) {
+    page_id_t child_page_id = root_page->GetBlockPageId(i);
+    auto child_page = reinterpret_cast<HashTableHeaderPage *>(bpm->FetchPage(child_page_id)->GetData());
+    EXPECT_EQ(0, child_page->GetLevel());
+    num_referenced += child_page->NumBlocks();
+    bpm->UnpinPage(child_page_id, false);
+  }
+  EXPECT_EQ(num_blocks, num_referenced);
+  bpm->UnpinPage(ht.GetHeaderPageId(), false);
+
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ProbeFilterTest) {
+  const size_t num_blocks = 4;
+  const size_t slots_per_block = 496;
+  HashTableProbeFilter filter(num_blocks, slots_per_block);
+  HashFunction<int> hash_fn;
+
+  // Fill every block to half of its slots.
+  const int num_keys = num_blocks * slots_per_block / 2;
+  for (int i = 0; i < num_keys; i++) {
+    filter.Add(i % num_blocks, hash_fn.GetHash(i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(filter.MayContain(i % num_blocks, hash_fn.GetHash(i)));
+  }
+
+  int false_positives = 0;
+  for (int i = num_keys; i < 2 * num_keys; i++) {
+    false_positives += filter.MayContain(i % num_blocks, hash_fn.GetHash(i)) ? 1 : 0;
+  }
+  EXPECT_LT(false_positives, num_keys / 20);
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, NegativeLookupTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  // Enough even keys to resize a few times, so that the filter is rebuilt along with the table.
+  const int num_keys = 3000;
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 0, ht.GetValue(nullptr, i, &res)) << i;
+  }
+
+  // Removed keys may stay in the filter, but must not be found.
+  for (int i = 0; i < num_keys; i += 4) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 4 == 2, ht.GetValue(nullptr, i, &res)) << i;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, CompactionTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 4, HashFunction<int>());
+  size_t num_slots = ht.GetSize();
+
+  // Churn: keep a small live set while leaving tombstones behind. Stay below the automatic compaction threshold.
+  const int num_keys = static_cast<int>(num_slots / 5);
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+
+  HashTableStats before = ht.GetStats();
+  EXPECT_EQ(num_slots, before.num_slots_);
+  EXPECT_EQ(num_keys / 2, before.num_entries_);
+  EXPECT_EQ(num_keys / 2, before.num_tombstones_);
+  EXPECT_GT(before.TombstoneRatio(), 0);
+  EXPECT_GE(before.avg_probe_length_, 1);
+  EXPECT_GE(before.max_probe_length_, before.avg_probe_length_);
+
+  ht.Compact();
+  HashTableStats after = ht.GetStats();
+  EXPECT_EQ(num_slots, after.num_slots_);
+  EXPECT_EQ(num_keys / 2, after.num_entries_);
+  EXPECT_EQ(0, after.num_tombstones_);
+  EXPECT_LE(after.avg_probe_length_, before.avg_probe_length_);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht.GetValue(nullptr, i, &res)) << i;
+  }
+
+  // Heavy churn compacts on its own, so tombstones stay bounded.
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Insert(nullptr, num_keys * (round + 1) + i, i));
+    }
+    for (int i = 0; i < num_keys; i += 2) {
+      EXPECT_TRUE(ht.Remove(nullptr, num_keys * (round + 1) + i, i));
+    }
+  }
+  HashTableStats churned = ht.GetStats();
+  EXPECT_EQ(num_keys / 2, churned.num_entries_);
+  EXPECT_LE(churned.TombstoneRatio(), 0.25);
+
+  // Removing and reinserting a pair reuses a tombstone, so endless churn of that kind never rebuilds the table.
+  page_id_t header_page_id = ht.GetHeaderPageId();
+  for (size_t i = 0; i < num_slots; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, 1, 1));
+    EXPECT_TRUE(ht.Insert(nullptr, 1, 1));
+  }
+  EXPECT_EQ(header_page_id, ht.GetHeaderPageId());
+  EXPECT_EQ(churned.num_tombstones_, ht.GetStats().num_tombstones_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
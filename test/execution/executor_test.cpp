@@ -10,27 +10,51 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstdio>
+#include <fstream>
 #include <memory>
+#include <random>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/table_generator.h"
+#include "catalog/table_loader.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/hash_join_executor.h"
+#include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/merge_join_executor.h"
+#include "execution/executors/nested_index_join_executor.h"
+#include "execution/executors/pipeline_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/topn_executor.h"
+#include "execution/compiled_predicate.h"
+#include "execution/fixed_width_aggregation_hash_table.h"
+#include "execution/runtime_filter.h"
+#include "execution/simd_filter.h"
+#include "execution/sort_key_encoder.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/worker_pool.h"
 #include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -107,6 +131,41 @@ class ExecutorTest : public ::testing::Test {
     return allocated_output_schemas_.back().get();
   }
 
+  /** @return all rows produced by the executor through Next(), formatted as strings and sorted */
+  std::vector<std::string> DrainTuples(AbstractExecutor *executor) {
+    std::vector<std::string> rows;
+    const Schema *schema = executor->GetOutputSchema();
+    Tuple tuple;
+    while (executor->Next(&tuple)) {
+      std::string row;
+      for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+        row += tuple.GetValue(schema, i).ToString() + ",";
+      }
+      rows.push_back(row);
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  }
+
+  /** @return all rows produced by the executor through NextBatch(), formatted as strings and sorted */
+  std::vector<std::string> DrainBatches(AbstractExecutor *executor) {
+    std::vector<std::string> rows;
+    TupleBatch batch;
+    while (executor->NextBatch(&batch)) {
+      EXPECT_FALSE(batch.IsEmpty());
+      EXPECT_LE(batch.NumRows(), TupleBatch::BATCH_SIZE);
+      for (uint32_t row_idx : batch.GetSelection()) {
+        std::string row;
+        for (uint32_t i = 0; i < batch.NumColumns(); i++) {
+          row += batch.GetValue(row_idx, i).ToString() + ",";
+        }
+        rows.push_back(row);
+      }
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  }
+
  private:
   std::unique_ptr<TransactionManager> txn_mgr_;
   Transaction *txn_{nullptr};
@@ -424,4 +483,1479 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchSeqScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < 500, in both execution models
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  auto batch_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  batch_executor->Init();
+  TupleBatch batch;
+  uint32_t num_tuples = 0;
+  while (batch_executor->NextBatch(&batch)) {
+    ASSERT_EQ(2, batch.NumColumns());
+    for (uint32_t row_idx : batch.GetSelection()) {
+      ASSERT_LT(batch.GetValue(row_idx, 0).GetAs<int32_t>(), 500);
+      ASSERT_LT(batch.GetValue(row_idx, 1).GetAs<int32_t>(), 10);
+      num_tuples++;
+    }
+  }
+  ASSERT_EQ(500, num_tuples);
+
+  auto tuple_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  tuple_executor->Init();
+  batch_executor->Init();
+  ASSERT_EQ(DrainTuples(tuple_executor.get()), DrainBatches(batch_executor.get()));
+
+  // The tuple-at-a-time adapter produces the same batches.
+  batch_executor->Init();
+  num_tuples = 0;
+  while (batch_executor->AbstractExecutor::NextBatch(&batch)) {
+    ASSERT_EQ(2, batch.NumColumns());
+    num_tuples += batch.NumSelected();
+  }
+  ASSERT_EQ(500, num_tuples);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchHashJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col2 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+    auto col2 = MakeColumnValueExpression(*out_schema2, 1, "col2");
+    std::vector<const AbstractExpression *> left_keys{colA};
+    std::vector<const AbstractExpression *> right_keys{col1};
+    auto predicate = MakeComparisonExpression(colA, col1, ComparisonType::Equal);
+    auto out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col1", col1}, {"col2", col2}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, predicate,
+        std::move(left_keys), std::move(right_keys));
+  }
+
+  auto tuple_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  tuple_executor->Init();
+  auto batch_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  batch_executor->Init();
+  auto expected = DrainTuples(tuple_executor.get());
+  ASSERT_EQ(TEST2_SIZE, expected.size());
+  ASSERT_EQ(expected, DrainBatches(batch_executor.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchAggregationTest) {
+  // SELECT count(colA), colB, sum(colC) FROM test_1 WHERE colA > 100 GROUP BY colB HAVING count(colA) > 50
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    auto predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                                              ComparisonType::GreaterThan);
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, predicate, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> agg_plan;
+  {
+    const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+    const AbstractExpression *groupbyB = MakeAggregateValueExpression(true, 0);
+    const AbstractExpression *countA = MakeAggregateValueExpression(false, 0);
+    const AbstractExpression *sumC = MakeAggregateValueExpression(false, 1);
+    const AbstractExpression *having = MakeComparisonExpression(
+        countA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(50)), ComparisonType::GreaterThan);
+    auto agg_schema = MakeOutputSchema({{"countA", countA}, {"colB", groupbyB}, {"sumC", sumC}});
+    agg_plan = std::make_unique<AggregationPlanNode>(
+        agg_schema, scan_plan.get(), having, std::vector<const AbstractExpression *>{colB},
+        std::vector<const AbstractExpression *>{colA, colC},
+        std::vector<AggregationType>{AggregationType::CountAggregate, AggregationType::SumAggregate});
+  }
+
+  auto tuple_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), agg_plan.get());
+  tuple_executor->Init();
+  auto batch_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), agg_plan.get());
+  batch_executor->Init();
+  auto expected = DrainTuples(tuple_executor.get());
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(expected, DrainBatches(batch_executor.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < 500, by 4 workers sharing one-page morsels
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  WorkerPool pool(4);
+  MorselQueue morsels(table_info->table_.get(), 1);
+  std::vector<std::vector<std::string>> local_rows(pool.NumWorkers());
+  pool.RunOnAll([&](size_t worker_id) {
+    auto executor = ExecutorFactory::CreatePipelineExecutor(GetExecutorContext(), &plan, &morsels);
+    executor->Init();
+    local_rows[worker_id] = DrainBatches(executor.get());
+  });
+  std::vector<std::string> rows;
+  for (const auto &local : local_rows) {
+    rows.insert(rows.end(), local.begin(), local.end());
+  }
+  std::sort(rows.begin(), rows.end());
+
+  auto serial_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+  serial_executor->Init();
+  ASSERT_EQ(DrainBatches(serial_executor.get()), rows);
+  ASSERT_EQ(500, rows.size());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelAggregationAndJoinTest) {
+  WorkerPool pool(4);
+  ExecutorContext parallel_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                               GetExecutorContext()->GetBufferPoolManager(), &pool);
+
+  // SELECT count(colA), colB, sum(colC), min(colD), max(colD) FROM test_1 GROUP BY colB
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    auto colD = MakeColumnValueExpression(schema, 0, "colD");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> agg_plan;
+  {
+    const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+    const AbstractExpression *colD = MakeColumnValueExpression(*scan_schema, 0, "colD");
+    auto agg_schema = MakeOutputSchema({{"countA", MakeAggregateValueExpression(false, 0)},
+                                        {"colB", MakeAggregateValueExpression(true, 0)},
+                                        {"sumC", MakeAggregateValueExpression(false, 1)},
+                                        {"minD", MakeAggregateValueExpression(false, 2)},
+                                        {"maxD", MakeAggregateValueExpression(false, 3)}});
+    agg_plan = std::make_unique<AggregationPlanNode>(
+        agg_schema, scan_plan.get(), nullptr, std::vector<const AbstractExpression *>{colB},
+        std::vector<const AbstractExpression *>{colA, colC, colD, colD},
+        std::vector<AggregationType>{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                     AggregationType::MinAggregate, AggregationType::MaxAggregate});
+  }
+  auto serial_agg = ExecutorFactory::CreateExecutor(GetExecutorContext(), agg_plan.get());
+  serial_agg->Init();
+  auto parallel_agg = ExecutorFactory::CreateExecutor(&parallel_ctx, agg_plan.get());
+  parallel_agg->Init();
+  auto expected = DrainTuples(serial_agg.get());
+  ASSERT_EQ(10, expected.size());
+  ASSERT_EQ(expected, DrainTuples(parallel_agg.get()));
+
+  // SELECT test_1.colA, test_2.col2 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1, building on test_1
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *scan_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    scan_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(scan_schema2, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    auto col1 = MakeColumnValueExpression(*scan_schema2, 1, "col1");
+    auto col2 = MakeColumnValueExpression(*scan_schema2, 1, "col2");
+    auto predicate = MakeComparisonExpression(colA, col1, ComparisonType::Equal);
+    auto out_schema = MakeOutputSchema({{"colA", colA}, {"col2", col2}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_schema, std::vector<const AbstractPlanNode *>{scan_plan.get(), scan_plan2.get()}, predicate,
+        std::vector<const AbstractExpression *>{colA}, std::vector<const AbstractExpression *>{col1});
+  }
+  auto serial_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  serial_join->Init();
+  auto parallel_join = ExecutorFactory::CreateExecutor(&parallel_ctx, join_plan.get());
+  parallel_join->Init();
+  expected = DrainBatches(serial_join.get());
+  ASSERT_EQ(TEST2_SIZE, expected.size());
+  ASSERT_EQ(expected, DrainBatches(parallel_join.get()));
+
+  // The partitioned join returns the same rows a tuple at a time.
+  serial_join->Init();
+  parallel_join->Init();
+  ASSERT_EQ(DrainTuples(serial_join.get()), DrainTuples(parallel_join.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SpillingHashJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_2.col2 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col2 = MakeColumnValueExpression(schema, 0, "col2");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+    auto col2 = MakeColumnValueExpression(*out_schema2, 1, "col2");
+    auto predicate = MakeComparisonExpression(colA, col1, ComparisonType::Equal);
+    auto out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col2", col2}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()}, predicate,
+        std::vector<const AbstractExpression *>{colA}, std::vector<const AbstractExpression *>{col1});
+  }
+
+  auto in_memory_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  in_memory_join->Init();
+  auto expected = DrainBatches(in_memory_join.get());
+  ASSERT_EQ(TEST2_SIZE, expected.size());
+
+  // A budget of a few pages spills once, and a budget of a single byte splits every partition as far as it goes.
+  // With a worker pool, the partitioned join gives up on the budget and the join spills just the same.
+  WorkerPool pool(4);
+  for (auto *worker_pool : {static_cast<WorkerPool *>(nullptr), &pool}) {
+    for (size_t memory_budget : {size_t{4 * PAGE_SIZE}, size_t{1}}) {
+      ExecutorContext spilling_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                                   GetExecutorContext()->GetBufferPoolManager(), worker_pool, memory_budget);
+      auto spilling_join = ExecutorFactory::CreateExecutor(&spilling_ctx, join_plan.get());
+      spilling_join->Init();
+      ASSERT_EQ(expected, DrainBatches(spilling_join.get()));
+      spilling_join->Init();
+      ASSERT_EQ(expected, DrainTuples(spilling_join.get()));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SkewedPartitionedJoinTest) {
+  // SELECT l.colA, r.colA FROM test_1 l JOIN test_1 r ON l.colB = r.colB: each of the 10 keys of colB has about a
+  // hundred tuples on both sides, so that a partition joins into far more rows than both sides take.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto scan_schema = MakeOutputSchema(
+      {{"colA", MakeColumnValueExpression(schema, 0, "colA")}, {"colB", MakeColumnValueExpression(schema, 0, "colB")}});
+  SeqScanPlanNode left_scan{scan_schema, nullptr, table_info->oid_};
+  SeqScanPlanNode right_scan{scan_schema, nullptr, table_info->oid_};
+  auto left_colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  auto left_colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  auto right_colA = MakeColumnValueExpression(*scan_schema, 1, "colA");
+  auto right_colB = MakeColumnValueExpression(*scan_schema, 1, "colB");
+  HashJoinPlanNode join_plan{MakeOutputSchema({{"l", left_colA}, {"r", right_colA}}),
+                             std::vector<const AbstractPlanNode *>{&left_scan, &right_scan},
+                             MakeComparisonExpression(left_colB, right_colB, ComparisonType::Equal),
+                             std::vector<const AbstractExpression *>{left_colB},
+                             std::vector<const AbstractExpression *>{right_colB}};
+
+  auto serial_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+  serial_join->Init();
+  auto expected = DrainBatches(serial_join.get());
+  ASSERT_GT(expected.size(), 50 * TEST1_SIZE);
+
+  // Both sides fit in the budget, but the output of a single partition does not. The workers hand it back a batch
+  // at a time, so that no more than a batch per worker is buffered.
+  WorkerPool pool(4);
+  ExecutorContext parallel_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                               GetExecutorContext()->GetBufferPoolManager(), &pool, 256 * 1024);
+  auto parallel_join = ExecutorFactory::CreateExecutor(&parallel_ctx, &join_plan);
+  auto join = dynamic_cast<HashJoinExecutor *>(parallel_join.get());
+  parallel_join->Init();
+  std::vector<std::string> rows;
+  size_t max_buffered = 0;
+  TupleBatch batch;
+  while (parallel_join->NextBatch(&batch)) {
+    max_buffered = std::max(max_buffered, join->NumBufferedBatches());
+    for (uint32_t row_idx : batch.GetSelection()) {
+      rows.push_back(batch.GetValue(row_idx, 0).ToString() + "," + batch.GetValue(row_idx, 1).ToString() + ",");
+    }
+  }
+  std::sort(rows.begin(), rows.end());
+  ASSERT_EQ(expected, rows);
+  ASSERT_LT(max_buffered, pool.NumWorkers());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, JoinHashTableTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  IdentityHashFunction hash_fn;
+  auto bpm = GetExecutorContext()->GetBufferPoolManager();
+  SimpleHashJoinHashTable jht("HashTable", bpm, HashComparator(), 2, hash_fn);
+  SimpleHashJoinHashTable other("HashTable", bpm, HashComparator(), 2, hash_fn);
+
+  // 1:N, with 100 tuples per hash key, enough for the directory to grow several times.
+  for (int32_t i = 0; i < 1000; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::to_string(i))}, &schema);
+    (i < 500 ? &jht : &other)->Insert(GetExecutorContext()->GetTransaction(), i % 10, tuple);
+  }
+  jht.Merge(&other);
+  ASSERT_EQ(1000, jht.Size());
+  ASSERT_EQ(0, other.Size());
+
+  for (hash_t hash = 0; hash < 10; hash++) {
+    std::vector<int32_t> matches;
+    for (auto it = jht.BeginMatches(hash); it != jht.EndMatches(); ++it) {
+      Tuple match = *it;
+      ASSERT_FALSE(match.IsAllocated());
+      int32_t a = match.GetValue(&schema, 0).GetAs<int32_t>();
+      ASSERT_EQ(std::to_string(a), match.GetValue(&schema, 1).ToString());
+      matches.push_back(a);
+    }
+    ASSERT_EQ(100, matches.size());
+    for (int32_t a : matches) {
+      ASSERT_EQ(hash, static_cast<hash_t>(a % 10));
+    }
+  }
+  ASSERT_TRUE(jht.BeginMatches(10) == jht.EndMatches());
+
+  std::vector<Tuple> tuples;
+  jht.GetValue(GetExecutorContext()->GetTransaction(), 3, &tuples);
+  ASSERT_EQ(100, tuples.size());
+
+  jht.Clear();
+  ASSERT_EQ(0, jht.Size());
+  ASSERT_TRUE(jht.BeginMatches(3) == jht.EndMatches());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, RuntimeFilterTest) {
+  // No false negatives, and few false positives.
+  BlockedBloomFilter bloom(1000);
+  for (uint64_t i = 0; i < 1000; i++) {
+    bloom.Insert(i);
+  }
+  size_t num_false_positives = 0;
+  for (uint64_t i = 0; i < 100000; i++) {
+    ASSERT_TRUE(i >= 1000 || bloom.MayContain(i));
+    num_false_positives += i >= 1000 && bloom.MayContain(i) ? 1 : 0;
+  }
+  ASSERT_LT(num_false_positives, 99000 / 20);
+
+  // SELECT colA, colB FROM test_1, with a filter on colA pushed down from a join with test_2
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+
+  auto fill = [](RuntimeFilter *filter) {
+    for (uint32_t i = 0; i < TEST2_SIZE; i++) {
+      Value key = ValueFactory::GetIntegerValue(i);
+      filter->Insert(HashUtil::CombineHashes(0, HashUtil::HashValue(&key)));
+    }
+  };
+  RuntimeFilter filter(TEST2_SIZE, {colA});
+  fill(&filter);
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+  ASSERT_TRUE(executor->PushRuntimeFilter(&filter));
+  executor->Init();
+  auto rows = DrainBatches(executor.get());
+  executor->Init();
+  ASSERT_EQ(rows, DrainTuples(executor.get()));
+  ASSERT_GE(rows.size(), TEST2_SIZE);
+  ASSERT_LT(rows.size(), 2 * TEST2_SIZE);
+  size_t num_matches = 0;
+  for (uint32_t i = 0; i < TEST2_SIZE; i++) {
+    num_matches += std::count_if(rows.begin(), rows.end(), [i](const std::string &row) {
+      return row.compare(0, std::to_string(i).size() + 1, std::to_string(i) + ",") == 0;
+    });
+  }
+  ASSERT_EQ(TEST2_SIZE, num_matches);
+
+  // The keys of the filter refer to the output schema, which need not lay out the columns as the table does.
+  auto swapped_schema = MakeOutputSchema({{"colB", colB}, {"colA", colA}});
+  SeqScanPlanNode swapped_plan{swapped_schema, nullptr, table_info->oid_};
+  RuntimeFilter swapped_filter(TEST2_SIZE, {MakeColumnValueExpression(*swapped_schema, 0, "colA")});
+  fill(&swapped_filter);
+  executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &swapped_plan);
+  ASSERT_TRUE(executor->PushRuntimeFilter(&swapped_filter));
+  executor->Init();
+  auto swapped_rows = DrainBatches(executor.get());
+  ASSERT_EQ(rows.size(), swapped_rows.size());
+  executor->Init();
+  ASSERT_EQ(swapped_rows, DrainTuples(executor.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SelectiveHashJoinTest) {
+  // SELECT test_2.col1, test_1.colB FROM test_2 JOIN test_1 ON test_2.col1 = test_1.colA, probing with test_1
+  std::unique_ptr<AbstractPlanNode> build_plan;
+  const Schema *build_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    build_schema = MakeOutputSchema({{"col1", col1}});
+    build_plan = std::make_unique<SeqScanPlanNode>(build_schema, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> probe_plan;
+  const Schema *probe_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    probe_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    probe_plan = std::make_unique<SeqScanPlanNode>(probe_schema, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  {
+    auto col1 = MakeColumnValueExpression(*build_schema, 0, "col1");
+    auto colA = MakeColumnValueExpression(*probe_schema, 1, "colA");
+    auto colB = MakeColumnValueExpression(*probe_schema, 1, "colB");
+    auto predicate = MakeComparisonExpression(col1, colA, ComparisonType::Equal);
+    auto out_schema = MakeOutputSchema({{"col1", col1}, {"colB", colB}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_schema, std::vector<const AbstractPlanNode *>{build_plan.get(), probe_plan.get()}, predicate,
+        std::vector<const AbstractExpression *>{col1}, std::vector<const AbstractExpression *>{colA});
+  }
+
+  auto serial_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  serial_join->Init();
+  auto expected = DrainBatches(serial_join.get());
+  ASSERT_EQ(TEST2_SIZE, expected.size());
+  serial_join->Init();
+  ASSERT_EQ(expected, DrainTuples(serial_join.get()));
+
+  WorkerPool pool(4);
+  ExecutorContext parallel_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                               GetExecutorContext()->GetBufferPoolManager(), &pool);
+  auto parallel_join = ExecutorFactory::CreateExecutor(&parallel_ctx, join_plan.get());
+  parallel_join->Init();
+  ASSERT_EQ(expected, DrainBatches(parallel_join.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, GroupByAggregationModesTest) {
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+  const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  std::vector<const AbstractExpression *> aggregates{colA, colC, colC, colC};
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                         AggregationType::MinAggregate, AggregationType::MaxAggregate};
+  auto agg_schema = MakeOutputSchema({{"key", MakeAggregateValueExpression(true, 0)},
+                                      {"countA", MakeAggregateValueExpression(false, 0)},
+                                      {"sumC", MakeAggregateValueExpression(false, 1)},
+                                      {"minC", MakeAggregateValueExpression(false, 2)},
+                                      {"maxC", MakeAggregateValueExpression(false, 3)}});
+
+  // SELECT colA, count(colA), sum(colC), min(colC), max(colC) FROM test_1 GROUP BY colA HAVING count(colA) > 0,
+  // and the same grouped by colB: one group per tuple, and few groups with many partial aggregates each. Parallel
+  // and spilling aggregations must produce exactly the groups of the serial in-memory one.
+  auto *count_a = MakeAggregateValueExpression(false, 0);
+  auto *having = MakeComparisonExpression(count_a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(0)),
+                                          ComparisonType::GreaterThan);
+  for (const AbstractExpression *group_by : {colA, colB}) {
+    AggregationPlanNode agg_plan{agg_schema,
+                                 scan_plan.get(),
+                                 having,
+                                 std::vector<const AbstractExpression *>{group_by},
+                                 std::vector<const AbstractExpression *>(aggregates),
+                                 std::vector<AggregationType>(agg_types)};
+    auto in_memory_agg = ExecutorFactory::CreateExecutor(GetExecutorContext(), &agg_plan);
+    in_memory_agg->Init();
+    auto expected = DrainBatches(in_memory_agg.get());
+    ASSERT_EQ(group_by == colA ? TEST1_SIZE : 10, expected.size());
+
+    WorkerPool pool(4);
+    ExecutorContext parallel_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                                 GetExecutorContext()->GetBufferPoolManager(), &pool);
+    auto parallel_agg = ExecutorFactory::CreateExecutor(&parallel_ctx, &agg_plan);
+    parallel_agg->Init();
+    ASSERT_EQ(expected, DrainBatches(parallel_agg.get()));
+    parallel_agg->Init();
+    ASSERT_EQ(expected, DrainTuples(parallel_agg.get()));
+
+    // Parallel workers split the budget between them, and spill as a serial build does.
+    for (auto *worker_pool : {static_cast<WorkerPool *>(nullptr), &pool}) {
+      for (size_t memory_budget : {size_t{16 * PAGE_SIZE}, size_t{1}}) {
+        ExecutorContext spilling_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                                     GetExecutorContext()->GetBufferPoolManager(), worker_pool, memory_budget);
+        auto spilling_agg = ExecutorFactory::CreateExecutor(&spilling_ctx, &agg_plan);
+        spilling_agg->Init();
+        ASSERT_EQ(expected, DrainBatches(spilling_agg.get()));
+        spilling_agg->Init();
+        ASSERT_EQ(expected, DrainTuples(spilling_agg.get()));
+      }
+    }
+  }
+
+  // SELECT col2, min(col1), sum(col3), max(col4) FROM test_2 GROUP BY col2: spilled groups are laid out with the
+  // types of the plan, from SMALLINT to BIGINT, and the null key and null aggregates come back as they were.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto &schema = table_info->schema_;
+  auto *scan_schema2 = MakeOutputSchema({{"col1", MakeColumnValueExpression(schema, 0, "col1")},
+                                         {"col2", MakeColumnValueExpression(schema, 0, "col2")},
+                                         {"col3", MakeColumnValueExpression(schema, 0, "col3")},
+                                         {"col4", MakeColumnValueExpression(schema, 0, "col4")}});
+  SeqScanPlanNode scan_plan2{scan_schema2, nullptr, table_info->oid_};
+  auto agg_schema2 = MakeOutputSchema({{"col2", MakeAggregateValueExpression(true, 0)},
+                                       {"minCol1", MakeAggregateValueExpression(false, 0)},
+                                       {"sumCol3", MakeAggregateValueExpression(false, 1)},
+                                       {"maxCol4", MakeAggregateValueExpression(false, 2)}});
+  AggregationPlanNode agg_plan2{
+      agg_schema2,
+      &scan_plan2,
+      nullptr,
+      {MakeColumnValueExpression(*scan_schema2, 0, "col2")},
+      {MakeColumnValueExpression(*scan_schema2, 0, "col1"), MakeColumnValueExpression(*scan_schema2, 0, "col3"),
+       MakeColumnValueExpression(*scan_schema2, 0, "col4")},
+      {AggregationType::MinAggregate, AggregationType::SumAggregate, AggregationType::MaxAggregate}};
+  auto in_memory_agg = ExecutorFactory::CreateExecutor(GetExecutorContext(), &agg_plan2);
+  in_memory_agg->Init();
+  auto expected = DrainBatches(in_memory_agg.get());
+  ExecutorContext spilling_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                               GetExecutorContext()->GetBufferPoolManager(), nullptr, 1);
+  auto spilling_agg = ExecutorFactory::CreateExecutor(&spilling_ctx, &agg_plan2);
+  spilling_agg->Init();
+  ASSERT_EQ(expected, DrainBatches(spilling_agg.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, FixedWidthAggregationTest) {
+  Schema schema({Column("k", TypeId::TINYINT), Column("a", TypeId::SMALLINT), Column("b", TypeId::BIGINT),
+                 Column("c", TypeId::INTEGER)});
+  const AbstractExpression *k = MakeColumnValueExpression(schema, 0, "k");
+  const AbstractExpression *a = MakeColumnValueExpression(schema, 0, "a");
+  const AbstractExpression *b = MakeColumnValueExpression(schema, 0, "b");
+  const AbstractExpression *c = MakeColumnValueExpression(schema, 0, "c");
+  std::vector<const AbstractExpression *> aggregates{a, a, a, b, b, c};
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                         AggregationType::MinAggregate,   AggregationType::MaxAggregate,
+                                         AggregationType::SumAggregate,   AggregationType::SumAggregate};
+  AggregationPlanNode agg_plan{nullptr,
+                               nullptr,
+                               nullptr,
+                               std::vector<const AbstractExpression *>{k, a},
+                               std::vector<const AbstractExpression *>(aggregates),
+                               std::vector<AggregationType>(agg_types)};
+  ASSERT_TRUE(FixedWidthAggregationHashTable::Supports(&agg_plan));
+
+  // Two batches over TINYINT, SMALLINT, BIGINT and INTEGER columns, with null keys and null aggregate inputs.
+  std::vector<std::vector<std::vector<Value>>> batches;
+  for (int batch_idx = 0; batch_idx < 2; batch_idx++) {
+    std::vector<std::vector<Value>> columns(4);
+    for (int row = 0; row < 1000; row++) {
+      int i = batch_idx * 1000 + row;
+      columns[0].push_back(i % 17 == 0 ? ValueFactory::GetNullValueByType(TypeId::TINYINT)
+                                       : ValueFactory::GetTinyIntValue(static_cast<int8_t>(i % 7 - 3)));
+      columns[1].push_back(i % 101 == 0 ? ValueFactory::GetNullValueByType(TypeId::SMALLINT)
+                                        : ValueFactory::GetSmallIntValue(static_cast<int16_t>(i % 5)));
+      columns[2].push_back(ValueFactory::GetBigIntValue(int64_t{10000000000} * (i % 3 - 1)));
+      columns[3].push_back(ValueFactory::GetIntegerValue(i));
+    }
+    batches.push_back(std::move(columns));
+  }
+  // Skip every third row, as if a filter ran over the batch.
+  std::vector<uint32_t> selection;
+  for (uint32_t row = 0; row < 1000; row++) {
+    if (row % 3 != 0) {
+      selection.push_back(row);
+    }
+  }
+
+  auto format = [](const AggregateKey &key, const AggregateValue &value) {
+    std::string row;
+    for (const auto &values : {key.group_bys_, value.aggregates_}) {
+      for (const auto &val : values) {
+        row += (val.IsNull() ? std::string("null") : val.ToString()) + ",";
+      }
+    }
+    return row;
+  };
+
+  auto views = [](const std::vector<std::vector<Value>> &columns) {
+    std::vector<const std::vector<Value> *> views;
+    for (const auto &column : columns) {
+      views.push_back(&column);
+    }
+    return views;
+  };
+
+  // The typed table, with null keys left to a generic one, must produce the groups of a generic table alone.
+  SimpleAggregationHashTable expected_aht(aggregates, agg_types);
+  SimpleAggregationHashTable null_key_aht(aggregates, agg_types);
+  FixedWidthAggregationHashTable typed_aht(&agg_plan);
+  std::vector<uint32_t> null_key_rows;
+  for (const auto &columns : batches) {
+    std::vector<std::vector<Value>> group_bys{columns[0], columns[1]};
+    std::vector<std::vector<Value>> inputs{columns[1], columns[1], columns[1], columns[2], columns[2], columns[3]};
+    for (uint32_t row : selection) {
+      AggregateKey key{{group_bys[0][row], group_bys[1][row]}};
+      AggregateValue value;
+      for (const auto &input : inputs) {
+        value.aggregates_.push_back(input[row]);
+      }
+      expected_aht.InsertCombine(key, value);
+    }
+    typed_aht.Aggregate(views(group_bys), views(inputs), selection, &null_key_rows);
+    for (uint32_t row : null_key_rows) {
+      ASSERT_TRUE(group_bys[0][row].IsNull() || group_bys[1][row].IsNull());
+      AggregateValue value;
+      for (const auto &input : inputs) {
+        value.aggregates_.push_back(input[row]);
+      }
+      null_key_aht.InsertCombine(AggregateKey{{group_bys[0][row], group_bys[1][row]}}, value);
+    }
+  }
+  std::vector<std::string> expected;
+  for (auto iter = expected_aht.Begin(); iter != expected_aht.End(); ++iter) {
+    expected.push_back(format(iter.Key(), iter.Val()));
+  }
+  std::vector<std::string> actual;
+  typed_aht.ForEachGroup(
+      [&](const AggregateKey &key, const AggregateValue &value) { actual.push_back(format(key, value)); });
+  for (auto iter = null_key_aht.Begin(); iter != null_key_aht.End(); ++iter) {
+    actual.push_back(format(iter.Key(), iter.Val()));
+  }
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  ASSERT_EQ(expected, actual);
+
+  // Sums overflow their result type exactly as Value::Add does.
+  std::vector<std::vector<Value>> keys{{ValueFactory::GetTinyIntValue(1), ValueFactory::GetTinyIntValue(1)},
+                                       {ValueFactory::GetSmallIntValue(1), ValueFactory::GetSmallIntValue(1)}};
+  std::vector<Value> small(2, ValueFactory::GetSmallIntValue(1));
+  std::vector<Value> zero(2, ValueFactory::GetBigIntValue(0));
+  std::vector<Value> big(2, ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX));
+  std::vector<std::vector<Value>> overflowing{small, small, small, zero, zero, big};
+  typed_aht.Clear();
+  EXPECT_EQ(0, typed_aht.Size());
+  EXPECT_THROW(typed_aht.Aggregate(views(keys), views(overflowing), {0, 1}, &null_key_rows), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortAndTopNTest) {
+  // SELECT colA, colB, colC FROM test_1 ORDER BY colB ASC, colC DESC, colA ASC
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+  std::vector<OrderBy> order_bys{{OrderByType::Asc, MakeColumnValueExpression(*scan_schema, 0, "colB")},
+                                 {OrderByType::Desc, MakeColumnValueExpression(*scan_schema, 0, "colC")},
+                                 {OrderByType::Asc, MakeColumnValueExpression(*scan_schema, 0, "colA")}};
+
+  auto drain_in_order = [&](AbstractExecutor *executor) {
+    std::vector<std::vector<int32_t>> rows;
+    Tuple tuple;
+    while (executor->Next(&tuple)) {
+      rows.push_back({tuple.GetValue(scan_schema, 0).GetAs<int32_t>(), tuple.GetValue(scan_schema, 1).GetAs<int32_t>(),
+                      tuple.GetValue(scan_schema, 2).GetAs<int32_t>()});
+    }
+    return rows;
+  };
+  auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), scan_plan.get());
+  scan->Init();
+  auto expected = drain_in_order(scan.get());
+  ASSERT_EQ(TEST1_SIZE, expected.size());
+  std::sort(expected.begin(), expected.end(), [](const auto &a, const auto &b) {
+    return std::make_tuple(a[1], -a[2], a[0]) < std::make_tuple(b[1], -b[2], b[0]);
+  });
+
+  // In memory, and spilled to many runs of temporary pages, more than the buffer pool holds.
+  SortPlanNode sort_plan{scan_schema, scan_plan.get(), std::vector<OrderBy>(order_bys)};
+  for (size_t memory_budget : {ExecutorContext::UNLIMITED_MEMORY_BUDGET, size_t{PAGE_SIZE}, size_t{1}}) {
+    ExecutorContext sort_ctx(GetExecutorContext()->GetTransaction(), GetExecutorContext()->GetCatalog(),
+                             GetExecutorContext()->GetBufferPoolManager(), nullptr, memory_budget);
+    auto sort = ExecutorFactory::CreateExecutor(&sort_ctx, &sort_plan);
+    sort->Init();
+    ASSERT_EQ(expected, drain_in_order(sort.get()));
+    sort->Init();
+    scan->Init();
+    ASSERT_EQ(DrainTuples(scan.get()), DrainBatches(sort.get()));
+  }
+
+  // ORDER BY ... LIMIT n
+  for (size_t n : {size_t{0}, size_t{1}, size_t{10}, size_t{TEST1_SIZE + 1}}) {
+    TopNPlanNode topn_plan{scan_schema, scan_plan.get(), std::vector<OrderBy>(order_bys), n};
+    auto topn = ExecutorFactory::CreateExecutor(GetExecutorContext(), &topn_plan);
+    topn->Init();
+    auto first_n = std::vector<std::vector<int32_t>>(expected.begin(), expected.begin() + std::min(n, expected.size()));
+    ASSERT_EQ(first_n, drain_in_order(topn.get()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortKeyEncoderTest) {
+  Schema schema({Column("s", TypeId::VARCHAR, 64), Column("d", TypeId::DECIMAL),
+                 Column("i", TypeId::BIGINT)});
+  const AbstractExpression *s = MakeColumnValueExpression(schema, 0, "s");
+  const AbstractExpression *d = MakeColumnValueExpression(schema, 0, "d");
+  const AbstractExpression *i = MakeColumnValueExpression(schema, 0, "i");
+
+  // Varchars that only differ past the encoded prefix, negative and positive decimals and bigints, and null decimals
+  // (tuples cannot hold null varchars).
+  std::vector<std::string> strings{"", "a", "ab", "b", "prefix-longer-than-the-key-1", "prefix-longer-than-the-key-2"};
+  std::vector<double> decimals{-1e10, -2.5, -0.5, 0, 0.5, 3, 1e10};
+  std::vector<int64_t> bigints{BUSTUB_INT64_MIN, -1, 0, 1, BUSTUB_INT64_MAX};
+  std::vector<Tuple> tuples;
+  for (size_t k = 0; k < 60; k++) {
+    Value str = ValueFactory::GetVarcharValue(strings[k % strings.size()]);
+    Value dec = k % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::DECIMAL)
+                            : ValueFactory::GetDecimalValue(decimals[k % decimals.size()]);
+    tuples.emplace_back(std::vector<Value>{str, dec, ValueFactory::GetBigIntValue(bigints[k % bigints.size()])},
+                        &schema);
+  }
+
+  for (auto direction : {OrderByType::Asc, OrderByType::Desc}) {
+    SortKeyEncoder encoder({{direction, s}, {OrderByType::Asc, d}, {direction, i}});
+    ASSERT_FALSE(encoder.IsExact());
+    std::vector<uint8_t> keys(tuples.size() * encoder.KeyWidth());
+    for (size_t k = 0; k < tuples.size(); k++) {
+      encoder.Encode(tuples[k], &schema, &keys[k * encoder.KeyWidth()]);
+    }
+    // The encoded keys, with ties broken by values, must order every pair as the values do.
+    for (size_t a = 0; a < tuples.size(); a++) {
+      for (size_t b = 0; b < tuples.size(); b++) {
+        int by_key = encoder.Compare(&keys[a * encoder.KeyWidth()], tuples[a], &keys[b * encoder.KeyWidth()],
+                                     tuples[b], &schema);
+        int by_value = encoder.CompareValues(tuples[a], tuples[b], &schema);
+        ASSERT_EQ(by_key < 0, by_value < 0) << a << " " << b;
+        ASSERT_EQ(by_key > 0, by_value > 0) << a << " " << b;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexScanTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  auto table_info = catalog->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+  auto *index_a = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetExecutorContext()->GetTransaction(), "test_1_colA", "test_1", {0});
+  auto *index_b = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetExecutorContext()->GetTransaction(), "test_1_colB", "test_1", {1});
+  ASSERT_EQ(index_a, catalog->GetIndex("test_1_colA", "test_1"));
+  ASSERT_EQ(2, catalog->GetTableIndexes("test_1").size());
+  ASSERT_EQ(nullptr, catalog->GetIndex("test_1_colA", "test_2"));
+
+  // SELECT colA, colB, colC FROM test_1 WHERE <column> = <key> [AND <predicate>], through the index and sequentially.
+  auto index_scan = [&](IndexInfo *index, int32_t key, const AbstractExpression *predicate) {
+    IndexScanPlanNode plan{out_schema, predicate, table_info->oid_, index->index_oid_,
+                           {MakeConstantValueExpression(ValueFactory::GetIntegerValue(key))}};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+    executor->Init();
+    return DrainTuples(executor.get());
+  };
+  auto seq_scan = [&](const AbstractExpression *column, int32_t key, const AbstractExpression *predicate) {
+    auto *equals = MakeComparisonExpression(column, MakeConstantValueExpression(ValueFactory::GetIntegerValue(key)),
+                                            ComparisonType::Equal);
+    SeqScanPlanNode plan{out_schema, equals, table_info->oid_};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+    executor->Init();
+    std::vector<std::string> rows;
+    for (const auto &row : DrainTuples(executor.get())) {
+      // Apply the extra predicate by hand, since the scan only takes one comparison.
+      int32_t c = std::stoi(row.substr(row.rfind(',', row.size() - 2) + 1));
+      if (predicate == nullptr || c < 5000) {
+        rows.push_back(row);
+      }
+    }
+    return rows;
+  };
+  auto *c_below_5000 = MakeComparisonExpression(colC, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5000)),
+                                                ComparisonType::LessThan);
+
+  auto point = index_scan(index_a, 42, nullptr);
+  ASSERT_EQ(1, point.size());
+  ASSERT_EQ(seq_scan(colA, 42, nullptr), point);
+  ASSERT_TRUE(index_scan(index_a, TEST1_SIZE, nullptr).empty());
+  ASSERT_EQ(seq_scan(colB, 3, nullptr), index_scan(index_b, 3, nullptr));
+  ASSERT_EQ(seq_scan(colB, 3, c_below_5000), index_scan(index_b, 3, c_below_5000));
+
+  // Inserts keep the indexes up to date.
+  std::vector<std::vector<Value>> raw_vals{{ValueFactory::GetIntegerValue(TEST1_SIZE), ValueFactory::GetIntegerValue(3),
+                                            ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(1)}};
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+  auto insert_executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &insert_plan);
+  insert_executor->Init();
+  ASSERT_TRUE(insert_executor->Next(nullptr));
+  ASSERT_EQ(1, index_scan(index_a, TEST1_SIZE, nullptr).size());
+  ASSERT_EQ(seq_scan(colB, 3, c_below_5000), index_scan(index_b, 3, c_below_5000));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, NestedIndexJoinTest) {
+  // SELECT test_2.col1, test_1.colA, test_1.colB, test_1.colC FROM test_2 JOIN test_1 ON test_2.col1 = test_1.<key>
+  // [AND test_1.colC < 5000], through an index on test_1.<key> and with a hash join.
+  auto catalog = GetExecutorContext()->GetCatalog();
+  auto inner_info = catalog->GetTable("test_1");
+  std::unique_ptr<AbstractPlanNode> inner_scan;
+  const Schema *inner_out;
+  {
+    auto colA = MakeColumnValueExpression(inner_info->schema_, 0, "colA");
+    auto colB = MakeColumnValueExpression(inner_info->schema_, 0, "colB");
+    auto colC = MakeColumnValueExpression(inner_info->schema_, 0, "colC");
+    inner_out = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+    inner_scan = std::make_unique<SeqScanPlanNode>(inner_out, nullptr, inner_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> outer_scan;
+  const Schema *outer_out;
+  {
+    auto outer_info = catalog->GetTable("test_2");
+    auto col1 = MakeColumnValueExpression(outer_info->schema_, 0, "col1");
+    outer_out = MakeOutputSchema({{"col1", col1}});
+    outer_scan = std::make_unique<SeqScanPlanNode>(outer_out, nullptr, outer_info->oid_);
+  }
+  auto col1 = MakeColumnValueExpression(*outer_out, 0, "col1");
+  auto colA = MakeColumnValueExpression(*inner_out, 1, "colA");
+  auto colB = MakeColumnValueExpression(*inner_out, 1, "colB");
+  auto colC = MakeColumnValueExpression(*inner_out, 1, "colC");
+  auto out_schema = MakeOutputSchema({{"col1", col1}, {"colA", colA}, {"colB", colB}, {"colC", colC}});
+  auto c_below_5000 = MakeComparisonExpression(colC, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5000)),
+                                               ComparisonType::LessThan);
+
+  // A unique key, with one match per outer tuple, and a key with a hundred matches per outer tuple.
+  for (uint32_t key_col : {0U, 1U}) {
+    auto index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        GetExecutorContext()->GetTransaction(), "test_1_" + std::to_string(key_col), "test_1", {key_col});
+    auto inner_key = key_col == 0 ? colA : colB;
+    auto key_predicate = MakeComparisonExpression(col1, inner_key, ComparisonType::Equal);
+    for (const AbstractExpression *extra : {static_cast<const AbstractExpression *>(nullptr), c_below_5000}) {
+      NestedIndexJoinPlanNode index_join_plan{out_schema, outer_scan.get(), extra, {col1}, inner_info->oid_,
+                                              index->index_oid_};
+      auto index_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), &index_join_plan);
+      index_join->Init();
+      auto actual = DrainBatches(index_join.get());
+
+      // The hash join only takes the key predicate, so the extra one is applied by hand.
+      HashJoinPlanNode hash_join_plan{out_schema,
+                                      {outer_scan.get(), inner_scan.get()},
+                                      key_predicate,
+                                      {col1},
+                                      {inner_key}};
+      auto hash_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), &hash_join_plan);
+      hash_join->Init();
+      std::vector<std::string> expected;
+      for (const auto &row : DrainTuples(hash_join.get())) {
+        int32_t c = std::stoi(row.substr(row.rfind(',', row.size() - 2) + 1));
+        if (extra == nullptr || c < 5000) {
+          expected.push_back(row);
+        }
+      }
+      if (extra == nullptr) {
+        // Every outer tuple matches one colA, and every inner tuple matches one outer col1 with its colB.
+        ASSERT_EQ(key_col == 0 ? TEST2_SIZE : TEST1_SIZE, expected.size());
+      }
+      ASSERT_EQ(expected, actual);
+      index_join->Init();
+      ASSERT_EQ(expected, DrainTuples(index_join.get()));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, MergeJoinTest) {
+  // Both inputs are sorted on their join key, and the merge join is compared with a hash join on the same key.
+  auto catalog = GetExecutorContext()->GetCatalog();
+  auto test_1 = catalog->GetTable("test_1");
+  auto test_2 = catalog->GetTable("test_2");
+  std::unique_ptr<AbstractPlanNode> test_1_scan;
+  std::unique_ptr<AbstractPlanNode> test_1_head_scan;
+  const Schema *test_1_out;
+  {
+    auto colA = MakeColumnValueExpression(test_1->schema_, 0, "colA");
+    auto colB = MakeColumnValueExpression(test_1->schema_, 0, "colB");
+    auto colC = MakeColumnValueExpression(test_1->schema_, 0, "colC");
+    test_1_out = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+    test_1_scan = std::make_unique<SeqScanPlanNode>(test_1_out, nullptr, test_1->oid_);
+    auto a_below_100 = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                                                ComparisonType::LessThan);
+    test_1_head_scan = std::make_unique<SeqScanPlanNode>(test_1_out, a_below_100, test_1->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> test_2_scan;
+  const Schema *test_2_out;
+  {
+    auto col1 = MakeColumnValueExpression(test_2->schema_, 0, "col1");
+    test_2_out = MakeOutputSchema({{"col1", col1}});
+    test_2_scan = std::make_unique<SeqScanPlanNode>(test_2_out, nullptr, test_2->oid_);
+  }
+  auto sorted_on = [](const AbstractPlanNode *child, const AbstractExpression *key) {
+    return std::make_unique<SortPlanNode>(child->OutputSchema(), child,
+                                          std::vector<OrderBy>{{OrderByType::Asc, key}});
+  };
+  // The output schemas end with a right colC, which the extra predicate of the merge join filters on.
+  auto check = [&](const AbstractPlanNode *left, const AbstractPlanNode *right, const AbstractExpression *left_key,
+                   const AbstractExpression *right_key, const Schema *out_schema, const AbstractExpression *extra) {
+    MergeJoinPlanNode merge_join_plan{out_schema, {left, right}, extra, {left_key}, {right_key}};
+    auto merge_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), &merge_join_plan);
+    merge_join->Init();
+    auto actual = DrainBatches(merge_join.get());
+
+    // The hash join only takes the key predicate, so the extra one is applied by hand.
+    auto key_predicate = MakeComparisonExpression(left_key, right_key, ComparisonType::Equal);
+    HashJoinPlanNode hash_join_plan{out_schema, {left, right}, key_predicate, {left_key}, {right_key}};
+    auto hash_join = ExecutorFactory::CreateExecutor(GetExecutorContext(), &hash_join_plan);
+    hash_join->Init();
+    std::vector<std::string> expected;
+    for (const auto &row : DrainTuples(hash_join.get())) {
+      int32_t c = std::stoi(row.substr(row.rfind(',', row.size() - 2) + 1));
+      if (extra == nullptr || c < 5000) {
+        expected.push_back(row);
+      }
+    }
+    EXPECT_EQ(expected, actual);
+    merge_join->Init();
+    EXPECT_EQ(expected, DrainTuples(merge_join.get()));
+    return expected.size();
+  };
+
+  // test_2.col1 = test_1.colA: a unique key on both sides.
+  {
+    auto left_sort = sorted_on(test_2_scan.get(), MakeColumnValueExpression(*test_2_out, 0, "col1"));
+    auto right_sort = sorted_on(test_1_scan.get(), MakeColumnValueExpression(*test_1_out, 0, "colA"));
+    auto col1 = MakeColumnValueExpression(*test_2_out, 0, "col1");
+    auto colA = MakeColumnValueExpression(*test_1_out, 1, "colA");
+    auto colC = MakeColumnValueExpression(*test_1_out, 1, "colC");
+    auto out_schema = MakeOutputSchema({{"col1", col1}, {"colA", colA}, {"colC", colC}});
+    ASSERT_EQ(TEST2_SIZE, check(left_sort.get(), right_sort.get(), col1, colA, out_schema, nullptr));
+  }
+
+  // test_1.colB = test_1.colB over the first hundred rows on the left: runs of duplicate keys on both sides, that span
+  // several batches on the right, with and without a residual predicate.
+  {
+    auto left_sort = sorted_on(test_1_head_scan.get(), MakeColumnValueExpression(*test_1_out, 0, "colB"));
+    auto right_sort = sorted_on(test_1_scan.get(), MakeColumnValueExpression(*test_1_out, 0, "colB"));
+    auto left_colA = MakeColumnValueExpression(*test_1_out, 0, "colA");
+    auto left_colB = MakeColumnValueExpression(*test_1_out, 0, "colB");
+    auto right_colA = MakeColumnValueExpression(*test_1_out, 1, "colA");
+    auto right_colB = MakeColumnValueExpression(*test_1_out, 1, "colB");
+    auto right_colC = MakeColumnValueExpression(*test_1_out, 1, "colC");
+    auto out_schema = MakeOutputSchema({{"left_colA", left_colA}, {"right_colA", right_colA}, {"colC", right_colC}});
+    auto c_below_5000 = MakeComparisonExpression(
+        right_colC, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5000)), ComparisonType::LessThan);
+    // Every row on the left joins with all the rows on the right that have its colB.
+    auto count_colB = [&](const AbstractPlanNode *scan_plan) {
+      std::vector<size_t> counts(10);
+      auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), scan_plan);
+      scan->Init();
+      TupleBatch batch;
+      while (scan->NextBatch(&batch)) {
+        for (uint32_t row_idx : batch.GetSelection()) {
+          counts[batch.GetValue(row_idx, 1).GetAs<int32_t>()]++;
+        }
+      }
+      return counts;
+    };
+    auto left_counts = count_colB(test_1_head_scan.get());
+    auto right_counts = count_colB(test_1_scan.get());
+    size_t expected_size = 0;
+    for (size_t b = 0; b < 10; b++) {
+      expected_size += left_counts[b] * right_counts[b];
+    }
+    ASSERT_EQ(expected_size, check(left_sort.get(), right_sort.get(), left_colB, right_colB, out_schema, nullptr));
+    ASSERT_GT(expected_size, check(left_sort.get(), right_sort.get(), left_colB, right_colB, out_schema, c_below_5000));
+  }
+
+  // test_2.col1 = run.k: a run longer than a batch, as every row on the right has the key 0.
+  {
+    auto txn = GetExecutorContext()->GetTransaction();
+    Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+    auto run = catalog->CreateTable(txn, "run", schema);
+    for (uint32_t i = 0; i < 3 * TupleBatch::BATCH_SIZE; i++) {
+      RID rid;
+      Tuple tuple({ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(i)}, &schema);
+      ASSERT_TRUE(run->table_->InsertTuple(tuple, &rid, txn));
+    }
+    auto k = MakeColumnValueExpression(schema, 0, "k");
+    auto v = MakeColumnValueExpression(schema, 0, "v");
+    auto run_out = MakeOutputSchema({{"k", k}, {"v", v}});
+    SeqScanPlanNode run_scan{run_out, nullptr, run->oid_};
+    auto left_sort = sorted_on(test_2_scan.get(), MakeColumnValueExpression(*test_2_out, 0, "col1"));
+    auto right_sort = sorted_on(&run_scan, MakeColumnValueExpression(*run_out, 0, "k"));
+    auto col1 = MakeColumnValueExpression(*test_2_out, 0, "col1");
+    auto run_k = MakeColumnValueExpression(*run_out, 1, "k");
+    auto run_v = MakeColumnValueExpression(*run_out, 1, "v");
+    auto out_schema = MakeOutputSchema({{"col1", col1}, {"v", run_v}});
+    ASSERT_EQ(3 * TupleBatch::BATCH_SIZE, check(left_sort.get(), right_sort.get(), col1, run_k, out_schema, nullptr));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ScanPushdownTest) {
+  // SELECT colD, colB FROM test_1 WHERE colC < bound, at 1%, 10% and 100% selectivity. The scan reads neither colA
+  // nor colC into its batches, and filters the tuples with the compiled predicate.
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto colD = MakeColumnValueExpression(schema, 0, "colD");
+  auto out_schema = MakeOutputSchema({{"colD", colD}, {"colB", colB}});
+
+  for (int32_t bound : {100, 1000, 10000}) {
+    std::vector<std::string> expected;
+    auto txn = GetExecutorContext()->GetTransaction();
+    for (auto it = table_info->table_->Begin(txn); it != table_info->table_->End(); ++it) {
+      if (it->GetValue(&schema, 2).GetAs<int32_t>() < bound) {
+        expected.push_back(it->GetValue(&schema, 3).ToString() + "," + it->GetValue(&schema, 1).ToString() + ",");
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+    if (bound == 10000) {
+      ASSERT_EQ(TEST1_SIZE, expected.size());
+    }
+
+    auto predicate = MakeComparisonExpression(colC, MakeConstantValueExpression(ValueFactory::GetIntegerValue(bound)),
+                                              ComparisonType::LessThan);
+    SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &plan);
+    executor->Init();
+    ASSERT_EQ(expected, DrainBatches(executor.get()));
+    // The compiled predicate filtered every tuple of the table a page at a time, in place: only the tuples that
+    // pass it were read out of the pages.
+    auto scan = dynamic_cast<SeqScanExecutor *>(executor.get());
+    ASSERT_EQ(TEST1_SIZE, scan->NumBatchFilteredTuples());
+    ASSERT_EQ(expected.size() * schema.GetLength(), scan->NumTupleBytesRead());
+
+    // Next() projects the same rows onto the output schema, in tuples of their own.
+    executor->Init();
+    ASSERT_EQ(expected, DrainTuples(executor.get()));
+    executor->Init();
+    Tuple tuple;
+    while (executor->Next(&tuple)) {
+      ASSERT_TRUE(tuple.IsAllocated());
+    }
+
+    // With the columns of the table as they are, Next() copies out the tuples whole.
+    SeqScanPlanNode full_plan{MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                {"colB", colB},
+                                                {"colC", colC},
+                                                {"colD", colD}}),
+                              predicate, table_info->oid_};
+    executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &full_plan);
+    executor->Init();
+    size_t num_tuples = 0;
+    while (executor->Next(&tuple)) {
+      ASSERT_TRUE(tuple.IsAllocated());
+      ASSERT_LT(tuple.GetValue(&schema, 2).GetAs<int32_t>(), bound);
+      num_tuples++;
+    }
+    ASSERT_EQ(expected.size(), num_tuples);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CompiledPredicateTest) {
+  // Every compiled predicate must select the rows that the interpreter selects, on batches and on tuples.
+  auto check = [&](const AbstractExpression *predicate, const Schema *schema, const TupleBatch &rows) {
+    auto compiled = CompiledPredicate::Compile(predicate, schema);
+    ASSERT_NE(nullptr, compiled);
+    std::vector<Value> values;
+    TupleBatch expected = rows;
+    predicate->EvaluateBatch(expected, &values);
+    expected.Filter(values);
+    TupleBatch actual = rows;
+    compiled->Filter(&actual);
+    ASSERT_EQ(expected.GetSelection(), actual.GetSelection());
+    std::vector<uint32_t> selected;
+    for (uint32_t row_idx : rows.GetSelection()) {
+      if (compiled->Evaluate(rows.GetTuple(row_idx, schema))) {
+        selected.push_back(row_idx);
+      }
+    }
+    ASSERT_EQ(expected.GetSelection(), selected);
+    std::vector<Tuple> tuples;
+    std::vector<const char *> data;
+    for (uint32_t row_idx = 0; row_idx < rows.NumRows(); row_idx++) {
+      tuples.push_back(rows.GetTuple(row_idx, schema));
+    }
+    for (const auto &tuple : tuples) {
+      data.push_back(tuple.GetData());
+    }
+    selected = rows.GetSelection();
+    compiled->Filter(data.data(), &selected);
+    ASSERT_EQ(expected.GetSelection(), selected);
+  };
+
+  // test_2: col1 SMALLINT, col2 INTEGER, col3 BIGINT, col4 INTEGER.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  const Schema *schema = &table_info->schema_;
+  auto col1 = MakeColumnValueExpression(*schema, 0, "col1");
+  auto col2 = MakeColumnValueExpression(*schema, 0, "col2");
+  auto col3 = MakeColumnValueExpression(*schema, 0, "col3");
+  auto col4 = MakeColumnValueExpression(*schema, 0, "col4");
+  auto all_columns = MakeOutputSchema({{"col1", col1}, {"col2", col2}, {"col3", col3}, {"col4", col4}});
+  SeqScanPlanNode scan_plan{all_columns, nullptr, table_info->oid_};
+  auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+  scan->Init();
+  TupleBatch rows;
+  ASSERT_TRUE(scan->NextBatch(&rows));
+  ASSERT_EQ(TEST2_SIZE, rows.NumSelected());
+
+  auto int_500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto int_50 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(50));
+  auto decimal_512 = MakeConstantValueExpression(ValueFactory::GetDecimalValue(512.5));
+  auto null_int = MakeConstantValueExpression(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+  for (auto comp_type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                         ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan,
+                         ComparisonType::GreaterThanOrEqual}) {
+    check(MakeComparisonExpression(col3, int_500, comp_type), schema, rows);
+    check(MakeComparisonExpression(int_50, col1, comp_type), schema, rows);
+    check(MakeComparisonExpression(col2, col4, comp_type), schema, rows);
+    check(MakeComparisonExpression(col1, col3, comp_type), schema, rows);
+    check(MakeComparisonExpression(col3, decimal_512, comp_type), schema, rows);
+    check(MakeComparisonExpression(col1, null_int, comp_type), schema, rows);
+    check(MakeComparisonExpression(int_50, int_500, comp_type), schema, rows);
+  }
+
+  // Nulls in the columns never pass.
+  Schema nullable_schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::DECIMAL}}};
+  TupleBatch nullable_rows;
+  nullable_rows.Reset(2);
+  nullable_rows.AppendRow({ValueFactory::GetIntegerValue(1), ValueFactory::GetDecimalValue(1.5)});
+  nullable_rows.AppendRow(
+      {ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetDecimalValue(2.5)});
+  nullable_rows.AppendRow({ValueFactory::GetIntegerValue(3), ValueFactory::GetNullValueByType(TypeId::DECIMAL)});
+  auto a = MakeColumnValueExpression(nullable_schema, 0, "a");
+  auto b = MakeColumnValueExpression(nullable_schema, 0, "b");
+  check(MakeComparisonExpression(a, int_500, ComparisonType::LessThan), &nullable_schema, nullable_rows);
+  check(MakeComparisonExpression(b, int_50, ComparisonType::NotEqual), &nullable_schema, nullable_rows);
+  check(MakeComparisonExpression(a, b, ComparisonType::LessThanOrEqual), &nullable_schema, nullable_rows);
+
+  // Anything else is left to the interpreter.
+  ASSERT_EQ(nullptr, CompiledPredicate::Compile(nullptr, schema));
+  ASSERT_EQ(nullptr, CompiledPredicate::Compile(col1, schema));
+}
+
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimdFilterTest) {
+  std::mt19937 gen(15445);
+  auto check = [&](auto tag, auto lo, auto hi) {
+    using T = decltype(tag);
+    // Odd sizes leave a tail for the scalar loop, and nulls are sprinkled in.
+    for (size_t num_values : {0, 1, 7, 64, 67, 1000}) {
+      std::vector<T> values(num_values);
+      std::uniform_int_distribution<int64_t> dist(lo, hi);
+      for (auto &value : values) {
+        value = dist(gen) % 17 == 0 ? SimdFilter::NullOf<T>() : static_cast<T>(dist(gen));
+      }
+      T constant = static_cast<T>((lo + hi) / 2);
+      if (!values.empty()) {
+        values[0] = constant;
+      }
+      for (auto comp_type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                             ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan,
+                             ComparisonType::GreaterThanOrEqual}) {
+        std::vector<uint64_t> expected((num_values + 63) / 64);
+        for (size_t i = 0; i < num_values; i++) {
+          if (values[i] != SimdFilter::NullOf<T>()) {
+            bool pass = false;
+            switch (comp_type) {
+              case ComparisonType::Equal:
+                pass = values[i] == constant;
+                break;
+              case ComparisonType::NotEqual:
+                pass = values[i] != constant;
+                break;
+              case ComparisonType::LessThan:
+                pass = values[i] < constant;
+                break;
+              case ComparisonType::LessThanOrEqual:
+                pass = values[i] <= constant;
+                break;
+              case ComparisonType::GreaterThan:
+                pass = values[i] > constant;
+                break;
+              case ComparisonType::GreaterThanOrEqual:
+                pass = values[i] >= constant;
+                break;
+            }
+            expected[i / 64] |= static_cast<uint64_t>(pass) << (i % 64);
+          }
+        }
+        // Every instruction set the CPU supports must agree with the reference.
+        for (auto isa : {SimdFilter::Isa::Scalar, SimdFilter::Isa::SSE42, SimdFilter::Isa::AVX2}) {
+          if (isa > SimdFilter::DetectIsa()) {
+            continue;
+          }
+          std::vector<uint64_t> bitmap(expected.size(), ~uint64_t{0});
+          SimdFilter::Compare(isa, values.data(), num_values, comp_type, constant, bitmap.data());
+          ASSERT_EQ(expected, bitmap);
+        }
+      }
+    }
+  };
+  check(int32_t{}, -1000, 1000);
+  check(int64_t{}, -(int64_t{1} << 40), int64_t{1} << 40);
+  check(double{}, -1000, 1000);
+}
+
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PushExecutionTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  auto test_1 = catalog->GetTable("test_1");
+  auto test_2 = catalog->GetTable("test_2");
+  // SELECT colA, colB, colC FROM test_1 [WHERE colC < 5000]
+  auto colA = MakeColumnValueExpression(test_1->schema_, 0, "colA");
+  auto colB = MakeColumnValueExpression(test_1->schema_, 0, "colB");
+  auto colC = MakeColumnValueExpression(test_1->schema_, 0, "colC");
+  auto scan1_out = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+  SeqScanPlanNode scan1{scan1_out, nullptr, test_1->oid_};
+  auto c_below_5000 = MakeComparisonExpression(colC, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5000)),
+                                               ComparisonType::LessThan);
+  SeqScanPlanNode filtered_scan1{scan1_out, c_below_5000, test_1->oid_};
+  // SELECT col1, col2 FROM test_2
+  auto col1 = MakeColumnValueExpression(test_2->schema_, 0, "col1");
+  auto col2 = MakeColumnValueExpression(test_2->schema_, 0, "col2");
+  auto scan2_out = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  SeqScanPlanNode scan2{scan2_out, nullptr, test_2->oid_};
+
+  // test_2 JOIN test_1 ON col1 = colA, with test_2 as the build side.
+  auto join_col1 = MakeColumnValueExpression(*scan2_out, 0, "col1");
+  auto join_col2 = MakeColumnValueExpression(*scan2_out, 0, "col2");
+  auto join_colA = MakeColumnValueExpression(*scan1_out, 1, "colA");
+  auto join_colB = MakeColumnValueExpression(*scan1_out, 1, "colB");
+  auto join_out = MakeOutputSchema({{"colA", join_colA}, {"colB", join_colB}, {"col2", join_col2}});
+  HashJoinPlanNode join{join_out,
+                        {&scan2, &scan1},
+                        MakeComparisonExpression(join_col1, join_colA, ComparisonType::Equal),
+                        {join_col1},
+                        {join_colA}};
+  // test_2 JOIN (test_2 JOIN test_1) ON col1 = colA: the right side streams through both probes.
+  auto outer_colA = MakeColumnValueExpression(*join_out, 1, "colA");
+  auto outer_col2 = MakeColumnValueExpression(*join_out, 1, "col2");
+  auto join_join_out = MakeOutputSchema({{"col1", join_col1}, {"colA", outer_colA}, {"col2", outer_col2}});
+  HashJoinPlanNode join_join{join_join_out,
+                             {&scan2, &join},
+                             MakeComparisonExpression(join_col1, outer_colA, ComparisonType::Equal),
+                             {join_col1},
+                             {outer_colA}};
+  // SELECT colB, COUNT(colA), SUM(col2) FROM (test_2 JOIN test_1) GROUP BY colB
+  auto agg_colA = MakeColumnValueExpression(*join_out, 0, "colA");
+  auto agg_colB = MakeColumnValueExpression(*join_out, 0, "colB");
+  auto agg_col2 = MakeColumnValueExpression(*join_out, 0, "col2");
+  auto agg_out = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                   {"countA", MakeAggregateValueExpression(false, 0)},
+                                   {"sum2", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg{agg_out,
+                          &join,
+                          nullptr,
+                          {agg_colB},
+                          {agg_colA, agg_col2},
+                          {AggregationType::CountAggregate, AggregationType::SumAggregate}};
+  // ... ORDER BY colB, and ORDER BY colC LIMIT 10.
+  auto sort_colB = MakeColumnValueExpression(*join_out, 0, "colB");
+  SortPlanNode sort{join_out, &join, {{OrderByType::Asc, sort_colB}}};
+  auto topn_colC = MakeColumnValueExpression(*scan1_out, 0, "colC");
+  TopNPlanNode topn{scan1_out, &filtered_scan1, {{OrderByType::Asc, topn_colC}}, 10};
+
+  // Every plan produces the same rows in both modes, and is split into as many pipelines as it has breakers, plus one.
+  std::vector<std::pair<const AbstractPlanNode *, size_t>> plans{
+      {&filtered_scan1, 1}, {&join, 2}, {&join_join, 3}, {&agg, 3}, {&sort, 3}, {&topn, 2}};
+  for (size_t memory_budget : {ExecutorContext::UNLIMITED_MEMORY_BUDGET, size_t{1}}) {
+    ExecutorContext ctx(GetExecutorContext()->GetTransaction(), catalog, GetExecutorContext()->GetBufferPoolManager(),
+                        nullptr, memory_budget);
+    for (const auto &[plan, num_pipelines] : plans) {
+      auto pull = ExecutorFactory::CreateExecutor(&ctx, plan);
+      pull->Init();
+      auto expected = DrainBatches(pull.get());
+      ASSERT_FALSE(expected.empty());
+      auto push = ExecutorFactory::CreatePushExecutor(&ctx, plan);
+      push->Init();
+      ASSERT_EQ(num_pipelines, dynamic_cast<PipelineExecutor *>(push.get())->NumPipelines());
+      ASSERT_EQ(expected, DrainBatches(push.get()));
+      push->Init();
+      ASSERT_EQ(expected, DrainTuples(push.get()));
+    }
+  }
+
+  // INSERT INTO copy SELECT colA, colB, colC FROM test_1 WHERE colC < 5000, with the insert as the last sink.
+  auto copy = catalog->CreateTable(GetExecutorContext()->GetTransaction(), "test_1_copy", Schema(*scan1_out));
+  InsertPlanNode insert{&filtered_scan1, copy->oid_};
+  auto push_insert = ExecutorFactory::CreatePushExecutor(GetExecutorContext(), &insert);
+  push_insert->Init();
+  ASSERT_TRUE(DrainBatches(push_insert.get()).empty());
+  SeqScanPlanNode copy_scan{scan1_out, nullptr, copy->oid_};
+  auto copied = ExecutorFactory::CreateExecutor(GetExecutorContext(), &copy_scan);
+  copied->Init();
+  auto filtered = ExecutorFactory::CreateExecutor(GetExecutorContext(), &filtered_scan1);
+  filtered->Init();
+  ASSERT_EQ(DrainBatches(filtered.get()), DrainBatches(copied.get()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BulkLoadTest) {
+  auto catalog = GetExecutorContext()->GetCatalog();
+  auto txn = GetExecutorContext()->GetTransaction();
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT), Column("c", TypeId::DECIMAL),
+                 Column("d", TypeId::BOOLEAN), Column("e", TypeId::VARCHAR, 16)});
+  // Row i is (i, 3i - 7, i / 4, i is even, "s" + i % 100), with a null b in every tenth row.
+  constexpr int32_t num_rows = 20000;
+  auto make_row = [](int32_t i) {
+    return std::vector<Value>{ValueFactory::GetIntegerValue(i),
+                              i % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                          : ValueFactory::GetBigIntValue(int64_t{3} * i - 7),
+                              ValueFactory::GetDecimalValue(i / 4.0), ValueFactory::GetBooleanValue(i % 2 == 0),
+                              ValueFactory::GetVarcharValue("s" + std::to_string(i % 100))};
+  };
+  auto to_strings = [](const std::vector<Value> &values) {
+    std::vector<std::string> strings;
+    for (const auto &value : values) {
+      strings.push_back(value.ToString());
+    }
+    return strings;
+  };
+  {
+    std::ofstream csv("bulk_load.csv");
+    std::ofstream bin("bulk_load.bin", std::ios::binary);
+    csv.precision(17);
+    for (int32_t i = 0; i < num_rows; ++i) {
+      csv << i << ',' << (i % 10 == 0 ? "" : std::to_string(int64_t{3} * i - 7)) << ',' << i / 4.0 << ','
+          << (i % 2 == 0 ? "true" : "0") << ",s" << i % 100 << (i % 3 == 0 ? "\r\n" : "\n");
+      Tuple tuple(make_row(i), &schema);
+      std::vector<char> data(sizeof(uint32_t) + tuple.GetLength());
+      tuple.SerializeTo(data.data());
+      bin.write(data.data(), data.size());
+    }
+  }
+
+  // Both formats, with and without workers, and in small chunks so that there are many of them.
+  WorkerPool pool(4);
+  for (auto *worker_pool : {static_cast<WorkerPool *>(nullptr), &pool}) {
+    ExecutorContext ctx(txn, catalog, GetExecutorContext()->GetBufferPoolManager(), worker_pool);
+    TableLoader loader(&ctx, 4096);
+    for (auto format : {TableLoader::Format::CSV, TableLoader::Format::Binary}) {
+      std::string name = std::string(worker_pool == nullptr ? "serial" : "parallel") +
+                         (format == TableLoader::Format::CSV ? "_csv" : "_bin");
+      auto table = catalog->CreateTable(txn, name, schema);
+      auto index = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, name + "_a", name, {0});
+      ASSERT_EQ(num_rows, loader.LoadFile(table, format == TableLoader::Format::CSV ? "bulk_load.csv" : "bulk_load.bin",
+                                          format));
+
+      // The rows are in file order, and the index finds them.
+      int32_t i = 0;
+      for (auto itr = table->table_->Begin(txn); itr != table->table_->End(); ++itr, ++i) {
+        std::vector<Value> values;
+        for (uint32_t col_idx = 0; col_idx < schema.GetColumnCount(); ++col_idx) {
+          values.push_back(itr->GetValue(&schema, col_idx));
+        }
+        ASSERT_EQ(to_strings(make_row(i)), to_strings(values));
+      }
+      ASSERT_EQ(num_rows, i);
+      for (int32_t key : {0, 1, 4097, num_rows - 1}) {
+        std::vector<RID> rids;
+        index->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(key)}, index->index_->GetKeySchema()), &rids,
+                               txn);
+        ASSERT_EQ(1, rids.size());
+        Tuple tuple;
+        ASSERT_TRUE(table->table_->GetTuple(rids[0], &tuple, txn));
+        ASSERT_EQ(key, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      }
+    }
+
+    // Nothing is loaded from a file with a bad row, a missing field, or a truncated row.
+    auto table = catalog->CreateTable(txn, worker_pool == nullptr ? "bad_serial" : "bad_parallel", schema);
+    for (const std::string &contents : {std::string("1,2,0.5,true,x\n2,two,0.5,true,x\n"),
+                                        std::string("1,2,0.5,true,x\n2,2,0.5,true\n")}) {
+      std::ofstream("bulk_load_bad.csv") << contents;
+      EXPECT_THROW(loader.LoadFile(table, "bulk_load_bad.csv", TableLoader::Format::CSV), Exception);
+    }
+    std::ofstream("bulk_load_bad.bin", std::ios::binary) << std::string("\x10\0\0\0abc");
+    EXPECT_THROW(loader.LoadFile(table, "bulk_load_bad.bin", TableLoader::Format::Binary), Exception);
+    // Nor from a binary row whose varchar offset, or length, points past its end.
+    Tuple row(make_row(1), &schema);
+    std::vector<char> bad_row(sizeof(uint32_t) + row.GetLength());
+    row.SerializeTo(bad_row.data());
+    char *varchar_offset = bad_row.data() + sizeof(uint32_t) + schema.GetColumn(4).GetOffset();
+    uint32_t offset;
+    memcpy(&offset, varchar_offset, sizeof(offset));
+    for (uint32_t bad_offset : {row.GetLength() - 2, uint32_t{0xfffffffe}}) {
+      memcpy(varchar_offset, &bad_offset, sizeof(bad_offset));
+      std::ofstream("bulk_load_bad.bin", std::ios::binary).write(bad_row.data(), bad_row.size());
+      EXPECT_THROW(loader.LoadFile(table, "bulk_load_bad.bin", TableLoader::Format::Binary), Exception);
+    }
+    memcpy(varchar_offset, &offset, sizeof(offset));
+    uint32_t bad_length = row.GetLength();
+    memcpy(bad_row.data() + sizeof(uint32_t) + offset, &bad_length, sizeof(bad_length));
+    std::ofstream("bulk_load_bad.bin", std::ios::binary).write(bad_row.data(), bad_row.size());
+    EXPECT_THROW(loader.LoadFile(table, "bulk_load_bad.bin", TableLoader::Format::Binary), Exception);
+    EXPECT_THROW(loader.LoadFile(table, "does_not_exist.csv", TableLoader::Format::CSV), Exception);
+    ASSERT_TRUE(table->table_->Begin(txn) == table->table_->End());
+  }
+  remove("bulk_load.csv");
+  remove("bulk_load.bin");
+  remove("bulk_load_bad.csv");
+  remove("bulk_load_bad.bin");
+}
+
 }  // namespace bustub
@@ -19,7 +19,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
@@ -46,6 +46,39 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 4), 123);
+
+  ASSERT_EQ(page.GetTablePageId(), page_id);
+  ASSERT_EQ(tmp_tuple, TmpTuple(page_id, PAGE_SIZE - 8));
+  Tuple read;
+  page.Get(tmp_tuple.GetOffset(), &read);
+  ASSERT_EQ(read.GetValue(&schema, 0).GetAs<int32_t>(), 123);
+  ASSERT_EQ(page.GetNextOffset(page.GetFirstOffset()), PAGE_SIZE);
+}
+
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, FullPageTest) {
+  TmpTuplePage page{};
+  page.Init(0, PAGE_SIZE);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+
+  // Every tuple takes 8 bytes, after the 12 bytes of header.
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  int32_t num_tuples = 0;
+  while (page.Insert(Tuple({ValueFactory::GetIntegerValue(num_tuples)}, &schema), &tmp_tuple)) {
+    num_tuples++;
+  }
+  ASSERT_EQ((PAGE_SIZE - 12) / 8, num_tuples);
+
+  // Tuples are read back from the most recently inserted one.
+  Tuple tuple;
+  for (uint32_t offset = page.GetFirstOffset(); offset < PAGE_SIZE; offset = page.GetNextOffset(offset)) {
+    page.Get(offset, &tuple);
+    ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), --num_tuples);
+  }
+  ASSERT_EQ(0, num_tuples);
 }
 
 }  // namespace bustub
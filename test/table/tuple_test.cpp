@@ -21,6 +21,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +72,140 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, TableIteratorTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(10, disk_manager);
+  auto *lock_manager = new LockManager(TwoPLMode::REGULAR, DeadlockMode::PREVENTION);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+
+  // Many pages, the first of which ends up with deleted tuples only, and deleted tuples on the other pages too.
+  std::vector<int32_t> expected;
+  for (int32_t i = 0; i < 5000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(Tuple({ValueFactory::GetIntegerValue(i)}, &schema), &rid, transaction));
+    if (rid.GetPageId() == table->GetFirstPageId() || i % 7 == 0) {
+      ASSERT_TRUE(table->MarkDelete(rid, transaction));
+    } else {
+      expected.push_back(i);
+    }
+  }
+
+  // The tuples are views of the pinned page, in insertion order.
+  std::vector<int32_t> values;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    ASSERT_FALSE(itr->IsAllocated());
+    values.push_back(itr->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  ASSERT_EQ(expected, values);
+
+  // A copy owns its tuple, and resumes from it.
+  {
+    auto itr = table->Begin(transaction);
+    auto copy = itr++;
+    ASSERT_TRUE(copy->IsAllocated());
+    ASSERT_EQ(expected[0], copy->GetValue(&schema, 0).GetAs<int32_t>());
+    ASSERT_EQ(expected[1], itr->GetValue(&schema, 0).GetAs<int32_t>());
+    ASSERT_TRUE(++copy == itr);
+    copy = table->End();
+    ASSERT_TRUE(++copy == table->End());
+  }
+
+  // Iterators unpin their page when they move off it or are destroyed, so every page of the pool is available.
+  std::vector<page_id_t> page_ids(10);
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, buffer_pool_manager->NewPage(&page_id));
+  }
+  for (auto page_id : page_ids) {
+    buffer_pool_manager->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, BulkInsertTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(10, disk_manager);
+  auto *lock_manager = new LockManager(TwoPLMode::REGULAR, DeadlockMode::PREVENTION);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, transaction);
+
+  // Batches fill the pages in chain order, in insertion order.
+  std::vector<Tuple> tuples;
+  std::vector<RID> rids;
+  std::vector<RID> all_rids;
+  for (int32_t batch = 0; batch < 5; ++batch) {
+    tuples.clear();
+    for (int32_t i = 0; i < 1000; ++i) {
+      tuples.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(batch * 1000 + i)}, &schema);
+    }
+    ASSERT_TRUE(table->InsertTuples(tuples, &rids, transaction));
+    ASSERT_EQ(tuples.size(), rids.size());
+    all_rids.insert(all_rids.end(), rids.begin(), rids.end());
+  }
+  auto page_ids = table->GetPageIds();
+  ASSERT_GT(page_ids.size(), 1);
+  size_t page_idx = 0;
+  for (size_t i = 0; i < all_rids.size(); ++i) {
+    if (all_rids[i].GetPageId() != page_ids[page_idx]) {
+      ASSERT_EQ(page_ids[++page_idx], all_rids[i].GetPageId());
+      ASSERT_EQ(0, all_rids[i].GetSlotNum());
+    } else if (i > 0) {
+      ASSERT_EQ(all_rids[i - 1].GetSlotNum() + 1, all_rids[i].GetSlotNum());
+    }
+  }
+  ASSERT_EQ(page_ids.size() - 1, page_idx);
+  std::vector<int32_t> values;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    values.push_back(itr->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  ASSERT_EQ(5000, values.size());
+  for (int32_t i = 0; i < 5000; ++i) {
+    ASSERT_EQ(i, values[i]);
+  }
+
+  // Space freed in the first page goes to single inserts, while bulk inserts keep appending. A reopened heap starts
+  // over from the first page.
+  for (size_t i = 0; i < 10; ++i) {
+    ASSERT_TRUE(table->MarkDelete(all_rids[i], transaction));
+    table->ApplyDelete(all_rids[i], transaction);
+  }
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(Tuple({ValueFactory::GetIntegerValue(-1)}, &schema), &rid, transaction));
+  ASSERT_EQ(table->GetFirstPageId(), rid.GetPageId());
+  tuples.resize(1);
+  ASSERT_TRUE(table->InsertTuples(tuples, &rids, transaction));
+  ASSERT_EQ(page_ids.back(), rids[0].GetPageId());
+  TableHeap reopened(buffer_pool_manager, lock_manager, nullptr, table->GetFirstPageId());
+  ASSERT_TRUE(reopened.InsertTuples(tuples, &rids, transaction));
+  ASSERT_EQ(table->GetFirstPageId(), rids[0].GetPageId());
+
+  // No page is left pinned.
+  std::vector<page_id_t> new_page_ids(10);
+  for (auto &page_id : new_page_ids) {
+    ASSERT_NE(nullptr, buffer_pool_manager->NewPage(&page_id));
+  }
+  for (auto page_id : new_page_ids) {
+    buffer_pool_manager->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete table;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub